@@ -0,0 +1,196 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include <SOLID.h>
+
+// Rods and balls scattered at random, each one swaying and turning slowly 
+// about its spot. Many pairs have overlapping boxes while the objects keep 
+// a clear gap. The scene is tested with and without separation culling, for 
+// each response type, with cold and warm started tests. Culling should not 
+// change the contacts of cold started tests. Warm started tests may differ in
+// a few pairs that are just touching, as a pair that was skipped starts cold.
+
+const int NUM_RODS    = 1000;
+const int NUM_BALLS   = 1000;
+const int NUM_OBJECTS = NUM_RODS + NUM_BALLS;
+const int NUM_FRAMES  = 100;
+const DT_Scalar SIDE  = 24.0f;   // of the cube the objects are scattered in
+const DT_Scalar SWAY  = 0.1f;
+const DT_Scalar TURN  = 0.01f;   // radians per frame
+
+static DT_ObjectHandle objects[NUM_OBJECTS];
+static int ids[NUM_OBJECTS];
+
+struct Motion {
+	DT_Vector3 center;
+	DT_Vector3 axis;
+	DT_Scalar  phase;
+};
+
+static Motion motions[NUM_OBJECTS];
+
+static int      num_contacts;
+static unsigned checksum;
+
+DT_Bool count(void *client_data, void *obj1, void *obj2, const DT_CollData *coll_data)
+{
+	++num_contacts;
+	// Independent of the order in which the contacts are reported
+	unsigned id1 = *static_cast<int *>(obj1);
+	unsigned id2 = *static_cast<int *>(obj2);
+	checksum += (id1 < id2 ? id1 * NUM_OBJECTS + id2 : id2 * NUM_OBJECTS + id1) * 2654435761u;
+	return DT_CONTINUE;
+}
+
+static DT_Scalar random_scalar(DT_Scalar min, DT_Scalar max)
+{
+	return min + (max - min) * DT_Scalar(rand()) / DT_Scalar(RAND_MAX);
+}
+
+// The placements only depend on the frame, so all runs see the same motion
+static void place(int frame) 
+{
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		const Motion& m = motions[i];
+		DT_Scalar t = DT_Scalar(frame) * 0.05f + m.phase;
+
+		DT_Vector3 position = {
+			m.center[0] + SWAY * DT_Scalar(sin(t)),
+			m.center[1] + SWAY * DT_Scalar(sin(t * 1.3f)),
+			m.center[2] + SWAY * DT_Scalar(cos(t * 0.7f))
+		};
+
+		DT_Scalar half_angle = (DT_Scalar(frame) * TURN + m.phase) * 0.5f;
+		DT_Scalar s = DT_Scalar(sin(half_angle));
+		DT_Quaternion orientation = { 
+			m.axis[0] * s, m.axis[1] * s, m.axis[2] * s, DT_Scalar(cos(half_angle))
+		};
+
+		DT_SetTransform(objects[i], position, orientation);
+	}
+}
+
+static void run(DT_ResponseType type, DT_Bool warm_start, DT_Bool cull)
+{
+	DT_SceneHandle scene = DT_CreateScene();
+	DT_SetWarmStart(scene, warm_start);
+	DT_SetSeparationCulling(scene, cull);
+
+	DT_RespTableHandle respTable = DT_CreateRespTable();
+	DT_ResponseClass responseClass = DT_GenResponseClass(respTable);
+	DT_AddDefaultResponse(respTable, &count, type, 0);
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_SetResponseClass(respTable, objects[i], responseClass);
+	}
+
+	place(0);
+	DT_AddObjects(scene, NUM_OBJECTS, objects);
+
+	num_contacts = 0;
+	checksum = 0;
+
+	clock_t start = clock();
+	int frame;
+	for (frame = 0; frame != NUM_FRAMES; ++frame)
+	{
+		place(frame);
+		DT_Test(scene, respTable);
+	}
+	double time = double(clock() - start) / CLOCKS_PER_SEC;
+	
+	printf("  %-4s culling %-3s %8d contacts (%08x), %.3f s\n", 
+		   warm_start ? "warm" : "cold", cull ? "on" : "off", num_contacts, checksum, time);
+
+	DT_RemoveObjects(scene, NUM_OBJECTS, objects);
+	DT_DestroyScene(scene);
+	DT_DestroyRespTable(respTable);
+}
+
+int main() 
+{
+	DT_ShapeHandle rod = DT_NewBox(2.0f, 0.3f, 0.3f);
+	DT_ShapeHandle ball = DT_NewSphere(0.4f);
+
+	srand(1);
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		ids[i] = i;
+		objects[i] = DT_CreateObject(&ids[i], i < NUM_RODS ? rod : ball);
+
+		Motion& m = motions[i];
+		m.center[0] = random_scalar(0.0f, SIDE);
+		m.center[1] = random_scalar(0.0f, SIDE);
+		m.center[2] = random_scalar(0.0f, SIDE);
+
+		DT_Scalar len;
+		do 
+		{
+			m.axis[0] = random_scalar(-1.0f, 1.0f);
+			m.axis[1] = random_scalar(-1.0f, 1.0f);
+			m.axis[2] = random_scalar(-1.0f, 1.0f);
+			len = DT_Scalar(sqrt(m.axis[0] * m.axis[0] + m.axis[1] * m.axis[1] + m.axis[2] * m.axis[2]));
+		}
+		while (len < 0.1f || len > 1.0f);
+		m.axis[0] /= len;
+		m.axis[1] /= len;
+		m.axis[2] /= len;
+
+		m.phase = random_scalar(0.0f, 6.2832f);
+	}
+
+	printf("%d rods and %d balls, %d frames\n", NUM_RODS, NUM_BALLS, NUM_FRAMES);
+
+	static const char *names[] = { "simple", "witnessed", "depth" };
+	static const DT_ResponseType types[] = { DT_SIMPLE_RESPONSE, DT_WITNESSED_RESPONSE, DT_DEPTH_RESPONSE };
+	
+	int k;
+	for (k = 0; k != 3; ++k)
+	{
+		printf("%s response:\n", names[k]);
+		run(types[k], DT_FALSE, DT_FALSE);
+		run(types[k], DT_FALSE, DT_TRUE);
+		run(types[k], DT_TRUE, DT_FALSE);
+		run(types[k], DT_TRUE, DT_TRUE);
+	}
+
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_DestroyObject(objects[i]);
+	}
+	DT_DeleteShape(rod);
+	DT_DeleteShape(ball);
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <SOLID.h>
+
+// The time it takes to load a large terrain mesh as a complex shape, with 
+// each build quality. With OpenMP, the shape is loaded on a single thread and 
+// on all threads. The tree is the same either way.
+
+const int GRID_SIZE = 512;    // vertices along each side
+
+static DT_Scalar random_scalar(DT_Scalar min, DT_Scalar max)
+{
+	return min + (max - min) * DT_Scalar(rand()) / DT_Scalar(RAND_MAX);
+}
+
+// Wall clock time, since the CPU time of all threads is summed by clock()
+static double wall_time()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static void load(const char *name, DT_BuildQuality quality, int num_threads,
+				 const std::vector<DT_Scalar>& vertices, const std::vector<DT_Index>& indices)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(num_threads);
+#endif
+	DT_SetBuildQuality(quality);
+
+	double start = wall_time();
+	DT_VertexBaseHandle base = DT_NewVertexBase(&vertices[0], 0);
+	DT_ShapeHandle shape = DT_NewComplexShape(base);
+	DT_Size i;
+	for (i = 0; i != indices.size(); i += 3)
+	{
+		DT_VertexIndices(3, &indices[i]);
+	}
+	DT_EndComplexShape();
+	double time = wall_time() - start;
+
+	printf("%s build on %d thread%s: %.3f s, tree of %d bytes\n", name, num_threads, num_threads == 1 ? "" : "s", 
+		   time, int(DT_GetTreeSize(shape)));
+
+	DT_DeleteShape(shape);
+	DT_DeleteVertexBase(base);
+}
+
+int main() 
+{
+	srand(1);
+
+	// A rough terrain, as from a scan, with the grid jittered a bit
+	std::vector<DT_Scalar> vertices;
+	int i, j;
+	for (i = 0; i != GRID_SIZE; ++i)
+	{
+		for (j = 0; j != GRID_SIZE; ++j)
+		{
+			DT_Scalar x = DT_Scalar(i) + random_scalar(-0.25f, 0.25f);
+			DT_Scalar z = DT_Scalar(j) + random_scalar(-0.25f, 0.25f);
+			vertices.push_back(x);
+			vertices.push_back(DT_Scalar(8.0 * sin(x * 0.05) * cos(z * 0.07)) + random_scalar(0.0f, 0.5f));
+			vertices.push_back(z);
+		}
+	}
+
+	std::vector<DT_Index> indices;
+	for (i = 0; i + 1 != GRID_SIZE; ++i)
+	{
+		for (j = 0; j + 1 != GRID_SIZE; ++j)
+		{
+			DT_Index v = DT_Index(i * GRID_SIZE + j);
+			DT_Index quad[6] = { v, v + 1, v + GRID_SIZE + 1, v, v + GRID_SIZE + 1, v + GRID_SIZE };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	printf("A terrain of %d triangles\n", int(indices.size() / 3));
+
+	int num_threads = 1;
+#ifdef _OPENMP
+	num_threads = omp_get_max_threads();
+#endif
+
+	load("fast", DT_FAST_BUILD, 1, vertices, indices);
+	if (num_threads != 1)
+	{
+		load("fast", DT_FAST_BUILD, num_threads, vertices, indices);
+	}
+	load("SAH", DT_SAH_BUILD, 1, vertices, indices);
+	if (num_threads != 1)
+	{
+		load("SAH", DT_SAH_BUILD, num_threads, vertices, indices);
+	}
+
+	return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include <SOLID.h>
+
+// A building of a few stories with furnished rooms, tested against a ball 
+// mesh that is placed at random all over it. The building has large floor 
+// and wall triangles next to lots of small ones, which makes for overlapping
+// boxes in a tree that is split at the centers. Both meshes are built with 
+// each build quality and tree format, and the build time, the size of the 
+// trees, the contacts, and the time of the tests are reported, followed by 
+// the time of ray casts on the building, for the nearest hit and for any hit.
+// With STATISTICS defined, the number of box tests as well.
+
+const int NUM_STORIES    = 3;
+const int NUM_ROOMS      = 6;      // along each side of a story
+const int NUM_ITEMS      = 20;     // per room
+const DT_Scalar ROOM     = 4.0f;
+const DT_Scalar STORY    = 3.0f;
+const int NUM_PLACEMENTS = 20000;
+const int NUM_RAYS       = 200000;
+
+#ifdef STATISTICS
+extern int num_box_tests;
+#endif
+
+static std::vector<DT_Scalar> vertices;
+static std::vector<DT_Index>  indices;
+
+static int num_contacts;
+
+DT_Bool count(void *client_data, void *obj1, void *obj2, const DT_CollData *coll_data)
+{
+	++num_contacts;
+	return DT_CONTINUE;
+}
+
+static DT_Scalar random_scalar(DT_Scalar min, DT_Scalar max)
+{
+	return min + (max - min) * DT_Scalar(rand()) / DT_Scalar(RAND_MAX);
+}
+
+static DT_Index vertex(DT_Scalar x, DT_Scalar y, DT_Scalar z)
+{
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(z);
+	return DT_Index(vertices.size() / 3 - 1);
+}
+
+static void triangle(DT_Index i, DT_Index j, DT_Index k)
+{
+	indices.push_back(i);
+	indices.push_back(j);
+	indices.push_back(k);
+}
+
+// A quad from 'p' spanned by 'u' and 'v'
+static void quad(const DT_Vector3 p, const DT_Vector3 u, const DT_Vector3 v)
+{
+	DT_Index i = vertex(p[0], p[1], p[2]);
+	DT_Index j = vertex(p[0] + u[0], p[1] + u[1], p[2] + u[2]);
+	DT_Index k = vertex(p[0] + u[0] + v[0], p[1] + u[1] + v[1], p[2] + u[2] + v[2]);
+	DT_Index l = vertex(p[0] + v[0], p[1] + v[1], p[2] + v[2]);
+	triangle(i, j, k);
+	triangle(i, k, l);
+}
+
+static void box(const DT_Vector3 min, const DT_Vector3 size)
+{
+	DT_Vector3 x = { size[0], 0.0f, 0.0f };
+	DT_Vector3 y = { 0.0f, size[1], 0.0f };
+	DT_Vector3 z = { 0.0f, 0.0f, size[2] };
+	DT_Vector3 max = { min[0] + size[0], min[1] + size[1], min[2] + size[2] };
+	quad(min, y, x);
+	quad(min, z, y);
+	quad(min, x, z);
+	DT_Vector3 mx = { -size[0], 0.0f, 0.0f };
+	DT_Vector3 my = { 0.0f, -size[1], 0.0f };
+	DT_Vector3 mz = { 0.0f, 0.0f, -size[2] };
+	quad(max, mx, my);
+	quad(max, my, mz);
+	quad(max, mz, mx);
+}
+
+static void building()
+{
+	DT_Scalar side = ROOM * DT_Scalar(NUM_ROOMS);
+	DT_Vector3 along_x = { side, 0.0f, 0.0f };
+	DT_Vector3 along_z = { 0.0f, 0.0f, side };
+	DT_Vector3 up      = { 0.0f, STORY, 0.0f };
+	DT_Vector3 room_x  = { ROOM, 0.0f, 0.0f };
+	DT_Vector3 room_z  = { 0.0f, 0.0f, ROOM };
+
+	int s, i, j, k;
+	for (s = 0; s != NUM_STORIES; ++s)
+	{
+		DT_Scalar y = STORY * DT_Scalar(s);
+		DT_Vector3 corner = { 0.0f, y, 0.0f };
+		quad(corner, along_z, along_x);
+
+		for (i = 0; i <= NUM_ROOMS; ++i)
+		{
+			for (j = 0; j != NUM_ROOMS; ++j)
+			{
+				DT_Vector3 p = { ROOM * DT_Scalar(i), y, ROOM * DT_Scalar(j) };
+				quad(p, room_z, up);
+				DT_Vector3 q = { ROOM * DT_Scalar(j), y, ROOM * DT_Scalar(i) };
+				quad(q, up, room_x);
+			}
+		}
+
+		for (i = 0; i != NUM_ROOMS; ++i)
+		{
+			for (j = 0; j != NUM_ROOMS; ++j)
+			{
+				for (k = 0; k != NUM_ITEMS; ++k)
+				{
+					DT_Vector3 size = { random_scalar(0.1f, 0.6f), random_scalar(0.1f, 0.6f), random_scalar(0.1f, 0.6f) };
+					DT_Vector3 min = { ROOM * DT_Scalar(i) + random_scalar(0.0f, ROOM - size[0]), 
+									   y + random_scalar(0.0f, 1.0f), 
+									   ROOM * DT_Scalar(j) + random_scalar(0.0f, ROOM - size[2]) };
+					box(min, size);
+				}
+			}
+		}
+	}
+}
+
+static void ball(DT_Scalar radius, int slices, int stacks)
+{
+	DT_Index top = vertex(0.0f, radius, 0.0f);
+	DT_Index bottom = vertex(0.0f, -radius, 0.0f);
+	DT_Index first = DT_Index(vertices.size() / 3);
+
+	int i, j;
+	for (j = 1; j != stacks; ++j)
+	{
+		DT_Scalar theta = 3.14159265f * DT_Scalar(j) / DT_Scalar(stacks);
+		for (i = 0; i != slices; ++i)
+		{
+			DT_Scalar phi = 2.0f * 3.14159265f * DT_Scalar(i) / DT_Scalar(slices);
+			vertex(radius * DT_Scalar(sin(theta) * cos(phi)), 
+				   radius * DT_Scalar(cos(theta)), 
+				   radius * DT_Scalar(sin(theta) * sin(phi)));
+		}
+	}
+
+	for (i = 0; i != slices; ++i)
+	{
+		DT_Index next = (i + 1) % slices;
+		triangle(top, first + next, first + i);
+		for (j = 0; j + 2 != stacks; ++j)
+		{
+			DT_Index row = first + j * slices;
+			triangle(row + i, row + next, row + slices + next);
+			triangle(row + i, row + slices + next, row + slices + i);
+		}
+		DT_Index last = first + (stacks - 2) * slices;
+		triangle(bottom, last + i, last + next);
+	}
+}
+
+static DT_ShapeHandle mesh(DT_VertexBaseHandle base)
+{
+	DT_ShapeHandle shape = DT_NewComplexShape(base);
+	DT_Size i;
+	for (i = 0; i != indices.size(); i += 3)
+	{
+		DT_VertexIndices(3, &indices[i]);
+	}
+	DT_EndComplexShape();
+	return shape;
+}
+
+static void run(DT_BuildQuality quality, DT_TreeFormat format, 
+				const std::vector<DT_Scalar>& building_vertices, 
+				const std::vector<DT_Index>& building_indices, 
+				const std::vector<DT_Scalar>& ball_vertices, 
+				const std::vector<DT_Index>& ball_indices) 
+{
+	DT_SetBuildQuality(quality);
+	DT_SetTreeFormat(format);
+
+	clock_t start = clock();
+	DT_VertexBaseHandle building_base = DT_NewVertexBase(&building_vertices[0], 0);
+	indices = building_indices;
+	DT_ShapeHandle building_shape = mesh(building_base);
+	DT_VertexBaseHandle ball_base = DT_NewVertexBase(&ball_vertices[0], 0);
+	indices = ball_indices;
+	DT_ShapeHandle ball_shape = mesh(ball_base);
+	double build_time = double(clock() - start) / CLOCKS_PER_SEC;
+
+	static int ids[2] = { 0, 1 };
+	DT_ObjectHandle building_object = DT_CreateObject(&ids[0], building_shape);
+	DT_ObjectHandle ball_object = DT_CreateObject(&ids[1], ball_shape);
+
+	DT_SceneHandle scene = DT_CreateScene();
+	DT_AddObject(scene, building_object);
+	DT_AddObject(scene, ball_object);
+
+	printf("%s %s build: %.3f s, tree of %d bytes\n", quality == DT_SAH_BUILD ? "SAH" : "fast", 
+		   format == DT_QUAD_TREE ? "quad" : "binary", build_time, 
+		   int(DT_GetTreeSize(building_shape) + DT_GetTreeSize(ball_shape)));
+
+	static const char *names[] = { "simple", "witnessed", "depth" };
+	static const DT_ResponseType types[] = { DT_SIMPLE_RESPONSE, DT_WITNESSED_RESPONSE, DT_DEPTH_RESPONSE };
+	
+	int k;
+	for (k = 0; k != 3; ++k)
+	{
+		DT_RespTableHandle respTable = DT_CreateRespTable();
+		DT_ResponseClass responseClass = DT_GenResponseClass(respTable);
+		DT_AddDefaultResponse(respTable, &count, types[k], 0);
+		DT_SetResponseClass(respTable, building_object, responseClass);
+		DT_SetResponseClass(respTable, ball_object, responseClass);
+
+		num_contacts = 0;
+#ifdef STATISTICS
+		num_box_tests = 0;
+#endif
+		srand(7);
+
+		start = clock();
+		int i;
+		for (i = 0; i != NUM_PLACEMENTS; ++i)
+		{
+			DT_Vector3 position = { 
+				random_scalar(0.0f, ROOM * DT_Scalar(NUM_ROOMS)),
+				random_scalar(0.0f, STORY * DT_Scalar(NUM_STORIES)),
+				random_scalar(0.0f, ROOM * DT_Scalar(NUM_ROOMS))
+			};
+			DT_SetPosition(ball_object, position);
+			DT_Test(scene, respTable);
+		}
+		double time = double(clock() - start) / CLOCKS_PER_SEC;
+
+#ifdef STATISTICS
+		printf("  %-9s %6d contacts, %9d box tests, %.3f s\n", names[k], num_contacts, num_box_tests, time);
+#else
+		printf("  %-9s %6d contacts, %.3f s\n", names[k], num_contacts, time);
+#endif
+		DT_DestroyRespTable(respTable);
+	}
+
+	// The same rays are cast for the nearest hit, and then tested for any hit
+	for (k = 0; k != 2; ++k)
+	{
+		int num_hits = 0;
+		srand(11);
+		start = clock();
+		int i;
+		for (i = 0; i != NUM_RAYS; ++i)
+		{
+			DT_Vector3 source = { 
+				random_scalar(0.0f, ROOM * DT_Scalar(NUM_ROOMS)),
+				random_scalar(0.0f, STORY * DT_Scalar(NUM_STORIES)),
+				random_scalar(0.0f, ROOM * DT_Scalar(NUM_ROOMS))
+			};
+			DT_Vector3 target = { 
+				source[0] + random_scalar(-ROOM, ROOM),
+				source[1] + random_scalar(-STORY, STORY),
+				source[2] + random_scalar(-ROOM, ROOM)
+			};
+			DT_Scalar param;
+			DT_Vector3 normal;
+			if (k == 0 ? DT_ObjectRayCast(building_object, source, target, 1.0f, &param, normal) :
+				         DT_ObjectRayTest(building_object, source, target, 1.0f))
+			{
+				++num_hits;
+			}
+		}
+		printf("  %-9s %6d hits, %.3f s\n", k == 0 ? "rays" : "any hit", num_hits, 
+			   double(clock() - start) / CLOCKS_PER_SEC);
+	}
+
+	DT_RemoveObject(scene, building_object);
+	DT_RemoveObject(scene, ball_object);
+	DT_DestroyScene(scene);
+	DT_DestroyObject(building_object);
+	DT_DestroyObject(ball_object);
+	DT_DeleteShape(building_shape);
+	DT_DeleteShape(ball_shape);
+	DT_DeleteVertexBase(building_base);
+	DT_DeleteVertexBase(ball_base);
+}
+
+int main() 
+{
+	srand(1);
+
+	building();
+	std::vector<DT_Scalar> building_vertices(vertices);
+	std::vector<DT_Index> building_indices(indices);
+
+	vertices.clear();
+	indices.clear();
+	ball(0.3f, 16, 8);
+	std::vector<DT_Scalar> ball_vertices(vertices);
+	std::vector<DT_Index> ball_indices(indices);
+
+	printf("A building of %d triangles and a ball of %d triangles, %d placements\n", 
+		   int(building_indices.size() / 3), int(ball_indices.size() / 3), NUM_PLACEMENTS);
+
+	run(DT_FAST_BUILD, DT_BINARY_TREE, building_vertices, building_indices, ball_vertices, ball_indices);
+	run(DT_FAST_BUILD, DT_QUAD_TREE, building_vertices, building_indices, ball_vertices, ball_indices);
+	run(DT_SAH_BUILD, DT_BINARY_TREE, building_vertices, building_indices, ball_vertices, ball_indices);
+	run(DT_SAH_BUILD, DT_QUAD_TREE, building_vertices, building_indices, ball_vertices, ball_indices);
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <SOLID.h>
+
+// Measures the cost of maintaining the pairs of overlapping objects. The 
+// objects are packed in clusters in which every object overlaps every 
+// other, so that the scene holds over 100000 pairs. No responses are set, 
+// so DT_Test only walks the pairs.
+
+const int NUM_CLUSTERS = 20;
+const int CLUSTER_SIZE = 101;
+const int NUM_OBJECTS  = NUM_CLUSTERS * CLUSTER_SIZE;
+const int NUM_TESTS    = 100;
+const int NUM_TOGGLES  = 10;
+
+static DT_Scalar random_offset()
+{
+	return DT_Scalar(rand()) / DT_Scalar(RAND_MAX) * DT_Scalar(0.1);
+}
+
+static double seconds(clock_t start)
+{
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main() 
+{
+	DT_ShapeHandle shape = DT_NewSphere(1.0f);
+	DT_SceneHandle scene = DT_CreateScene();
+	DT_RespTableHandle respTable = DT_CreateRespTable();
+
+	static DT_ObjectHandle objects[NUM_OBJECTS];
+	static DT_Vector3 packed[NUM_OBJECTS];
+	static DT_Vector3 spread[NUM_OBJECTS];
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		packed[i][0] = DT_Scalar(i / CLUSTER_SIZE * 10) + random_offset();
+		packed[i][1] = random_offset();
+		packed[i][2] = random_offset();
+
+		spread[i][0] = DT_Scalar(i * 3);
+		spread[i][1] = DT_Scalar(100.0);
+		spread[i][2] = DT_Scalar(0.0);
+
+		objects[i] = DT_CreateObject(0, shape);
+		DT_SetPosition(objects[i], packed[i]);
+		DT_AddObject(scene, objects[i]);
+	}
+
+	const double num_pairs = NUM_CLUSTERS * (CLUSTER_SIZE * (CLUSTER_SIZE - 1) / 2);
+
+	printf("%d objects, %.0f overlapping pairs\n", NUM_OBJECTS, num_pairs);
+
+	clock_t start = clock();
+	int k;
+	for (k = 0; k != NUM_TESTS; ++k) 
+	{
+		DT_Test(scene, respTable);
+	}
+	double time = seconds(start);
+	printf("DT_Test:       %8.3f ms per call, %6.2f ns per pair\n", 
+		   time * 1e3 / NUM_TESTS, time * 1e9 / (NUM_TESTS * num_pairs));
+
+	// Each toggle ends all pairs and then begins them again. The time 
+	// includes the broad phase.
+	start = clock();
+	for (k = 0; k != NUM_TOGGLES; ++k) 
+	{
+		for (i = 0; i != NUM_OBJECTS; ++i) 
+		{
+			DT_SetPosition(objects[i], spread[i]);
+		}
+		DT_Test(scene, respTable);
+
+		for (i = 0; i != NUM_OBJECTS; ++i) 
+		{
+			DT_SetPosition(objects[i], packed[i]);
+		}
+		DT_Test(scene, respTable);
+	}
+	time = seconds(start);
+	printf("Begin and end: %8.3f ms per toggle, %6.2f ns per pair\n", 
+		   time * 1e3 / NUM_TOGGLES, time * 1e9 / (NUM_TOGGLES * 2 * num_pairs));
+
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_RemoveObject(scene, objects[i]);
+		DT_DestroyObject(objects[i]);
+	}
+
+	DT_DestroyRespTable(respTable);
+	DT_DestroyScene(scene);
+	DT_DeleteShape(shape);
+
+	return 0;
+}
@@ -0,0 +1,390 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include <SOLID.h>
+
+// Balls, boxes and capsules scattered at random above a bumpy floor, each 
+// one swaying and turning about its spot. Half of the boxes are rounded off
+// by a margin. Pairs of balls, pairs of boxes, balls and boxes, balls and 
+// capsules, pairs of capsules, and balls on the floor have closed-form tests.
+// The scene is run with these shapes and with the same shapes wrapped up as 
+// general convex shapes, which are tested by GJK, for each response type. 
+// The contacts should be the same, except for a few pairs that are just 
+// touching.
+//
+// Then every pair of nearby objects, and every object against the floor, is 
+// queried directly on a number of frames. The closed-form distance must be 
+// within TOLERANCE of the one found by GJK, and the tests for a common point 
+// and for penetration must agree, unless the objects are within TOLERANCE 
+// of touching. The penetration depths must be within DEPTH_TOLERANCE. The 
+// example fails if any pair disagrees. The tolerances are those of GJK and 
+// the penetration depth method in single precision on curved shapes. The
+// closed-form tests are exact up to rounding.
+
+const int NUM_BALLS    = 600;
+const int NUM_BOXES    = 600;
+const int NUM_CAPSULES = 600;
+const int NUM_OBJECTS  = NUM_BALLS + NUM_BOXES + NUM_CAPSULES;
+const int NUM_FRAMES   = 50;
+const DT_Scalar SIDE   = 16.0f;  // of the cube the objects are scattered in
+const DT_Scalar SWAY   = 0.1f;
+const DT_Scalar TURN   = 0.01f;  // radians per frame
+const int GRID         = 32;     // cells along each side of the floor
+const DT_Scalar REACH  = 2.5f;   // pairs whose centers are further apart never meet
+const int CHECK_FRAMES = 10;     // frames between checks of all pairs 
+const DT_Scalar TOLERANCE       = 1.0e-2f;
+const DT_Scalar DEPTH_TOLERANCE = 5.0e-2f;
+
+static DT_ObjectHandle objects[2][NUM_OBJECTS];
+static DT_ObjectHandle floors[2];
+static int ids[NUM_OBJECTS + 1];
+
+struct Motion {
+	DT_Vector3 center;
+	DT_Vector3 axis;
+	DT_Scalar  phase;
+};
+
+static Motion motions[NUM_OBJECTS];
+
+static int      num_contacts;
+static unsigned checksum;
+
+DT_Bool count(void *client_data, void *obj1, void *obj2, const DT_CollData *coll_data)
+{
+	++num_contacts;
+	// Independent of the order in which the contacts are reported
+	unsigned id1 = *static_cast<int *>(obj1);
+	unsigned id2 = *static_cast<int *>(obj2);
+	checksum += (id1 < id2 ? id1 * (NUM_OBJECTS + 1) + id2 : id2 * (NUM_OBJECTS + 1) + id1) * 2654435761u;
+	return DT_CONTINUE;
+}
+
+static DT_Scalar random_scalar(DT_Scalar min, DT_Scalar max)
+{
+	return min + (max - min) * DT_Scalar(rand()) / DT_Scalar(RAND_MAX);
+}
+
+// The placements only depend on the frame, so all runs see the same motion
+static void place(DT_ObjectHandle *objs, int frame) 
+{
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		const Motion& m = motions[i];
+		DT_Scalar t = DT_Scalar(frame) * 0.05f + m.phase;
+
+		DT_Vector3 position = {
+			m.center[0] + SWAY * DT_Scalar(sin(t)),
+			m.center[1] + SWAY * DT_Scalar(sin(t * 1.3f)),
+			m.center[2] + SWAY * DT_Scalar(cos(t * 0.7f))
+		};
+
+		DT_Scalar half_angle = (DT_Scalar(frame) * TURN + m.phase) * 0.5f;
+		DT_Scalar s = DT_Scalar(sin(half_angle));
+		DT_Quaternion orientation = { 
+			m.axis[0] * s, m.axis[1] * s, m.axis[2] * s, DT_Scalar(cos(half_angle))
+		};
+
+		DT_SetTransform(objs[i], position, orientation);
+	}
+}
+
+static void run(int set, DT_ResponseType type)
+{
+	DT_SceneHandle scene = DT_CreateScene();
+
+	DT_RespTableHandle respTable = DT_CreateRespTable();
+	DT_ResponseClass responseClass = DT_GenResponseClass(respTable);
+	DT_AddDefaultResponse(respTable, &count, type, 0);
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_SetResponseClass(respTable, objects[set][i], responseClass);
+	}
+	DT_SetResponseClass(respTable, floors[set], responseClass);
+
+	place(objects[set], 0);
+	DT_AddObjects(scene, NUM_OBJECTS, objects[set]);
+	DT_AddObject(scene, floors[set]);
+
+	num_contacts = 0;
+	checksum = 0;
+
+	clock_t start = clock();
+	int frame;
+	for (frame = 0; frame != NUM_FRAMES; ++frame)
+	{
+		place(objects[set], frame);
+		DT_Test(scene, respTable);
+	}
+	double time = double(clock() - start) / CLOCKS_PER_SEC;
+	
+	printf("  %-11s %8d contacts (%08x), %.3f s\n", 
+		   set == 0 ? "closed-form" : "general", num_contacts, checksum, time);
+
+	DT_RemoveObjects(scene, NUM_OBJECTS, objects[set]);
+	DT_RemoveObject(scene, floors[set]);
+	DT_DestroyScene(scene);
+	DT_DestroyRespTable(respTable);
+}
+
+static DT_Scalar distance(const DT_Vector3 p, const DT_Vector3 q)
+{
+	return DT_Scalar(sqrt((p[0] - q[0]) * (p[0] - q[0]) + 
+						  (p[1] - q[1]) * (p[1] - q[1]) + 
+						  (p[2] - q[2]) * (p[2] - q[2])));
+}
+
+static DT_Scalar max_dist_diff;
+static DT_Scalar max_depth_diff;
+
+// Queries a pair in both sets, and tells whether the outcomes agree. The 
+// tests for a common point and for penetration may go either way for pairs 
+// that are within TOLERANCE of touching.
+static bool agree(DT_ObjectHandle a[2], DT_ObjectHandle b[2])
+{
+	DT_Scalar dist[2], depth[2];
+	DT_Bool common[2], penetrate[2];
+	int j;
+	for (j = 0; j != 2; ++j)
+	{
+		DT_Vector3 p, q;
+		dist[j] = DT_GetClosestPair(a[j], b[j], p, q);
+		common[j] = DT_GetCommonPoint(a[j], b[j], p);
+		penetrate[j] = DT_GetPenDepth(a[j], b[j], p, q);
+		depth[j] = penetrate[j] ? distance(p, q) : DT_Scalar(0.0);
+	}
+
+	DT_Scalar dist_diff = DT_Scalar(fabs(dist[0] - dist[1]));
+	if (dist_diff > max_dist_diff)
+	{
+		max_dist_diff = dist_diff;
+	}
+	bool touching = dist[0] <= TOLERANCE && depth[0] <= TOLERANCE;
+	if (dist_diff > TOLERANCE || 
+		(!touching && (common[0] != common[1] || penetrate[0] != penetrate[1])))
+	{
+		return false;
+	}
+
+	if (penetrate[0] && penetrate[1])
+	{
+		DT_Scalar depth_diff = DT_Scalar(fabs(depth[0] - depth[1]));
+		if (depth_diff > max_depth_diff)
+		{
+			max_depth_diff = depth_diff;
+		}
+		return depth_diff <= DEPTH_TOLERANCE;
+	}
+	return true;
+}
+
+static int check()
+{
+	std::vector<int> pairs;
+	int i, j;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		for (j = i + 1; j != NUM_OBJECTS; ++j) 
+		{
+			if (distance(motions[i].center, motions[j].center) < REACH)
+			{
+				pairs.push_back(i);
+				pairs.push_back(j);
+			}
+		}
+	}
+	int num_pairs = int(pairs.size()) / 2;
+
+	int failures = 0;
+	int num_checks = 0;
+	int frame;
+	for (frame = 0; frame < NUM_FRAMES; frame += CHECK_FRAMES)
+	{
+		place(objects[0], frame);
+		place(objects[1], frame);
+		for (i = 0; i != NUM_OBJECTS + num_pairs; ++i) 
+		{
+			DT_ObjectHandle a[2], b[2];
+			for (j = 0; j != 2; ++j)
+			{
+				if (i < NUM_OBJECTS)
+				{
+					a[j] = objects[j][i];
+					b[j] = floors[j];
+				}
+				else
+				{
+					a[j] = objects[j][pairs[2 * (i - NUM_OBJECTS)]];
+					b[j] = objects[j][pairs[2 * (i - NUM_OBJECTS) + 1]];
+				}
+			}
+
+			if (!agree(a, b))
+			{
+				++failures;
+			}
+			++num_checks;
+		}
+	}
+
+	printf("%d pairs checked, largest difference in distance %g and in depth %g, %d disagreements\n", 
+		   num_checks, double(max_dist_diff), double(max_depth_diff), failures);
+	return failures;
+}
+
+int main() 
+{
+	DT_Vector3 source = { -0.8f, 0.0f, 0.0f };
+	DT_Vector3 target = {  0.8f, 0.0f, 0.0f };
+	DT_Vector3 origin = {  0.0f, 0.0f, 0.0f };
+
+	DT_ShapeHandle shapes[2][3];
+	shapes[0][0] = DT_NewSphere(0.4f);
+	shapes[0][1] = DT_NewBox(1.0f, 0.6f, 0.4f);
+	shapes[0][2] = DT_NewLineSegment(source, target);
+
+	// A Minkowski sum with a point hides the type of a shape
+	DT_ShapeHandle point = DT_NewPoint(origin);
+	int k;
+	for (k = 0; k != 3; ++k)
+	{
+		shapes[1][k] = DT_NewMinkowski(shapes[0][k], point);
+	}
+
+	srand(1);
+
+	static DT_Vector3 vertices[(GRID + 1) * (GRID + 1)];
+	int i, j;
+	for (i = 0; i <= GRID; ++i) 
+	{
+		for (j = 0; j <= GRID; ++j) 
+		{
+			DT_Scalar *v = vertices[i * (GRID + 1) + j];
+			v[0] = SIDE * DT_Scalar(i) / DT_Scalar(GRID);
+			v[1] = random_scalar(-0.3f, 0.3f);
+			v[2] = SIDE * DT_Scalar(j) / DT_Scalar(GRID);
+		}
+	}
+
+	DT_VertexBaseHandle base = DT_NewVertexBase(vertices, 0);
+	DT_ShapeHandle ground = DT_NewComplexShape(base);
+	for (i = 0; i != GRID; ++i) 
+	{
+		for (j = 0; j != GRID; ++j) 
+		{
+			DT_Index corner = i * (GRID + 1) + j;
+			DT_Index lower[3] = { corner, corner + 1, corner + GRID + 1 };
+			DT_Index upper[3] = { corner + 1, corner + GRID + 2, corner + GRID + 1 };
+			DT_VertexIndices(3, lower);
+			DT_VertexIndices(3, upper);
+		}
+	}
+	DT_EndComplexShape();
+
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		ids[i] = i;
+		k = i < NUM_BALLS ? 0 : i < NUM_BALLS + NUM_BOXES ? 1 : 2;
+		for (j = 0; j != 2; ++j)
+		{
+			objects[j][i] = DT_CreateObject(&ids[i], shapes[j][k]);
+			if (k == 2)
+			{
+				DT_SetMargin(objects[j][i], 0.3f);
+			}
+			else if (k == 1 && i % 2 == 1)
+			{
+				DT_SetMargin(objects[j][i], 0.1f);
+			}
+		}
+
+		Motion& m = motions[i];
+		m.center[0] = random_scalar(0.0f, SIDE);
+		m.center[1] = random_scalar(-0.5f, SIDE);
+		m.center[2] = random_scalar(0.0f, SIDE);
+
+		DT_Scalar len;
+		do 
+		{
+			m.axis[0] = random_scalar(-1.0f, 1.0f);
+			m.axis[1] = random_scalar(-1.0f, 1.0f);
+			m.axis[2] = random_scalar(-1.0f, 1.0f);
+			len = DT_Scalar(sqrt(m.axis[0] * m.axis[0] + m.axis[1] * m.axis[1] + m.axis[2] * m.axis[2]));
+		}
+		while (len < 0.1f || len > 1.0f);
+		m.axis[0] /= len;
+		m.axis[1] /= len;
+		m.axis[2] /= len;
+
+		m.phase = random_scalar(0.0f, 6.2832f);
+	}
+
+	ids[NUM_OBJECTS] = NUM_OBJECTS;
+	for (j = 0; j != 2; ++j)
+	{
+		floors[j] = DT_CreateObject(&ids[NUM_OBJECTS], ground);
+	}
+
+	printf("%d balls, %d boxes and %d capsules above a floor of %d triangles, %d frames\n", 
+		   NUM_BALLS, NUM_BOXES, NUM_CAPSULES, 2 * GRID * GRID, NUM_FRAMES);
+
+	static const char *names[] = { "simple", "witnessed", "depth" };
+	static const DT_ResponseType types[] = { DT_SIMPLE_RESPONSE, DT_WITNESSED_RESPONSE, DT_DEPTH_RESPONSE };
+	
+	for (k = 0; k != 3; ++k)
+	{
+		printf("%s response:\n", names[k]);
+		run(0, types[k]);
+		run(1, types[k]);
+	}
+
+	int failures = check();
+
+	for (j = 0; j != 2; ++j)
+	{
+		for (i = 0; i != NUM_OBJECTS; ++i) 
+		{
+			DT_DestroyObject(objects[j][i]);
+		}
+		DT_DestroyObject(floors[j]);
+	}
+	for (k = 0; k != 3; ++k)
+	{
+		DT_DeleteShape(shapes[1][k]);
+		DT_DeleteShape(shapes[0][k]);
+	}
+	DT_DeleteShape(point);
+	DT_DeleteShape(ground);
+	DT_DeleteVertexBase(base);
+
+	return failures == 0 ? 0 : 1;
+}
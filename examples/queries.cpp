@@ -0,0 +1,394 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <SOLID.h>
+#include <SOLID_broad.h>
+
+// Runs ray casts, closest pair and penetration depth queries from all 
+// threads at once, for each type of broad phase. Some of the objects are 
+// moved between rounds of rays, and the next round of rays must see the 
+// moves without any other call. All broad phases see the same moves and must report the same 
+// number of hits. Every result is checked against the same query done on a 
+// single thread beforehand, and a test for any hit on a scene against the 
+// cast. 
+// Each broad phase is also checked to report boxes that touch at zero, 
+// where one of them ends at -0. Without OpenMP the queries run on one 
+// thread only.
+
+const int NUM_OBJECTS = 2000;
+const int NUM_RAYS    = 2000;
+const int NUM_PAIRS   = NUM_OBJECTS / 2;
+const int NUM_ROUNDS  = 5;
+const DT_Scalar WORLD_SIZE = 60.0f;
+const DT_Scalar RAY_LENGTH = 10.0f;
+
+struct RayResult {
+	void      *m_client;
+	DT_Scalar  m_param;
+	DT_Vector3 m_normal;
+	DT_Bool    m_any_hit;
+	DT_Bool    m_object_hit;
+	DT_Scalar  m_object_param;
+	DT_Vector3 m_object_normal;
+};
+
+struct PairResult {
+	DT_Scalar  m_dist;
+	DT_Vector3 m_closest1;
+	DT_Vector3 m_closest2;
+	DT_Bool    m_penetrating;
+	DT_Vector3 m_depth1;
+	DT_Vector3 m_depth2;
+};
+
+static DT_Scalar random_scalar(DT_Scalar range)
+{
+	return DT_Scalar(rand()) / DT_Scalar(RAND_MAX) * range;
+}
+
+static double now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return double(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static DT_ObjectHandle objects[NUM_OBJECTS];
+static int ids[NUM_OBJECTS];
+static DT_Vector3 positions[NUM_OBJECTS];
+static DT_Vector3 sources[NUM_RAYS];
+static DT_Vector3 targets[NUM_RAYS];
+
+static void castRay(DT_SceneHandle scene, int i, RayResult& result)
+{
+	memset(&result, 0, sizeof(result));
+	result.m_client = DT_RayCast(scene, 0, sources[i], targets[i], 1.0f, 
+								 &result.m_param, result.m_normal);
+	result.m_any_hit = DT_RayTest(scene, 0, sources[i], targets[i], 1.0f) != 0;
+
+	// The same ray against a single object, moved onto the ray
+	const DT_Scalar *position = positions[i % NUM_OBJECTS];
+	DT_Vector3 source, target;
+	int k;
+	for (k = 0; k != 3; ++k) 
+	{
+		source[k] = position[k] + sources[i][k] - targets[i][k];
+		target[k] = position[k] + targets[i][k] - sources[i][k];
+	}
+	result.m_object_hit = DT_ObjectRayCast(objects[i % NUM_OBJECTS], source, target, 1.0f, 
+										   &result.m_object_param, result.m_object_normal);
+}
+
+static void queryPair(int i, PairResult& result)
+{
+	memset(&result, 0, sizeof(result));
+	DT_ObjectHandle object1 = objects[2 * i];
+	DT_ObjectHandle object2 = objects[2 * i + 1];
+	result.m_dist = DT_GetClosestPair(object1, object2, result.m_closest1, result.m_closest2);
+	result.m_penetrating = DT_GetPenDepth(object1, object2, result.m_depth1, result.m_depth2);
+}
+
+static void countOverlap(void *client_data, void *object1, void *object2)
+{
+	++*static_cast<int *>(client_data);
+}
+
+static void uncountOverlap(void *client_data, void *object1, void *object2)
+{
+	--*static_cast<int *>(client_data);
+}
+
+// Two boxes that touch at x = 0, added in both orders. The maximum of the 
+// first is -0, which compares equal to the minimum +0 of the second.
+static bool touchAtZero(DT_BroadphaseType type, DT_Scalar param)
+{
+	static const DT_Vector3 min1 = { -1.0f, -1.0f, -1.0f };
+	static const DT_Vector3 max1 = { -0.0f,  1.0f,  1.0f };
+	static const DT_Vector3 min2 = {  0.0f, -0.5f, -0.5f };
+	static const DT_Vector3 max2 = {  1.0f,  0.5f,  0.5f };
+
+	bool touching = true;
+	int order;
+	for (order = 0; order != 2; ++order)
+	{
+		int count = 0;
+		BP_SceneHandle scene = BP_CreateSceneOfType(type, param, &count, 
+													&countOverlap, &uncountOverlap);
+		if (order == 0)
+		{
+			BP_CreateProxy(scene, &ids[0], min1, max1);
+			BP_CreateProxy(scene, &ids[1], min2, max2);
+		}
+		else
+		{
+			BP_CreateProxy(scene, &ids[1], min2, max2);
+			BP_CreateProxy(scene, &ids[0], min1, max1);
+		}
+		if (count != 1)
+		{
+			touching = false;
+		}
+		BP_DestroyScene(scene);
+	}
+	return touching;
+}
+
+int main() 
+{
+	DT_Vector3 points[24];
+	int i;
+	for (i = 0; i != 24; ++i) 
+	{
+		points[i][0] = random_scalar(2.0f) - 1.0f;
+		points[i][1] = random_scalar(2.0f) - 1.0f;
+		points[i][2] = random_scalar(2.0f) - 1.0f;
+	}
+
+	DT_ShapeHandle shapes[4];
+	shapes[0] = DT_NewSphere(1.0f);
+	shapes[1] = DT_NewBox(1.5f, 1.0f, 2.0f);
+	shapes[2] = DT_NewCylinder(0.8f, 1.5f);
+	shapes[3] = DT_NewPolytope(0);
+	for (i = 0; i != 24; ++i) 
+	{
+		DT_Vertex(points[i]);
+	}
+	DT_EndPolytope();
+
+	// Pairs of objects are placed close to each other, so that many of 
+	// them overlap.
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_Scalar *position = positions[i];
+		if (i % 2 == 0)
+		{
+			position[0] = random_scalar(WORLD_SIZE);
+			position[1] = random_scalar(WORLD_SIZE);
+			position[2] = random_scalar(WORLD_SIZE);
+		}
+		else
+		{
+			position[0] = positions[i - 1][0] + random_scalar(2.0f) + 1.0f;
+			position[1] = positions[i - 1][1] + random_scalar(1.0f);
+			position[2] = positions[i - 1][2] + random_scalar(1.0f);
+		}
+
+		DT_Quaternion orientation = { 
+			random_scalar(1.0f), random_scalar(1.0f), random_scalar(1.0f), 1.0f 
+		};
+		DT_Scalar len = DT_Scalar(sqrt(orientation[0] * orientation[0] + orientation[1] * orientation[1] + 
+									   orientation[2] * orientation[2] + 1.0f));
+		orientation[0] /= len;
+		orientation[1] /= len;
+		orientation[2] /= len;
+		orientation[3] /= len;
+
+		ids[i] = i;
+		objects[i] = DT_CreateObject(&ids[i], shapes[i % 4]);
+		DT_SetTransform(objects[i], position, orientation);
+		if (i % 4 == 3)
+		{
+			DT_SetObjectMode(objects[i], DT_STATIC);
+		}
+	}
+
+	for (i = 0; i != NUM_RAYS; ++i) 
+	{
+		sources[i][0] = random_scalar(WORLD_SIZE);
+		sources[i][1] = random_scalar(WORLD_SIZE);
+		sources[i][2] = random_scalar(WORLD_SIZE);
+		targets[i][0] = sources[i][0] + random_scalar(2.0f * RAY_LENGTH) - RAY_LENGTH;
+		targets[i][1] = sources[i][1] + random_scalar(2.0f * RAY_LENGTH) - RAY_LENGTH;
+		targets[i][2] = sources[i][2] + random_scalar(2.0f * RAY_LENGTH) - RAY_LENGTH;
+	}
+
+#ifdef _OPENMP
+	printf("%d threads\n", omp_get_max_threads());
+#else
+	printf("built without OpenMP, so the queries run on a single thread only\n");
+#endif
+
+	static PairResult pairs[NUM_PAIRS];
+	for (i = 0; i != NUM_PAIRS; ++i) 
+	{
+		queryPair(i, pairs[i]);
+	}
+
+	int failures = 0;
+	int j;
+
+	double start = now();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:failures)
+#endif
+	for (j = 0; j < NUM_ROUNDS * NUM_PAIRS; ++j) 
+	{
+		PairResult result;
+		queryPair(j % NUM_PAIRS, result);
+		if (memcmp(&result, &pairs[j % NUM_PAIRS], sizeof(result)) != 0)
+		{
+			++failures;
+		}
+	}
+	printf("pairs: %d queries, %d mismatches, %.3f s\n", 
+		   NUM_ROUNDS * NUM_PAIRS, failures, now() - start);
+
+	static const char *names[] = { "sweep and prune", "dynamic tree", "hashed grid", "multi sweep and prune" };
+	static const DT_Scalar params[] = { 0.0f, 0.2f, 2.0f, 20.0f };
+	
+	static DT_Vector3 start_positions[NUM_OBJECTS];
+	memcpy(start_positions, positions, sizeof(positions));
+	unsigned int seed = rand();
+	srand(seed);
+	int first_hits = 0;
+
+	int type;
+	for (type = DT_SWEEP_AND_PRUNE; type <= DT_MULTI_SWEEP_AND_PRUNE; ++type) 
+	{
+		if (!touchAtZero(DT_BroadphaseType(type), params[type]))
+		{
+			printf("%s: boxes that touch at zero do not overlap\n", names[type]);
+			++failures;
+		}
+
+		DT_SceneHandle scene = DT_CreateSceneOfType(DT_BroadphaseType(type), params[type]);
+		DT_AddObjects(scene, NUM_OBJECTS, objects);
+
+		static RayResult rays[NUM_RAYS];
+		int hits = 0;
+		int mismatches = 0;
+		double elapsed = 0.0;
+		int round;
+		for (round = 0; round != NUM_ROUNDS; ++round)
+		{
+			// Between rounds some of the objects move, as in a frame. One of
+			// the boxes is put where nothing else is, and a ray through it 
+			// right after the move must hit it.
+			if (round != 0)
+			{
+				for (i = round; i < NUM_OBJECTS; i += 8) 
+				{
+					DT_Scalar *position = positions[i];
+					position[0] += random_scalar(4.0f) - 2.0f;
+					position[1] += random_scalar(4.0f) - 2.0f;
+					position[2] += random_scalar(4.0f) - 2.0f;
+					DT_SetPosition(objects[i], position);
+				}
+
+				int box = 4 * round + 1;
+				DT_Scalar *position = positions[box];
+				position[0] = WORLD_SIZE + 10.0f * round;
+				position[1] = position[2] = -RAY_LENGTH;
+				DT_SetPosition(objects[box], position);
+
+				DT_Vector3 source = { position[0], position[1], position[2] - RAY_LENGTH };
+				DT_Vector3 target = { position[0], position[1], position[2] + RAY_LENGTH };
+				DT_Scalar param;
+				DT_Vector3 normal;
+				if (DT_RayCast(scene, 0, source, target, 1.0f, &param, normal) != &ids[box])
+				{
+					printf("%s: a moved object is missed\n", names[type]);
+					++failures;
+				}
+			}
+
+			// The rays on this thread see the scene up to date, so that the
+			// rays on all threads only read it.
+			for (i = 0; i != NUM_RAYS; ++i) 
+			{
+				castRay(scene, i, rays[i]);
+				if (rays[i].m_client)
+				{
+					++hits;
+				}
+
+				// A test for any hit agrees with the cast
+				if (rays[i].m_any_hit != (rays[i].m_client != 0))
+				{
+					++failures;
+				}
+			}
+
+			start = now();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:mismatches)
+#endif
+			for (j = 0; j < NUM_RAYS; ++j) 
+			{
+				RayResult result;
+				castRay(scene, j, result);
+				if (memcmp(&result, &rays[j], sizeof(result)) != 0)
+				{
+					++mismatches;
+				}
+			}
+			elapsed += now() - start;
+		}
+		printf("%s: %d rays, %d hits, %d mismatches, %.3f s\n", 
+			   names[type], NUM_ROUNDS * NUM_RAYS, hits, mismatches, elapsed);
+		failures += mismatches;
+
+		if (type == DT_SWEEP_AND_PRUNE)
+		{
+			first_hits = hits;
+		}
+		else if (hits != first_hits)
+		{
+			printf("%s: hits differ from %s\n", names[type], names[DT_SWEEP_AND_PRUNE]);
+			++failures;
+		}
+
+		DT_DestroyScene(scene);
+
+		// Back to the start, so that all broad phases see the same moves
+		for (i = 0; i != NUM_OBJECTS; ++i) 
+		{
+			memcpy(positions[i], start_positions[i], sizeof(DT_Vector3));
+			DT_SetPosition(objects[i], positions[i]);
+		}
+		srand(seed);
+	}
+
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_DestroyObject(objects[i]);
+	}
+	for (i = 0; i != 4; ++i) 
+	{
+		DT_DeleteShape(shapes[i]);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
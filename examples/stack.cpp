@@ -0,0 +1,178 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include <SOLID.h>
+
+// Towers of boxes that wobble a little from frame to frame, as in a physics 
+// simulation where the stacks have come to rest. The boxes are tested with 
+// and without warm starting of the intersection tests, for each response 
+// type, and the average number of GJK iterations per contact is reported. 
+// Pairs of boxes have closed-form tests, so the boxes are wrapped up as 
+// general convex shapes to have them tested by GJK. The iterations are only 
+// counted if the library and this program are built with STATISTICS defined.
+
+#ifndef STATISTICS
+#error "The stack example counts GJK iterations. Build it and the library with STATISTICS defined (USE_STATISTICS with CMake, --enable-statistics with configure)."
+#endif
+
+extern int num_iterations;
+
+const int NUM_TOWERS  = 20;  // along each side of the grid
+const int HEIGHT      = 10;
+const int NUM_OBJECTS = NUM_TOWERS * NUM_TOWERS * HEIGHT;
+const int NUM_FRAMES  = 50;
+const DT_Scalar SPACING = 2.0f;
+const DT_Scalar SINKING = 0.01f;
+const DT_Scalar WOBBLE  = 0.02f;
+const DT_Scalar MARGIN  = 0.05f;
+
+static DT_ObjectHandle objects[NUM_OBJECTS];
+static int ids[NUM_OBJECTS];
+
+static int    num_contacts;
+static double sum_iterations;
+
+DT_Bool count(void *client_data, void *obj1, void *obj2, const DT_CollData *coll_data)
+{
+	++num_contacts;
+	// The responses of DT_Test are called right after the test on the pair
+	sum_iterations += num_iterations;
+	return DT_CONTINUE;
+}
+
+// The placements only depend on the frame, so all runs see the same motion
+static void place(int frame) 
+{
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		int tower = i / HEIGHT;
+		int level = i % HEIGHT;
+		DT_Scalar phase = DT_Scalar(frame) * 0.3f + DT_Scalar(i) * 0.7f;
+
+		DT_Vector3 position = {
+			DT_Scalar(tower % NUM_TOWERS) * SPACING + WOBBLE * DT_Scalar(sin(phase)),
+			DT_Scalar(level) * (1.0f - SINKING) + 0.5f,
+			DT_Scalar(tower / NUM_TOWERS) * SPACING + WOBBLE * DT_Scalar(cos(phase))
+		};
+
+		// A fixed turn about the vertical axis per box, plus a slight tilt
+		DT_Scalar yaw = DT_Scalar(i % 7) * 0.1f;
+		DT_Scalar tilt = WOBBLE * DT_Scalar(sin(phase * 1.3f));
+		DT_Quaternion orientation = { 
+			tilt * 0.5f, DT_Scalar(sin(yaw * 0.5f)), 0.0f, DT_Scalar(cos(yaw * 0.5f))
+		};
+		DT_Scalar len = DT_Scalar(sqrt(orientation[0] * orientation[0] + orientation[1] * orientation[1] + 
+									   orientation[3] * orientation[3]));
+		orientation[0] /= len;
+		orientation[1] /= len;
+		orientation[3] /= len;
+
+		DT_SetTransform(objects[i], position, orientation);
+	}
+}
+
+static void run(DT_ResponseType type, DT_Bool warm_start, DT_Scalar margin)
+{
+	DT_SceneHandle scene = DT_CreateScene();
+	DT_SetWarmStart(scene, warm_start);
+
+	DT_RespTableHandle respTable = DT_CreateRespTable();
+	DT_ResponseClass responseClass = DT_GenResponseClass(respTable);
+	DT_AddDefaultResponse(respTable, &count, type, 0);
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_SetMargin(objects[i], margin);
+		DT_SetResponseClass(respTable, objects[i], responseClass);
+	}
+
+	place(0);
+	DT_AddObjects(scene, NUM_OBJECTS, objects);
+
+	num_contacts = 0;
+	sum_iterations = 0.0;
+
+	clock_t start = clock();
+	int frame;
+	for (frame = 0; frame != NUM_FRAMES; ++frame)
+	{
+		place(frame);
+		DT_Test(scene, respTable);
+	}
+	double time = double(clock() - start) / CLOCKS_PER_SEC;
+	
+	printf("  %-4s %8d contacts, %.2f iterations per contact, %.3f s\n", warm_start ? "warm" : "cold", 
+		   num_contacts, num_contacts != 0 ? sum_iterations / num_contacts : 0.0, time);
+
+	DT_RemoveObjects(scene, NUM_OBJECTS, objects);
+	DT_DestroyScene(scene);
+	DT_DestroyRespTable(respTable);
+}
+
+int main() 
+{
+	// A Minkowski sum with a point hides the type of a shape
+	DT_Vector3 origin = { 0.0f, 0.0f, 0.0f };
+	DT_ShapeHandle box = DT_NewBox(1.0f, 1.0f, 1.0f);
+	DT_ShapeHandle point = DT_NewPoint(origin);
+	DT_ShapeHandle shape = DT_NewMinkowski(box, point);
+
+	int i;
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		ids[i] = i;
+		objects[i] = DT_CreateObject(&ids[i], shape);
+	}
+
+	printf("%d boxes in %d towers, %d frames\n", NUM_OBJECTS, NUM_TOWERS * NUM_TOWERS, NUM_FRAMES);
+
+	static const char *names[] = { "simple", "witnessed", "depth" };
+	static const DT_ResponseType types[] = { DT_SIMPLE_RESPONSE, DT_WITNESSED_RESPONSE, DT_DEPTH_RESPONSE };
+	
+	int k;
+	for (k = 0; k != 3; ++k)
+	{
+		printf("%s response:\n", names[k]);
+		run(types[k], DT_FALSE, 0.0f);
+		run(types[k], DT_TRUE, 0.0f);
+		printf("%s response, margin %g:\n", names[k], MARGIN);
+		run(types[k], DT_FALSE, MARGIN);
+		run(types[k], DT_TRUE, MARGIN);
+	}
+
+	for (i = 0; i != NUM_OBJECTS; ++i) 
+	{
+		DT_DestroyObject(objects[i]);
+	}
+	DT_DeleteShape(shape);
+	DT_DeleteShape(point);
+	DT_DeleteShape(box);
+
+	return 0;
+}
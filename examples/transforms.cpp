@@ -0,0 +1,177 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "MT_Transform.h"
+#include "MT_Quaternion.h"
+#include "MT_Point3.h"
+
+// Times the transform arithmetic on which the intersection tests spend most
+// of their time: composition, inversion, and the support mapping of a box 
+// placed by a transform, as done by DT_Transform and DT_Box. Build with and
+// without USE_SSE to compare. The checksums should agree up to rounding.
+// Each test is run a few times and the best time is reported.
+
+const int NUM_TRANSFORMS = 1024;  // a power of two
+const int NUM_ROUNDS     = 500;
+const int NUM_OPS        = NUM_TRANSFORMS * NUM_ROUNDS;
+const int NUM_TRIALS     = 5;
+
+static MT_Transform transforms[NUM_TRANSFORMS];
+static MT_Transform results[NUM_TRANSFORMS];
+static MT_Vector3   directions[NUM_TRANSFORMS];
+
+static double nanoseconds(clock_t start)
+{
+	return double(clock() - start) / CLOCKS_PER_SEC * 1e9 / NUM_OPS;
+}
+
+static MT_Scalar checksum()
+{
+	MT_Scalar sum = MT_Scalar(0.0);
+	int i;
+	for (i = 0; i != NUM_TRANSFORMS; ++i)
+	{
+		const MT_Matrix3x3& basis = results[i].getBasis();
+		sum += basis[0][0] + basis[1][1] + basis[2][2] + results[i].getOrigin()[0];
+	}
+	return sum;
+}
+
+static MT_Point3 box_support(const MT_Vector3& extent, const MT_Vector3& v)
+{
+	return MT_Point3(v[0] < MT_Scalar(0.0) ? -extent[0] : extent[0],
+					 v[1] < MT_Scalar(0.0) ? -extent[1] : extent[1],
+					 v[2] < MT_Scalar(0.0) ? -extent[2] : extent[2]);
+}
+
+static void compose(bool scaled)
+{
+	double time = 1e30;
+	int trial;
+	for (trial = 0; trial != NUM_TRIALS; ++trial)
+	{
+		clock_t start = clock();
+		int round;
+		for (round = 0; round != NUM_ROUNDS; ++round)
+		{
+			int i;
+			for (i = 0; i != NUM_TRANSFORMS; ++i)
+			{
+				results[i] = transforms[i] * transforms[(i + round) & (NUM_TRANSFORMS - 1)];
+			}
+		}
+		time = GEN_min(time, nanoseconds(start));
+	}
+	printf("composition%s  %7.2f ns (%g)\n", scaled ? ", scaled" : "        ", time, double(checksum()));
+}
+
+static void invert(bool scaled)
+{
+	double time = 1e30;
+	int trial;
+	for (trial = 0; trial != NUM_TRIALS; ++trial)
+	{
+		clock_t start = clock();
+		int round;
+		for (round = 0; round != NUM_ROUNDS; ++round)
+		{
+			int i;
+			for (i = 0; i != NUM_TRANSFORMS; ++i)
+			{
+				results[i] = transforms[(i + round) & (NUM_TRANSFORMS - 1)].inverse();
+			}
+		}
+		time = GEN_min(time, nanoseconds(start));
+	}
+	printf("inverse%s      %7.2f ns (%g)\n", scaled ? ", scaled" : "        ", time, double(checksum()));
+}
+
+static void support(bool scaled)
+{
+	const MT_Vector3 extent(MT_Scalar(1.0), MT_Scalar(0.5), MT_Scalar(0.25));
+
+	MT_Scalar sum;
+	double time = 1e30;
+	int trial;
+	for (trial = 0; trial != NUM_TRIALS; ++trial)
+	{
+		sum = MT_Scalar(0.0);
+		clock_t start = clock();
+		int round;
+		for (round = 0; round != NUM_ROUNDS; ++round)
+		{
+			int i;
+			for (i = 0; i != NUM_TRANSFORMS; ++i)
+			{
+				const MT_Transform& xform = transforms[i];
+				const MT_Vector3& v = directions[(i + round) & (NUM_TRANSFORMS - 1)];
+				sum += v.dot(xform(box_support(extent, v * xform.getBasis())));
+			}
+		}
+		time = GEN_min(time, nanoseconds(start));
+	}
+	printf("support%s      %7.2f ns (%g)\n", scaled ? ", scaled" : "        ", time, double(sum));
+}
+
+static void place(bool scaled)
+{
+	GEN_srand(1);
+
+	int i;
+	for (i = 0; i != NUM_TRANSFORMS; ++i)
+	{
+		transforms[i].setIdentity();
+		transforms[i].setRotation(MT_Quaternion::random());
+		transforms[i].setOrigin(MT_Point3(MT_random(), MT_random(), MT_random()) * MT_Scalar(10.0));
+		if (scaled)
+		{
+			transforms[i].scale(MT_Vector3(MT_Scalar(0.5) + MT_random(), 
+										   MT_Scalar(0.5) + MT_random(),
+										   MT_Scalar(0.5) + MT_random()));
+		}
+		directions[i] = MT_Vector3::random();
+	}
+}
+
+int main() 
+{
+#ifdef USE_SSE
+	printf("SSE, ");
+#endif
+	printf("%d operations per test, best time per operation of %d runs\n", NUM_OPS, NUM_TRIALS);
+
+	int k;
+	for (k = 0; k != 2; ++k)
+	{
+		bool scaled = k != 0;
+		place(scaled);
+		compose(scaled);
+		invert(scaled);
+		support(scaled);
+	}
+
+	return 0;
+}
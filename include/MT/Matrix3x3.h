@@ -377,6 +377,133 @@ namespace MT {
 			m2.tdot(0, m1[1]), m2.tdot(1, m1[1]), m2.tdot(2, m1[1]),
 			m2.tdot(0, m1[2]), m2.tdot(1, m1[2]), m2.tdot(2, m1[2]));
 	}
+
+#ifdef USE_SSE
+
+	// The rows are loaded as a whole. The products with a row vector sum the 
+	// rows scaled by the coordinates. The products with a column vector take 
+	// the dot products of the rows by summing the columns of the transposed 
+	// products.
+
+	inline Vector3<float> 
+	operator*(const Matrix3x3<float>& m, const Vector3<float>& v) 
+	{
+		__m128 x = v.get128();
+		__m128 r0 = _mm_mul_ps(m[0].get128(), x);
+		__m128 r1 = _mm_mul_ps(m[1].get128(), x);
+		__m128 r2 = _mm_mul_ps(m[2].get128(), x);
+		__m128 r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		return Vector3<float>(_mm_add_ps(_mm_add_ps(r0, r1), r2));
+	}
+
+	inline Vector3<float>
+	operator*(const Vector3<float>& v, const Matrix3x3<float>& m)
+	{
+		__m128 x = v.get128();
+		return Vector3<float>(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 0, 0)), m[0].get128()),
+													_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)), m[1].get128())),
+										 _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2)), m[2].get128())));
+	}
+
+	inline Matrix3x3<float> 
+	operator*(const Matrix3x3<float>& m1, const Matrix3x3<float>& m2)
+	{
+		Matrix3x3<float> m;
+		m[0] = m1[0] * m2;
+		m[1] = m1[1] * m2;
+		m[2] = m1[2] * m2;
+		return m;
+	}
+
+	template <>
+	inline Matrix3x3<float>& 
+	Matrix3x3<float>::operator*=(const Matrix3x3<float>& m)
+	{
+		m_el[0] = m_el[0] * m;
+		m_el[1] = m_el[1] * m;
+		m_el[2] = m_el[2] * m;
+		return *this;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::absolute() const
+	{
+		__m128 mask = _mm_set1_ps(-0.0f);
+		Matrix3x3<float> m;
+		m[0].set128(_mm_andnot_ps(mask, m_el[0].get128()));
+		m[1].set128(_mm_andnot_ps(mask, m_el[1].get128()));
+		m[2].set128(_mm_andnot_ps(mask, m_el[2].get128()));
+		return m;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::transpose() const 
+	{
+		__m128 r0 = m_el[0].get128();
+		__m128 r1 = m_el[1].get128();
+		__m128 r2 = m_el[2].get128();
+		__m128 r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		Matrix3x3<float> m;
+		m[0].set128(r0);
+		m[1].set128(r1);
+		m[2].set128(r2);
+		return m;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::inverse() const
+	{
+		// The columns of the inverse are the cross products of the rows 
+		// divided by the determinant.
+		Matrix3x3<float> m;
+		m[0] = m_el[1].cross(m_el[2]);
+		m[1] = m_el[2].cross(m_el[0]);
+		m[2] = m_el[0].cross(m_el[1]);
+		float det = m_el[0].dot(m[0]);
+		assert(det != 0.0f);
+		__m128 s = _mm_set1_ps(1.0f / det);
+		m = m.transpose();
+		m[0].set128(_mm_mul_ps(m[0].get128(), s));
+		m[1].set128(_mm_mul_ps(m[1].get128(), s));
+		m[2].set128(_mm_mul_ps(m[2].get128(), s));
+		return m;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::scaled(const Vector3<float>& s) const
+	{
+		Matrix3x3<float> m;
+		m[0].set128(_mm_mul_ps(m_el[0].get128(), s.get128()));
+		m[1].set128(_mm_mul_ps(m_el[1].get128(), s.get128()));
+		m[2].set128(_mm_mul_ps(m_el[2].get128(), s.get128()));
+		return m;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::transposeTimes(const Matrix3x3<float>& m) const
+	{
+		return transpose() * m;
+	}
+
+	template <>
+	inline Matrix3x3<float> 
+	Matrix3x3<float>::timesTranspose(const Matrix3x3<float>& m) const
+	{
+		Matrix3x3<float> r;
+		r[0] = m * m_el[0];
+		r[1] = m * m_el[1];
+		r[2] = m * m_el[2];
+		return r;
+	}
+
+#endif
 }
 
 #endif
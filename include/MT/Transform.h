@@ -158,6 +158,17 @@ namespace MT {
 	};
 
 
+#ifdef USE_SSE
+
+	template <>
+	inline Vector3<float> 
+	Transform<float>::operator()(const Vector3<float>& x) const
+	{
+		return m_basis * x + m_origin;
+	}
+
+#endif
+
 	template <typename Scalar>
 	inline Transform<Scalar> 
 	Transform<Scalar>::inverseTimes(const Transform<Scalar>& t) const  
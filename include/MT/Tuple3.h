@@ -27,6 +27,16 @@
 #include <cassert>
 #include <iostream>
 
+#ifdef USE_SSE
+#include <xmmintrin.h>
+
+#ifdef _MSC_VER
+#define MT_ALIGN16 __declspec(align(16))
+#else
+#define MT_ALIGN16 __attribute__((aligned(16)))
+#endif
+#endif
+
 namespace MT {
 
 	template <typename Scalar>
@@ -104,6 +114,100 @@ namespace MT {
 		Scalar m_co[3];                            
 	};
 
+#ifdef USE_SSE
+
+	// Tuples of floats are padded to four lanes and aligned on 16 bytes, so 
+	// that they are loaded into an SSE register as a whole. The fourth lane 
+	// is kept zero.
+
+	template <>
+	class Tuple3<float> {
+	public:
+		Tuple3() { m_co[3] = 0.0f; }
+
+		explicit Tuple3(__m128 v) { set128(v); }
+		
+		template <typename Scalar2>
+		explicit Tuple3(const Scalar2 *v) 
+		{ 
+			m_co[3] = 0.0f;
+			setValue(v);
+		}
+		
+		// Coordinates are packed in a register rather than stored one by 
+		// one, as a load of the whole tuple would have to wait for the stores.
+		template <typename Scalar2>
+		Tuple3(const Scalar2& x, const Scalar2& y, const Scalar2& z) 
+		{ 
+			setValue(x, y, z); 
+		}
+		
+		template <typename Scalar2>
+		Tuple3(const Tuple3<Scalar2>& t) 
+		{ 
+			*this = t; 
+		}
+		
+		template <typename Scalar2>
+		Tuple3<float>& operator=(const Tuple3<Scalar2>& t) 
+		{ 
+			setValue(t[0], t[1], t[2]);
+			return *this;
+		}
+		
+		operator       float *()       { return m_co; }
+		operator const float *() const { return m_co; }
+
+		float&       operator[](int i)       { return m_co[i];	}      
+		const float& operator[](int i) const { return m_co[i]; }
+
+		float&       x()       { return m_co[0]; }
+		const float& x() const { return m_co[0]; }
+		
+		float&       y()       { return m_co[1]; }
+		const float& y() const { return m_co[1]; }
+		
+		float&       z()       { return m_co[2]; }
+		const float& z() const { return m_co[2]; }
+
+		template <typename Scalar2>
+		void setValue(const Scalar2 *v) 
+		{
+			m_co[0] = float(v[0]); 
+			m_co[1] = float(v[1]); 
+			m_co[2] = float(v[2]);
+		}
+
+		template <typename Scalar2>
+		void setValue(const Scalar2& x, const Scalar2& y, const Scalar2& z)
+		{
+			set128(_mm_setr_ps(float(x), float(y), float(z), 0.0f));
+		}
+
+		template <typename Scalar2>
+		void getValue(Scalar2 *v) const 
+		{
+			v[0] = Scalar2(m_co[0]);
+			v[1] = Scalar2(m_co[1]);
+			v[2] = Scalar2(m_co[2]);
+		}
+
+		__m128 get128() const { return _mm_load_ps(m_co); }
+		void   set128(__m128 v) { _mm_store_ps(m_co, v); }
+    
+	protected:
+		MT_ALIGN16 float m_co[4];                            
+	};
+
+	// The sum of the lanes
+	inline float sum128(__m128 v)
+	{
+		__m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+	}
+
+#endif
+
 	template <typename Scalar>
 	inline std::ostream& 
 	operator<<(std::ostream& os, const Tuple3<Scalar>& t)
@@ -42,6 +42,10 @@ namespace MT {
 		Vector3(const Scalar2& x, const Scalar2& y, const Scalar2& z) 
 			: Tuple3<Scalar>(x, y, z) 
 		{}
+
+#ifdef USE_SSE
+		explicit Vector3(__m128 v) : Tuple3<Scalar>(v) {}
+#endif
 		
 		Vector3<Scalar>& operator+=(const Vector3<Scalar>& v)
 		{
@@ -168,6 +172,90 @@ namespace MT {
 		}
 	};
 
+#ifdef USE_SSE
+
+	template <>
+	inline Vector3<float>& Vector3<float>::operator+=(const Vector3<float>& v)
+	{
+		set128(_mm_add_ps(get128(), v.get128()));
+		return *this;
+	}
+
+	template <>
+	inline Vector3<float>& Vector3<float>::operator-=(const Vector3<float>& v)
+	{
+		set128(_mm_sub_ps(get128(), v.get128()));
+		return *this;
+	}
+
+	template <>
+	inline Vector3<float>& Vector3<float>::operator*=(const float& s)
+	{
+		set128(_mm_mul_ps(get128(), _mm_set1_ps(s)));
+		return *this;
+	}
+
+	template <>
+	inline float Vector3<float>::dot(const Vector3<float>& v) const
+	{
+		return sum128(_mm_mul_ps(get128(), v.get128()));
+	}
+
+	template <>
+	inline Vector3<float> Vector3<float>::absolute() const
+	{
+		return Vector3<float>(_mm_andnot_ps(_mm_set1_ps(-0.0f), get128()));
+	}
+
+	template <>
+	inline Vector3<float> Vector3<float>::cross(const Vector3<float>& v) const
+	{
+		// The products come out in the order z, x, y
+		__m128 a = get128();
+		__m128 b = v.get128();
+		__m128 c = _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))),
+							  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), b));
+		return Vector3<float>(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+	}
+
+	template <>
+	inline float Vector3<float>::triple(const Vector3<float>& v1, const Vector3<float>& v2) const
+	{
+		return dot(v1.cross(v2));
+	}
+
+	inline Vector3<float> 
+	operator+(const Vector3<float>& v1, const Vector3<float>& v2) 
+	{
+		return Vector3<float>(_mm_add_ps(v1.get128(), v2.get128()));
+	}
+
+	inline Vector3<float> 
+	operator-(const Vector3<float>& v1, const Vector3<float>& v2)
+	{
+		return Vector3<float>(_mm_sub_ps(v1.get128(), v2.get128()));
+	}
+	
+	inline Vector3<float> 
+	operator-(const Vector3<float>& v)
+	{
+		return Vector3<float>(_mm_sub_ps(_mm_setzero_ps(), v.get128()));
+	}
+	
+	inline Vector3<float> 
+	operator*(const Vector3<float>& v, const float& s)
+	{
+		return Vector3<float>(_mm_mul_ps(v.get128(), _mm_set1_ps(s)));
+	}
+	
+	inline Vector3<float> 
+	operator*(const float& s, const Vector3<float>& v)
+	{ 
+		return v * s; 
+	}
+
+#endif
+
 	template <typename Scalar>
 	inline Vector3<Scalar> 
 	operator+(const Vector3<Scalar>& v1, const Vector3<Scalar>& v2) 
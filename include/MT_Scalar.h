@@ -86,6 +86,10 @@ struct Scalar_traits<double> {
 	static double pow(double x, double y) { return ::pow(x, y); } 
 };
 
+#if defined(USE_SSE) && (defined(USE_DOUBLES) || defined(USE_TRACER))
+#error "USE_SSE requires single-precision floating-point numbers"
+#endif
+
 #ifdef USE_TRACER
 #include "MT_ScalarTracer.h"
 
@@ -94,9 +94,31 @@ extern "C" {
 	DECLSPEC void DT_DeleteVertexBase(DT_VertexBaseHandle vertexBase);	
 	DECLSPEC void DT_ChangeVertexBase(DT_VertexBaseHandle vertexBase, const void *pointer);
 
+/* After some of the vertices of a vertex base are changed in place, only the 
+   polygons that use them, and the boxes above these in the trees of the 
+   complex shapes on the vertex base, need to be refitted. DT_ChangeVertices
+   takes the indices of the changed vertices, DT_ChangeVertexRange a range of
+   indices. The objects of a shape are left alone if the bounding box of the 
+   shape did not change. The first call for a shape refits all of the shape.
+*/
+
+	DECLSPEC void DT_ChangeVertices(DT_VertexBaseHandle vertexBase, DT_Count count, const DT_Index *indices);
+	DECLSPEC void DT_ChangeVertexRange(DT_VertexBaseHandle vertexBase, DT_Index first, DT_Count count);
+
 	DECLSPEC DT_ShapeHandle DT_NewComplexShape(DT_VertexBaseHandle vertexBase);
 	DECLSPEC void           DT_EndComplexShape();
 
+/* DT_EndComplexShape builds a tree of bounding boxes over the polygons of the 
+   shape. The build quality and the tree format hold for all complex shapes 
+   that are ended after the call. See DT_BuildQuality and DT_TreeFormat. 
+   DT_GetTreeSize returns the number of bytes taken by the tree of a complex 
+   shape, and zero for other shapes. 
+*/
+
+	DECLSPEC void    DT_SetBuildQuality(DT_BuildQuality quality);
+	DECLSPEC void    DT_SetTreeFormat(DT_TreeFormat format);
+	DECLSPEC DT_Size DT_GetTreeSize(DT_ShapeHandle shape);
+
 	DECLSPEC DT_ShapeHandle DT_NewPolytope(DT_VertexBaseHandle vertexBase);
 	DECLSPEC void           DT_EndPolytope();
 
@@ -126,6 +148,17 @@ extern "C" {
 	DECLSPEC void DT_SetOrientation(DT_ObjectHandle object, const DT_Quaternion orientation);
 	DECLSPEC void DT_SetScaling(DT_ObjectHandle object, const DT_Vector3 scaling);
 
+	DECLSPEC void DT_SetTransform(DT_ObjectHandle object, const DT_Vector3 position, 
+								  const DT_Quaternion orientation);
+
+/* Changing the placement or margin of an object does not update its bounding box 
+   right away. The box is recomputed once, on the next DT_Test, DT_ParallelTest, 
+   DT_RayCast, DT_RayTest, DT_CommitUpdate or DT_UpdateBBoxes on a scene that contains 
+   the object, so setting position and orientation separately is as cheap as a single 
+   DT_SetTransform. Each scene keeps a list of its objects that were moved, so these 
+   calls cost nothing extra if nothing moved.
+*/
+
 /* The margin is an offset from the actual shape. The actual geometry of an
    object is the set of points whose distance to the transformed shape is at 
    most the  margin. During the lifetime of an object the margin can be 
@@ -134,6 +167,13 @@ extern "C" {
    
 	DECLSPEC void DT_SetMargin(DT_ObjectHandle object, DT_Scalar margin);
 
+/* Objects that lie still, such as level geometry, can be made static or put to
+   sleep. The broad phase then only tests them against dynamic objects. Moving a
+   sleeping object makes it dynamic again. See BP_SetProxyMode.
+*/
+
+	DECLSPEC void DT_SetObjectMode(DT_ObjectHandle object, DT_ProxyMode mode);
+
 
 /* These commands assume a column-major 4x4 OpenGL matrix representation */
 
@@ -161,13 +201,65 @@ extern "C" {
 /* Scene */
 
 	DECLSPEC DT_SceneHandle DT_CreateScene(); 
+
+/* Scenes use sweep and prune by default. A dynamic tree copes better with objects that 
+   are added, removed or teleported often. A hashed grid suits large numbers of objects 
+   of about the same size. For very large worlds, sweep and prune can be done per region 
+   of space. See DT_BroadphaseType for the meaning of 'param'.
+*/
+
+	DECLSPEC DT_SceneHandle DT_CreateSceneOfType(DT_BroadphaseType type, DT_Scalar param); 
 	DECLSPEC void           DT_DestroyScene(DT_SceneHandle scene);
 
 	DECLSPEC void DT_AddObject(DT_SceneHandle scene, DT_ObjectHandle object);
 	DECLSPEC void DT_RemoveObject(DT_SceneHandle scene, DT_ObjectHandle object);
 
+/* Adding or removing a batch of objects at once is a lot cheaper than one by one,
+   for instance when streaming in a part of a level. 
+*/
+
+	DECLSPEC void DT_AddObjects(DT_SceneHandle scene, DT_Size count, 
+								const DT_ObjectHandle *objects);
+	DECLSPEC void DT_RemoveObjects(DT_SceneHandle scene, DT_Size count, 
+								   const DT_ObjectHandle *objects);
+
 /* Note that objects can be assigned to multiple scenes! */
 
+/* Placements of objects that change between DT_BeginUpdate and DT_CommitUpdate are
+   passed on to the scene's broad phase in one go on commit. Use this when many objects 
+   move each frame. DT_Test and DT_RayCast do not see uncommitted placements.
+*/
+
+	DECLSPEC void DT_BeginUpdate(DT_SceneHandle scene);
+	DECLSPEC void DT_CommitUpdate(DT_SceneHandle scene);
+
+/* Brings the bounding boxes of the objects in a scene that were moved up to date. 
+   The calls above that use the boxes do this themselves.
+*/
+
+	DECLSPEC void DT_UpdateBBoxes(DT_SceneHandle scene);
+
+/* The intersection tests of DT_Test and DT_ParallelTest on pairs of convex objects 
+   start from the result of the previous test on the same pair. This usually saves 
+   most of the work if the objects moved only a little since. Warm starting is on 
+   by default and can be turned off per scene. Turn it off for scenes with polytopes 
+   that are deformed through DT_ChangeVertexBase.
+*/
+
+	DECLSPEC void DT_SetWarmStart(DT_SceneHandle scene, DT_Bool warm_start);
+
+/* With separation culling on, a pair of convex objects that was found apart is 
+   not tested again until the objects may have moved close enough to touch. The
+   bound on the distance is conservative, so a pair that is skipped is apart, and
+   without warm starting the responses are the same as without culling. With warm
+   starting, the first test on a pair after it was skipped starts cold, so for 
+   pairs that are just touching its outcome may differ as much as it does between 
+   cold and warm started tests. Culling is off by default. Do not use it for scenes
+   with polytopes that are deformed through DT_ChangeVertexBase.
+*/
+
+	DECLSPEC void DT_SetSeparationCulling(DT_SceneHandle scene, DT_Bool cull);
+
 /* Response */
 
 /* Response tables are defined independent of the scenes in which they are used.
@@ -235,6 +327,14 @@ extern "C" {
  
 	DECLSPEC DT_Count DT_Test(DT_SceneHandle scene, DT_RespTableHandle respTable);
 
+/* DT_ParallelTest does the same as DT_Test, but spreads the intersection tests over 
+   multiple threads if the library is built with OpenMP. The response callbacks are 
+   still called on the calling thread, in the same order as by DT_Test, and no more
+   callbacks are called after one returns DT_DONE.
+*/
+
+	DECLSPEC DT_Count DT_ParallelTest(DT_SceneHandle scene, DT_RespTableHandle respTable);
+
 /* Set the maximum relative error in the closest points and penetration depth
    computation. The default for `max_error' is 1.0e-3. Larger errors result
    in better performance. Non-positive error tolerances are ignored.
@@ -268,6 +368,27 @@ extern "C" {
 											 const DT_Vector3 source, const DT_Vector3 target,
 											 DT_Scalar max_param, DT_Scalar *param, DT_Vector3 normal);
 
+/* These only tell whether the ray hits anything before 'max_param', for instance for 
+   visibility queries. They return as soon as a hit is found, which need not be the 
+   nearest one, so they are cheaper than DT_RayCast and DT_ObjectRayCast. DT_RayTest 
+   returns the client pointer to the object that was hit, or null.
+*/
+
+	DECLSPEC void *DT_RayTest(DT_SceneHandle scene, void *ignore_client,
+							  const DT_Vector3 source, const DT_Vector3 target,
+							  DT_Scalar max_param);
+
+	DECLSPEC DT_Bool DT_ObjectRayTest(DT_ObjectHandle object,
+									  const DT_Vector3 source, const DT_Vector3 target,
+									  DT_Scalar max_param);
+
+/* DT_RayCast, DT_ObjectRayCast, DT_RayTest, DT_ObjectRayTest, DT_GetClosestPair and 
+   DT_GetPenDepth may be called from several threads at once, as long as the scenes and 
+   objects involved, and the accuracy settings, are not changed meanwhile. For the calls 
+   on a scene, its bounding boxes must also be up to date, that is, no object may have 
+   been moved since the last call on the scene that brings them up to date.
+*/
+
 
 #ifdef __cplusplus
 }
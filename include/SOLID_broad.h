@@ -47,6 +47,16 @@ extern "C" {
 												  BP_Callback beginOverlap,
 												  BP_Callback endOverlap);
 	
+/* Creates a scene that uses the given broad phase algorithm. The meaning of 'param'
+   depends on the type, see DT_BroadphaseType.
+*/
+
+	DECLSPEC BP_SceneHandle BP_CreateSceneOfType(DT_BroadphaseType type,
+												 DT_Scalar param,
+												 void *client_data,
+												 BP_Callback beginOverlap,
+												 BP_Callback endOverlap);
+	
 	DECLSPEC void           BP_DestroyScene(BP_SceneHandle scene);
 	
 	DECLSPEC BP_ProxyHandle BP_CreateProxy(BP_SceneHandle scene, 
@@ -57,10 +67,50 @@ extern "C" {
 	DECLSPEC void           BP_DestroyProxy(BP_SceneHandle scene, 
 												  BP_ProxyHandle proxy);
 	
+/* Creating or destroying many proxies at once is a lot cheaper than doing so 
+   one by one. The arrays hold 'count' elements each. All new proxies get the 
+   given mode.
+*/
+
+	DECLSPEC void           BP_CreateProxies(BP_SceneHandle scene,
+											 DT_Size count,
+											 void *const *objects,
+											 const DT_Vector3 *min, 
+											 const DT_Vector3 *max,
+											 DT_ProxyMode mode,
+											 BP_ProxyHandle *proxies);
+
+	DECLSPEC void           BP_DestroyProxies(BP_SceneHandle scene,
+											  DT_Size count,
+											  const BP_ProxyHandle *proxies);
+	
 	DECLSPEC void BP_SetBBox(BP_ProxyHandle proxy, 
 									const DT_Vector3 min, 
 									const DT_Vector3 max);
 	
+/* Calls to BP_SetBBox between BP_BeginUpdate and BP_CommitUpdate only record the 
+   new bounds. BP_CommitUpdate applies all recorded bounds at once, and calls the 
+   overlap callbacks for the pairs whose overlap status changed. This is a lot 
+   cheaper than moving the proxies one by one when many proxies move each frame.
+   Ray casts ignore bounds that are not yet committed.
+*/
+	
+	DECLSPEC void BP_BeginUpdate(BP_SceneHandle scene);
+	DECLSPEC void BP_CommitUpdate(BP_SceneHandle scene);
+
+/* Proxies are dynamic when created. Static and sleeping proxies are kept apart
+   from the dynamic ones and are only tested against dynamic proxies, so they
+   cost nothing while they lie still. Setting the bounds of a sleeping proxy 
+   makes it dynamic again. Only the sweep and prune scene distinguishes modes; 
+   the other broad phases ignore them.
+*/
+
+	DECLSPEC void BP_SetProxyMode(BP_ProxyHandle proxy, DT_ProxyMode mode);
+
+/* Rays can be cast from several threads at once, as long as the scene is not 
+   changed meanwhile.
+*/
+
 	DECLSPEC void *BP_RayCast(BP_SceneHandle scene, 
 									 BP_RayCastCallback objectRayCast, 
 									 void *client_data,
@@ -54,4 +54,50 @@ typedef int            DT_Bool;
 typedef DT_Scalar DT_Vector3[3]; 
 typedef DT_Scalar DT_Quaternion[4]; 
 
+typedef enum DT_BroadphaseType {
+	DT_SWEEP_AND_PRUNE,        /* Sorted endpoint lists along the three axes (default) */
+	DT_DYNAMIC_TREE,           /* Balanced tree of boxes. The parameter is the margin
+	                              by which the boxes in the tree are enlarged. 
+	                           */
+	DT_HASHED_GRID,            /* Hashed grid of cubic cells. The parameter is the 
+	                              cell size, which should be about the size of a 
+	                              typical object. 
+	                           */
+	DT_MULTI_SWEEP_AND_PRUNE   /* Sweep and prune per cubic region of space. The 
+	                              parameter is the region size, which should be 
+	                              large compared to the objects. 
+	                           */
+} DT_BroadphaseType;
+
+typedef enum DT_ProxyMode {
+	DT_DYNAMIC,                /* Moves often (default) */
+	DT_STATIC,                 /* Rarely or never moves. Pairs of two static 
+	                              proxies are not reported. 
+	                           */
+	DT_SLEEPING                /* Does not move until it is woken, either by 
+	                              setting it dynamic or by moving it. Pairs with 
+	                              static or sleeping proxies are not reported. 
+	                           */
+} DT_ProxyMode;
+
+typedef enum DT_BuildQuality {
+	DT_FAST_BUILD,             /* Splits at the center of the longest axis (default) */
+	DT_SAH_BUILD               /* Splits by the surface area heuristic. Slower to 
+	                              build, but gives tighter trees for meshes with 
+	                              triangles of very different sizes. 
+	                           */
+} DT_BuildQuality;
+
+typedef enum DT_TreeFormat {
+	DT_BINARY_TREE,            /* Nodes with two children (default) */
+	DT_QUAD_TREE               /* The binary tree is collapsed into nodes with 
+	                              four children, whose boxes are tested at 
+	                              once. Faster ray casts and intersection tests
+	                              on large meshes, for about three times the 
+	                              memory. Closest-point queries, and queries on
+	                              pairs of meshes of which only one has the 
+	                              format, still use the binary tree. 
+	                           */
+} DT_TreeFormat;
+
 #endif
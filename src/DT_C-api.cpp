@@ -47,6 +47,8 @@
 
 #include "DT_Accuracy.h"
 
+// The vertices may be padded, so the vertex bases made for them are given 
+// the size of a vertex as stride.
 typedef MT::Tuple3<DT_Scalar> T_Vertex;
 typedef std::vector<T_Vertex> T_VertexBuf;
 typedef std::vector<DT_Index> T_IndexBuf;
@@ -57,6 +59,8 @@ static T_IndexBuf indexBuf;
 static T_PolyList polyList; 
 
 static DT_Complex       *currentComplex    = 0;
+static DT_BuildQuality   buildQuality      = DT_FAST_BUILD;
+static DT_TreeFormat     treeFormat        = DT_BINARY_TREE;
 static DT_Polyhedron    *currentPolyhedron = 0;
 static DT_VertexBase    *currentBase = 0;
 
@@ -89,6 +93,28 @@ void DT_ChangeVertexBase(DT_VertexBaseHandle vertexBase, const void *pointer)
 	}
 }
 
+void DT_ChangeVertices(DT_VertexBaseHandle vertexBase, DT_Count count, const DT_Index *indices)
+{
+    assert(vertexBase);
+	const DT_ComplexList& complexList = reinterpret_cast<DT_VertexBase *>(vertexBase)->getComplexList();
+	DT_ComplexList::const_iterator it;
+	for (it = complexList.begin(); it != complexList.end(); ++it)
+	{
+		(*it)->refitVertices(count, indices);
+	}
+}
+
+void DT_ChangeVertexRange(DT_VertexBaseHandle vertexBase, DT_Index first, DT_Count count)
+{
+    assert(vertexBase);
+	const DT_ComplexList& complexList = reinterpret_cast<DT_VertexBase *>(vertexBase)->getComplexList();
+	DT_ComplexList::const_iterator it;
+	for (it = complexList.begin(); it != complexList.end(); ++it)
+	{
+		(*it)->refitVertexRange(first, count);
+	}
+}
+
 
 DT_ShapeHandle DT_NewBox(DT_Scalar x, DT_Scalar y, DT_Scalar z) 
 {
@@ -152,7 +178,7 @@ DT_ShapeHandle DT_NewComplexShape(const DT_VertexBaseHandle vertexBase)
 {
     if (!currentComplex) 
 	{
-		currentBase = vertexBase ? reinterpret_cast<DT_VertexBase *>(vertexBase) : new DT_VertexBase;
+		currentBase = vertexBase ? reinterpret_cast<DT_VertexBase *>(vertexBase) : new DT_VertexBase(0, sizeof(T_Vertex));
 		currentComplex = new DT_Complex(currentBase);
 	}
     return (DT_ShapeHandle)currentComplex;
@@ -172,18 +198,28 @@ void DT_EndComplexShape()
 		
 		vertexBuf.clear();
         
-        currentComplex->finish(polyList.size(), &polyList[0]);
+        currentComplex->finish(polyList.size(), &polyList[0], buildQuality, treeFormat);
         polyList.clear();
         currentComplex = 0;
         currentBase = 0; 
     }
 }
 
+void DT_SetBuildQuality(DT_BuildQuality quality)
+{
+	buildQuality = quality;
+}
+
+void DT_SetTreeFormat(DT_TreeFormat format)
+{
+	treeFormat = format;
+}
+
 DT_ShapeHandle DT_NewPolytope(const DT_VertexBaseHandle vertexBase) 
 {
     if (!currentPolyhedron) 
 	{
-		currentBase = vertexBase ? reinterpret_cast<DT_VertexBase *>(vertexBase) : new DT_VertexBase;
+		currentBase = vertexBase ? reinterpret_cast<DT_VertexBase *>(vertexBase) : new DT_VertexBase(0, sizeof(T_Vertex));
         currentPolyhedron = new DT_Polyhedron;
 		
     }
@@ -285,6 +321,12 @@ void DT_DeleteShape(DT_ShapeHandle shape)
     delete (DT_Shape *)shape; 
 }
 
+DT_Size DT_GetTreeSize(DT_ShapeHandle shape)
+{
+	const DT_Shape *s = (const DT_Shape *)shape;
+	return s->getType() == COMPLEX ? ((const DT_Complex *)s)->treeSize() : 0;
+}
+
 
 
 
@@ -296,6 +338,11 @@ DT_SceneHandle DT_CreateScene()
     return (DT_SceneHandle)new DT_Scene; 
 }
 
+DT_SceneHandle DT_CreateSceneOfType(DT_BroadphaseType type, DT_Scalar param) 
+{
+    return (DT_SceneHandle)new DT_Scene(type, param); 
+}
+
 void DT_DestroyScene(DT_SceneHandle scene) 
 {
     delete reinterpret_cast<DT_Scene *>(scene);
@@ -315,6 +362,50 @@ void DT_RemoveObject(DT_SceneHandle scene, DT_ObjectHandle object)
     reinterpret_cast<DT_Scene *>(scene)->removeObject(*reinterpret_cast<DT_Object *>(object));
 }
 
+void DT_AddObjects(DT_SceneHandle scene, DT_Size count, const DT_ObjectHandle *objects) 
+{
+    assert(scene);
+    assert(objects || count == 0);
+    reinterpret_cast<DT_Scene *>(scene)->addObjects(count, reinterpret_cast<DT_Object *const *>(objects));
+}
+
+void DT_RemoveObjects(DT_SceneHandle scene, DT_Size count, const DT_ObjectHandle *objects) 
+{
+    assert(scene);
+    assert(objects || count == 0);
+    reinterpret_cast<DT_Scene *>(scene)->removeObjects(count, reinterpret_cast<DT_Object *const *>(objects));
+}
+
+void DT_BeginUpdate(DT_SceneHandle scene) 
+{
+    assert(scene);
+    reinterpret_cast<DT_Scene *>(scene)->beginUpdate();
+}
+
+void DT_CommitUpdate(DT_SceneHandle scene) 
+{
+    assert(scene);
+    reinterpret_cast<DT_Scene *>(scene)->commitUpdate();
+}
+
+void DT_UpdateBBoxes(DT_SceneHandle scene) 
+{
+    assert(scene);
+    reinterpret_cast<DT_Scene *>(scene)->updateBBoxes();
+}
+
+void DT_SetWarmStart(DT_SceneHandle scene, DT_Bool warm_start) 
+{
+    assert(scene);
+    reinterpret_cast<DT_Scene *>(scene)->setWarmStart(warm_start != DT_FALSE);
+}
+
+void DT_SetSeparationCulling(DT_SceneHandle scene, DT_Bool cull) 
+{
+    assert(scene);
+    reinterpret_cast<DT_Scene *>(scene)->setCulling(cull != DT_FALSE);
+}
+
 
 // Object instantiation
 
@@ -357,6 +448,20 @@ void DT_SetOrientation(DT_ObjectHandle object, const DT_Quaternion orientation)
 }
 
 
+void DT_SetTransform(DT_ObjectHandle object, const DT_Vector3 position, 
+					 const DT_Quaternion orientation) 
+{
+	assert(object);
+    reinterpret_cast<DT_Object *>(object)->setTransform(MT_Point3(position), 
+														MT_Quaternion(orientation));   
+}
+
+void DT_SetObjectMode(DT_ObjectHandle object, DT_ProxyMode mode) 
+{
+	assert(object);
+    reinterpret_cast<DT_Object *>(object)->setMode(mode);
+}
+
 void DT_SetMatrixf(DT_ObjectHandle object, const float *m) 
 {
 	assert(object);
@@ -383,6 +488,7 @@ void DT_GetMatrixd(DT_ObjectHandle object, double *m)
 void DT_GetBBox(DT_ObjectHandle object, DT_Vector3 min, DT_Vector3 max) 
 {
 	assert(object);
+	reinterpret_cast<DT_Object *>(object)->updateBBox();
 	const MT_BBox& bbox = reinterpret_cast<DT_Object *>(object)->getBBox();
 	bbox.getMin().getValue(min);
 	bbox.getMax().getValue(max);
@@ -595,6 +701,11 @@ DT_Count DT_Test(DT_SceneHandle scene, DT_RespTableHandle respTable)
     return reinterpret_cast<DT_Scene *>(scene)->handleCollisions(reinterpret_cast<DT_RespTable *>(respTable));
 }
 
+DT_Count DT_ParallelTest(DT_SceneHandle scene, DT_RespTableHandle respTable) 
+{ 
+    return reinterpret_cast<DT_Scene *>(scene)->handleCollisionsParallel(reinterpret_cast<DT_RespTable *>(respTable));
+}
+
 void *DT_RayCast(DT_SceneHandle scene, void *ignore_client,
 				 const DT_Vector3 source, const DT_Vector3 target,
 				 DT_Scalar max_param, DT_Scalar *param, DT_Vector3 normal) 
@@ -631,3 +742,20 @@ DT_Bool DT_ObjectRayCast(DT_ObjectHandle object,
 	return result;
 }
 
+void *DT_RayTest(DT_SceneHandle scene, void *ignore_client,
+				 const DT_Vector3 source, const DT_Vector3 target,
+				 DT_Scalar max_param) 
+{
+	assert(scene);
+	return reinterpret_cast<DT_Scene *>(scene)->rayTest(ignore_client, source, target, max_param);
+}
+
+DT_Bool DT_ObjectRayTest(DT_ObjectHandle object,
+						 const DT_Vector3 source, const DT_Vector3 target,
+						 DT_Scalar max_param) 
+{
+	assert(object);
+	return reinterpret_cast<DT_Object *>(object)->ray_test(MT_Point3(source), MT_Point3(target), 
+														   MT_Scalar(max_param));
+}
+
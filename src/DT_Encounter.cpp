@@ -26,82 +26,229 @@
 #include "DT_Object.h"
 #include "GEN_MinMax.h"
 
-DT_Bool DT_Encounter::exactTest(const DT_RespTable *respTable, int& count) const 
+DT_Bool DT_Encounter::exactTest(const DT_RespTable *respTable, bool warm_start, bool cull, int& count) const 
 {
 	const DT_ResponseList& responseList = respTable->find(m_obj_ptr1, m_obj_ptr2);
 
-   switch (responseList.getType()) 
+	MT_Point3 p1, p2;
+	if (test(responseList.getType(), m_sep_axis, warm_start ? &m_simplex : 0, 
+			 cull ? &m_separation : 0, p1, p2))
+	{
+		++count;
+		return respond(respTable, responseList, p1, p2);
+	}
+	return DT_CONTINUE;
+}
+
+bool DT_Encounter::test(DT_ResponseType type, MT_Vector3& v, DT_SimplexCache *simplex, 
+						DT_SeparationBound *separation, MT_Point3& p1, MT_Point3& p2) const 
+{
+   if (type == DT_NO_RESPONSE)
    {
-   case DT_SIMPLE_RESPONSE: 
-	   if (intersect(*m_obj_ptr1, *m_obj_ptr2, m_sep_axis)) 
+	   return false;
+   }
+
+   // A pair that is skipped drops its simplex, so the next test on it starts
+   // cold, whatever the objects did meanwhile.
+   if (separation && apart(*m_obj_ptr1, *m_obj_ptr2, *separation))
+   {
+	   if (simplex)
 	   {
-		   ++count;
-		   return (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2)) ?
-			   responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), 0) :   
-			   responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), 0);    
- 
+		   simplex->clear();
 	   }
+	   return false;
+   }
+
+   bool result = false;
+   switch (type) 
+   {
+   case DT_SIMPLE_RESPONSE: 
+	   result = simplex ? 
+		   intersect(*m_obj_ptr1, *m_obj_ptr2, v, *simplex) :
+		   intersect(*m_obj_ptr1, *m_obj_ptr2, v);
 	   break;
-   case DT_WITNESSED_RESPONSE: {
-	   MT_Point3  p1, p2;
-	   
-	   if (common_point(*m_obj_ptr1, *m_obj_ptr2, m_sep_axis, p1, p2)) 
-	   { 
-		   ++count;
-           if (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2))
-           {
-			   DT_CollData coll_data;
-			   
-			   p1.getValue(coll_data.point1);
-			   p2.getValue(coll_data.point2);
-			   
-               return responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), &coll_data);
-           }
-           else
-           {
-			   DT_CollData coll_data;
-			   
-			   p1.getValue(coll_data.point2);
-			   p2.getValue(coll_data.point1);
-			   
-               return responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), &coll_data);
-           }
-	   }
+   case DT_WITNESSED_RESPONSE: 
+	   result = simplex ?
+		   common_point(*m_obj_ptr1, *m_obj_ptr2, v, p1, p2, *simplex) :
+		   common_point(*m_obj_ptr1, *m_obj_ptr2, v, p1, p2);
+	   break;
+   case DT_DEPTH_RESPONSE: 
+	   result = simplex ?
+		   penetration_depth(*m_obj_ptr1, *m_obj_ptr2, v, p1, p2, *simplex) :
+		   penetration_depth(*m_obj_ptr1, *m_obj_ptr2, v, p1, p2);
 	   break;
+   default:
+	   assert(false);
    }
-   case DT_DEPTH_RESPONSE: {
-	   MT_Point3  p1, p2;
-	   
-	   if (penetration_depth(*m_obj_ptr1, *m_obj_ptr2, m_sep_axis, p1, p2)) 
-	   { 
-		   ++count;
-           if (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2))
-           {
-			   DT_CollData coll_data;
-			   
-			   p1.getValue(coll_data.point1);
-			   p2.getValue(coll_data.point2);	
-               (p2 - p1).getValue(coll_data.normal);
-			   
-               return responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), &coll_data);
-           }
-           else
-           {
-			   DT_CollData coll_data;
-			   
-			   p1.getValue(coll_data.point2);
-			   p2.getValue(coll_data.point1); 
-               (p1 - p2).getValue(coll_data.normal);
-			   
-               return responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), &coll_data);
-           }
+
+   if (separation)
+   {
+	   if (result)
+	   {
+		   separation->clear();
+	   }
+	   else
+	   {
+		   bound_separation(*m_obj_ptr1, *m_obj_ptr2, v, *separation);
 	   }
-	   break;
    }
-   case DT_NO_RESPONSE:
-	   break;
+   return result;
+}
+
+DT_Bool DT_Encounter::respond(const DT_RespTable *respTable, const DT_ResponseList& responseList,
+							  const MT_Point3& p1, const MT_Point3& p2) const 
+{
+   switch (responseList.getType()) 
+   {
+   case DT_SIMPLE_RESPONSE: 
+	   return (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2)) ?
+		   responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), 0) :   
+		   responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), 0);    
+   case DT_WITNESSED_RESPONSE: 
+	   if (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2))
+	   {
+		   DT_CollData coll_data;
+		   
+		   p1.getValue(coll_data.point1);
+		   p2.getValue(coll_data.point2);
+		   
+		   return responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), &coll_data);
+	   }
+	   else
+	   {
+		   DT_CollData coll_data;
+		   
+		   p1.getValue(coll_data.point2);
+		   p2.getValue(coll_data.point1);
+		   
+		   return responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), &coll_data);
+	   }
+   case DT_DEPTH_RESPONSE: 
+	   if (respTable->getResponseClass(m_obj_ptr1) < respTable->getResponseClass(m_obj_ptr2))
+	   {
+		   DT_CollData coll_data;
+		   
+		   p1.getValue(coll_data.point1);
+		   p2.getValue(coll_data.point2);	
+		   (p2 - p1).getValue(coll_data.normal);
+		   
+		   return responseList(m_obj_ptr1->getClientObject(), m_obj_ptr2->getClientObject(), &coll_data);
+	   }
+	   else
+	   {
+		   DT_CollData coll_data;
+		   
+		   p1.getValue(coll_data.point2);
+		   p2.getValue(coll_data.point1); 
+		   (p1 - p2).getValue(coll_data.normal);
+		   
+		   return responseList(m_obj_ptr2->getClientObject(), m_obj_ptr1->getClientObject(), &coll_data);
+	   }
    default:
 	   assert(false);
    }
    return DT_CONTINUE;
 }
+
+DT_Index DT_EncounterTable::hash(const DT_Encounter& e) const
+{
+	// Objects are at least 16-byte aligned, so the low bits carry no information
+	DT_Index h = DT_Index(reinterpret_cast<size_t>(e.first()) >> 4) * 2654435761u + 
+		         DT_Index(reinterpret_cast<size_t>(e.second()) >> 4);
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	return h & m_mask;
+}
+
+DT_Index DT_EncounterTable::findSlot(const DT_Encounter& e) const
+{
+	DT_Index i = hash(e);
+	while (m_slots[i] != 0 && !(m_encounters[m_slots[i] - 1] == e))
+	{
+		i = (i + 1) & m_mask;
+	}
+	return i;
+}
+
+void DT_EncounterTable::grow()
+{
+	DT_Index num_slots = m_slots.empty() ? DT_Index(MIN_SLOTS) : DT_Index(m_slots.size() * 2);
+	m_slots.assign(num_slots, 0);
+	m_mask = num_slots - 1;
+
+	DT_Index k;
+	for (k = 0; k != m_encounters.size(); ++k)
+	{
+		DT_Index i = hash(m_encounters[k]);
+		while (m_slots[i] != 0)
+		{
+			i = (i + 1) & m_mask;
+		}
+		m_slots[i] = k + 1;
+	}
+}
+
+void DT_EncounterTable::insert(const DT_Encounter& e)
+{
+	// Keep the load factor at most one half
+	if ((m_encounters.size() + 1) * 2 > m_slots.size())
+	{
+		grow();
+	}
+
+	DT_Index i = findSlot(e);
+	if (m_slots[i] == 0)
+	{
+		m_encounters.push_back(e);
+		m_slots[i] = DT_Index(m_encounters.size());
+	}
+}
+
+DT_EncounterTable::iterator DT_EncounterTable::find(const DT_Encounter& e)
+{
+	if (m_encounters.empty())
+	{
+		return end();
+	}
+
+	DT_Index i = findSlot(e);
+	return m_slots[i] != 0 ? begin() + (m_slots[i] - 1) : end();
+}
+
+void DT_EncounterTable::erase(iterator it)
+{
+	DT_Index index = DT_Index(it - begin());
+	DT_Index i = findSlot(*it);
+	assert(m_slots[i] == index + 1);
+
+	// Close the gap by moving back the entries further down the probe 
+	// sequence that may no longer be reachable from their home slot.
+	DT_Index j = i;
+	for (;;)
+	{
+		j = (j + 1) & m_mask;
+		if (m_slots[j] == 0)
+		{
+			break;
+		}
+
+		DT_Index k = hash(m_encounters[m_slots[j] - 1]);
+		if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+		{
+			continue;
+		}
+
+		m_slots[i] = m_slots[j];
+		i = j;
+	}
+	m_slots[i] = 0;
+
+	DT_Index last = DT_Index(m_encounters.size() - 1);
+	if (index != last)
+	{
+		m_slots[findSlot(m_encounters[last])] = index + 1;
+		m_encounters[index] = m_encounters[last];
+	}
+	m_encounters.pop_back();
+}
@@ -24,13 +24,16 @@
 #ifndef DT_ENCOUNTER_H
 #define DT_ENCOUNTER_H
 
-#include <set>
+#include <vector>
 
 #include "MT_Vector3.h"
 #include "DT_Object.h"
 #include "DT_Shape.h"
+#include "DT_SimplexCache.h"
+#include "DT_SeparationBound.h"
 
 class DT_RespTable;
+class DT_ResponseList;
 
 class DT_Encounter {
 public:
@@ -56,13 +59,35 @@ public:
     DT_Object         *first()          const { return m_obj_ptr1; }
     DT_Object         *second()         const { return m_obj_ptr2; }
     const MT_Vector3&  separatingAxis() const { return m_sep_axis; }
+	void               setSeparatingAxis(const MT_Vector3& v) const { m_sep_axis = v; }
 
- 	DT_Bool exactTest(const DT_RespTable *respTable, int& count) const;
+	const DT_SimplexCache& simplex() const { return m_simplex; }
+	void                   setSimplex(const DT_SimplexCache& simplex) const { m_simplex = simplex; }
+
+	const DT_SeparationBound& separation() const { return m_separation; }
+	void                      setSeparation(const DT_SeparationBound& separation) const { m_separation = separation; }
+
+	// With 'warm_start' set, the test starts from the simplex of the 
+	// previous test on the pair. With 'cull' set, the test is skipped while 
+	// the objects are known to be still apart.
+ 	DT_Bool exactTest(const DT_RespTable *respTable, bool warm_start, bool cull, int& count) const;
+
+	// The exact test and the response can also be run separately. The test 
+	// starts from the separating axis 'v', the simplex in 'simplex' and the 
+	// bound in 'separation', if any, and leaves the new ones there, without 
+	// changing the encounter, so that encounters can be tested on different 
+	// threads.
+	bool    test(DT_ResponseType type, MT_Vector3& v, DT_SimplexCache *simplex, 
+				 DT_SeparationBound *separation, MT_Point3& p1, MT_Point3& p2) const;
+	DT_Bool respond(const DT_RespTable *respTable, const DT_ResponseList& responseList,
+					const MT_Point3& p1, const MT_Point3& p2) const;
 
 private:
     DT_Object          *m_obj_ptr1;
     DT_Object          *m_obj_ptr2;
-    mutable MT_Vector3  m_sep_axis;
+    mutable MT_Vector3       m_sep_axis;
+	mutable DT_SimplexCache  m_simplex;
+	mutable DT_SeparationBound m_separation;
 };
 
 inline bool operator<(const DT_Encounter& a, const DT_Encounter& b) 
@@ -71,6 +96,11 @@ inline bool operator<(const DT_Encounter& a, const DT_Encounter& b)
         (a.first() == b.first() && a.second() < b.second()); 
 }
 
+inline bool operator==(const DT_Encounter& a, const DT_Encounter& b) 
+{ 
+    return a.first() == b.first() && a.second() == b.second(); 
+}
+
 
 
 inline std::ostream& operator<<(std::ostream& os, const DT_Encounter& a) {
@@ -79,6 +109,42 @@ inline std::ostream& operator<<(std::ostream& os, const DT_Encounter& a) {
 
 
 
-typedef std::set<DT_Encounter> DT_EncounterTable;
+// The encounters are stored contiguously, so that they can be visited in a 
+// linear sweep. An open-addressing hash table with linear probing maps each 
+// pair of objects to its encounter. Erasing an encounter moves the last one 
+// into its place, so iterators are invalidated by any change to the table.
+
+class DT_EncounterTable {
+	enum { MIN_SLOTS = 64 };
+public:
+	typedef std::vector<DT_Encounter>::iterator       iterator;
+	typedef std::vector<DT_Encounter>::const_iterator const_iterator;
+
+	DT_EncounterTable() : m_mask(0) {}
+
+	iterator       begin()       { return m_encounters.begin(); }
+	iterator       end()         { return m_encounters.end(); }
+	const_iterator begin() const { return m_encounters.begin(); }
+	const_iterator end()   const { return m_encounters.end(); }
+
+	const DT_Encounter& operator[](DT_Index i) const { return m_encounters[i]; }
+
+	DT_Size size()  const { return DT_Size(m_encounters.size()); }
+	bool    empty() const { return m_encounters.empty(); }
+
+	void     insert(const DT_Encounter& e);
+	iterator find(const DT_Encounter& e);
+	void     erase(iterator it);
+
+private:
+	DT_Index hash(const DT_Encounter& e) const;
+	DT_Index findSlot(const DT_Encounter& e) const;
+	void     grow();
+
+	// A slot holds the index of its encounter plus one, or zero if it is empty
+	std::vector<DT_Encounter> m_encounters;
+	std::vector<DT_Index>     m_slots;
+	DT_Index                  m_mask;
+};
 
 #endif
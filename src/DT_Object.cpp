@@ -22,17 +22,31 @@
  */
 
 #include "DT_Object.h"
+#include "DT_Scene.h"
 #include "DT_AlgoTable.h"
 #include "DT_Convex.h" 
 #include "DT_Complex.h" 
+#include "DT_Box.h" 
 #include "DT_LineSegment.h" 
 #include "DT_Transform.h"
-#include "DT_Minkowski.h"
 #include "DT_Sphere.h"
+#include "DT_Placed.h"
+#include "DT_ConvexQueries.h"
+#include "DT_SimplexCache.h"
+#include "DT_SeparationBound.h"
+#include "DT_Witness.h"
 
 void DT_Object::setBBox() 
 {
 	m_bbox = m_shape.bbox(m_xform, m_margin); 
+	m_dirty = false;
+
+	// The broad phase wakes sleeping proxies that are moved
+	if (m_mode == DT_SLEEPING)
+	{
+		m_mode = DT_DYNAMIC;
+	}
+
 	DT_Vector3 min, max;
 	m_bbox.getMin().getValue(min);
 	m_bbox.getMax().getValue(max);
@@ -40,7 +54,54 @@ void DT_Object::setBBox()
 	T_ProxyList::const_iterator it;
 	for (it = m_proxies.begin(); it != m_proxies.end(); ++it) 
 	{
-		BP_SetBBox(*it, min, max);
+		BP_SetBBox((*it).second, min, max);
+	}
+}
+
+// Points cached on the margin stay valid under a change of basis that keeps
+// the metric, such as a rotation. Other changes count as a change of 
+// scaling. The tolerance absorbs the rounding of matrices meant as rotations.
+
+void DT_Object::stampMetric(const MT_Matrix3x3& metric)
+{
+	MT_Matrix3x3 new_metric = getMetric();
+	MT_Scalar tolerance = MT_Scalar(1e-5) * (metric[0][0] + metric[1][1] + metric[2][2]);
+	int i, j;
+	for (i = 0; i != 3; ++i)
+	{
+		for (j = 0; j != 3; ++j)
+		{
+			if (MT_abs(new_metric[i][j] - metric[i][j]) > tolerance)
+			{
+				++m_stamp;
+				return;
+			}
+		}
+	}
+}
+
+void DT_Object::markDirty()
+{
+	m_dirty = true;
+
+	T_ProxyList::const_iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it) 
+	{
+		(*it).first->addDirty(this);
+	}
+}
+
+void DT_Object::setMode(DT_ProxyMode mode)
+{
+	// Bring the proxies up to date first, so that a pending move does not 
+	// wake a proxy that was just put to sleep.
+	updateBBox();
+	m_mode = mode;
+
+	T_ProxyList::const_iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it) 
+	{
+		BP_SetProxyMode((*it).second, mode);
 	}
 }
 
@@ -67,6 +128,12 @@ bool DT_Object::ray_cast(const MT_Point3& source, const MT_Point3& target,
 	return result;
 }
 
+bool DT_Object::ray_test(const MT_Point3& source, const MT_Point3& target, MT_Scalar param) const 
+{	
+	MT_Transform inv_xform = m_xform.inverse();
+	return m_shape.ray_test(inv_xform(source), inv_xform(target), param);
+}
+
 typedef bool (*Intersect)(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 						  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
 						  MT_Vector3&);
@@ -88,24 +155,422 @@ typedef AlgoTable<Common_point> Common_pointTable;
 typedef AlgoTable<Penetration_depth> Penetration_depthTable;
 typedef AlgoTable<Closest_points> Closest_pointsTable;
 
+// Every pair of a complex and a convex type and every pair of convex types
+// has an entry for the general case.
+static const DT_ShapeType convexTypes[] = { CONVEX, SPHERE, BOX, SEGMENT, TRIANGLE };
+static const int NUM_CONVEX_TYPES = sizeof(convexTypes) / sizeof(DT_ShapeType);
+
+template <typename Function>
+void addGeneralEntries(AlgoTable<Function>& table, Function complexComplex, 
+					   Function complexConvex, Function convexConvex)
+{
+	table.addEntry(COMPLEX, COMPLEX, complexComplex);
+	int i, j;
+	for (i = 0; i != NUM_CONVEX_TYPES; ++i)
+	{
+		table.addEntry(COMPLEX, convexTypes[i], complexConvex);
+		for (j = i; j != NUM_CONVEX_TYPES; ++j)
+		{
+			table.addEntry(convexTypes[i], convexTypes[j], convexConvex);
+		}
+	}
+}
+
+
+// Placements are taken to be free of shear, and of scaling that is not 
+// uniform, up to rounding.
+static const MT_Scalar shear_tolerance = MT_Scalar(1.0e-5);
+
+// A sphere remains a sphere under a placement that scales uniformly
+static bool sphere(const DT_Shape& shape, const MT_Transform& xform, 
+				   MT_Point3& center, MT_Scalar& radius)
+{
+	const MT_Matrix3x3& basis = xform.getBasis();
+	MT_Scalar scale2 = basis[0].length2();
+	MT_Scalar tol = scale2 * shear_tolerance;
+	if (MT_abs(basis[1].length2() - scale2) > tol || 
+		MT_abs(basis[2].length2() - scale2) > tol ||
+		MT_abs(basis[0].dot(basis[1])) > tol || 
+		MT_abs(basis[1].dot(basis[2])) > tol || 
+		MT_abs(basis[2].dot(basis[0])) > tol)
+	{
+		return false;
+	}
+
+	center = xform.getOrigin();
+	radius = ((const DT_Sphere&)shape).getRadius() * MT_sqrt(scale2);
+	return true;
+}
+
+// The vectors from the center of a box to the centers of three of its faces
+static void box(const DT_Shape& shape, const MT_Transform& xform, MT_Vector3 axis[3])
+{
+	MT_Matrix3x3 axes = xform.getBasis().scaled(((const DT_Box&)shape).getExtent()).transpose();
+	axis[0] = axes[0];
+	axis[1] = axes[1];
+	axis[2] = axes[2];
+}
+
+static bool orthogonal(const MT_Vector3 axis[3])
+{
+	MT_Scalar tol2 = shear_tolerance * shear_tolerance;
+	int i;
+	for (i = 0; i != 3; ++i)
+	{
+		const MT_Vector3& u = axis[i];
+		const MT_Vector3& w = axis[(i + 1) % 3];
+		MT_Scalar dot = u.dot(w);
+		if (u.length2() == MT_Scalar(0.0) || dot * dot > tol2 * u.length2() * w.length2())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// The closed-form tests on pairs of primitives. A witness function returns 
+// false if the placements do not allow the test, e.g. a sphere that is 
+// scaled unevenly. The objects are ordered by type, as for the other tests.
+
+typedef bool (*Witness)(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+						const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+						DT_Witness&);
+
+typedef AlgoTable<Witness> WitnessTable;
+
+bool witnessSphereSphere(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+						 const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+						 DT_Witness& w)
+{
+	MT_Point3 a_center, b_center;
+	if (!sphere(a, a2w, a_center, w.m_a_radius) || !sphere(b, b2w, b_center, w.m_b_radius))
+	{
+		return false;
+	}
+
+	segment_segment(a_center, a_center, b_center, b_center, w);
+	w.m_a_radius += a_margin;
+	w.m_b_radius += b_margin;
+	return true;
+}
+
+bool witnessSphereBox(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+					  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+					  DT_Witness& w)
+{
+	MT_Point3 center;
+	MT_Vector3 axis[3];
+	if (!sphere(a, a2w, center, w.m_a_radius))
+	{
+		return false;
+	}
+	
+	box(b, b2w, axis);
+	if (!orthogonal(axis))
+	{
+		return false;
+	}
+
+	// The margin of the box rounds it off, which amounts to a radius 
+	point_box(center, b2w.getOrigin(), axis, w);
+	w.m_a_radius += a_margin;
+	w.m_b_radius = b_margin;
+	return true;
+}
+
+bool witnessSphereSegment(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+						  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+						  DT_Witness& w)
+{
+	MT_Point3 center;
+	if (!sphere(a, a2w, center, w.m_a_radius))
+	{
+		return false;
+	}
+
+	const DT_LineSegment& segment = (const DT_LineSegment&)b;
+	segment_segment(center, center, b2w(segment.getSource()), b2w(segment.getTarget()), w);
+	w.m_a_radius += a_margin;
+	w.m_b_radius = b_margin;
+	return true;
+}
+
+// A line segment with a margin is a capsule, under any placement
+bool witnessSegmentSegment(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+						   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+						   DT_Witness& w)
+{
+	const DT_LineSegment& a_segment = (const DT_LineSegment&)a;
+	const DT_LineSegment& b_segment = (const DT_LineSegment&)b;
+	segment_segment(a2w(a_segment.getSource()), a2w(a_segment.getTarget()), 
+					b2w(b_segment.getSource()), b2w(b_segment.getTarget()), w);
+	w.m_a_radius = a_margin;
+	w.m_b_radius = b_margin;
+	return true;
+}
+
+// The margins of the boxes round them off. The closest points are only 
+// searched for if the margins may meet.
+bool witnessBoxBox(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+				   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+				   DT_Witness& w)
+{
+	MT_Vector3 a_axis[3], b_axis[3];
+	box(a, a2w, a_axis);
+	box(b, b2w, b_axis);
+	if (!orthogonal(a_axis) || !orthogonal(b_axis))
+	{
+		return false;
+	}
+
+	box_box(a2w.getOrigin(), a_axis, b2w.getOrigin(), b_axis, a_margin + b_margin, w);
+	w.m_a_radius = a_margin;
+	w.m_b_radius = b_margin;
+	return true;
+}
+
+// For 'closest_points' the closest points are always needed
+bool witnessBoxBoxClosest(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+						  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+						  DT_Witness& w)
+{
+	MT_Vector3 a_axis[3], b_axis[3];
+	box(a, a2w, a_axis);
+	box(b, b2w, b_axis);
+	if (!orthogonal(a_axis) || !orthogonal(b_axis))
+	{
+		return false;
+	}
+
+	box_box(a2w.getOrigin(), a_axis, b2w.getOrigin(), b_axis, MT_INFINITY, w);
+	w.m_a_radius = a_margin;
+	w.m_b_radius = b_margin;
+	return true;
+}
+
+const WitnessTable& witnessInitialize()
+{
+	static WitnessTable table;
+	table.addEntry(SPHERE, SPHERE, witnessSphereSphere);
+	table.addEntry(SPHERE, BOX, witnessSphereBox);
+	table.addEntry(SPHERE, SEGMENT, witnessSphereSegment);
+	table.addEntry(BOX, BOX, witnessBoxBox);
+	table.addEntry(SEGMENT, SEGMENT, witnessSegmentSegment);
+	return table;
+}
+
+const WitnessTable& closestInitialize()
+{
+	static WitnessTable table(witnessInitialize());
+	table.addEntry(BOX, BOX, witnessBoxBoxClosest);
+	return table;
+}
+
+inline bool witness(const WitnessTable& table, 
+					const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+					const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+					DT_Witness& w)
+{
+	assert(a.getType() <= b.getType());
+	Witness witness = table.lookup(a.getType(), b.getType());
+	return witness != 0 && witness(a, a2w, a_margin, b, b2w, b_margin, w);
+}
+
+// The triangles of a complex shape have closed-form tests against a sphere
+// about the origin. So the complex shape is placed relative to the center of 
+// the sphere.
+static MT_Transform centered(const MT_Transform& xform, const MT_Point3& center)
+{
+	MT_Transform result(xform);
+	result.setOrigin(xform.getOrigin() - center);
+	return result;
+}
+
+
+// The GJK-based tests as queries for 'place'. The convex shapes are placed 
+// in the world and enlarged by their margins, except for the hybrid 
+// penetration depth method, which takes the margins apart.
+
+class IntersectQuery {
+public:
+	typedef bool Result;
+
+	IntersectQuery(MT_Vector3& v, DT_GJK& gjk) : m_v(v), m_gjk(gjk) {}
+
+	template <typename A, typename B>
+	bool operator()(const A& a, const B& b) const { return intersect(a, b, m_v, m_gjk); }
+
+private:
+	MT_Vector3& m_v;
+	DT_GJK&     m_gjk;
+};
+
+class Common_pointQuery {
+public:
+	typedef bool Result;
+
+	Common_pointQuery(MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk) : 
+		m_v(v), m_pa(pa), m_pb(pb), m_gjk(gjk) 
+	{}
+
+	template <typename A, typename B>
+	bool operator()(const A& a, const B& b) const { return common_point(a, b, m_v, m_pa, m_pb, m_gjk); }
+
+private:
+	MT_Vector3& m_v;
+	MT_Point3&  m_pa;
+	MT_Point3&  m_pb;
+	DT_GJK&     m_gjk;
+};
+
+class Penetration_depthQuery {
+public:
+	typedef bool Result;
+
+	Penetration_depthQuery(MT_Scalar a_margin, MT_Scalar b_margin, 
+						   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk) : 
+		m_a_margin(a_margin), m_b_margin(b_margin), m_v(v), m_pa(pa), m_pb(pb), m_gjk(gjk) 
+	{}
+
+	template <typename A, typename B>
+	bool operator()(const A& a, const B& b) const 
+	{ 
+		return hybrid_penetration_depth(a, m_a_margin, b, m_b_margin, m_v, m_pa, m_pb, m_gjk); 
+	}
+
+private:
+	MT_Scalar   m_a_margin;
+	MT_Scalar   m_b_margin;
+	MT_Vector3& m_v;
+	MT_Point3&  m_pa;
+	MT_Point3&  m_pb;
+	DT_GJK&     m_gjk;
+};
+
+class Closest_pointsQuery {
+public:
+	typedef MT_Scalar Result;
+
+	Closest_pointsQuery(MT_Point3& pa, MT_Point3& pb) : m_pa(pa), m_pb(pb) {}
+
+	template <typename A, typename B>
+	MT_Scalar operator()(const A& a, const B& b) const { return closest_points(a, b, MT_INFINITY, m_pa, m_pb); }
+
+private:
+	MT_Point3& m_pa;
+	MT_Point3& m_pb;
+};
+
+// The same tests of a complex shape against a placed convex shape
+
+class ComplexQuery {
+public:
+	ComplexQuery(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin) :
+		m_a((const DT_Complex&)a), m_a2w(a2w), m_a_margin(a_margin)
+	{}
+
+protected:
+	const DT_Complex&   m_a;
+	const MT_Transform& m_a2w;
+	MT_Scalar           m_a_margin;
+};
+
+class ComplexIntersectQuery : public ComplexQuery {
+public:
+	typedef bool Result;
+
+	ComplexIntersectQuery(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin, MT_Vector3& v) : 
+		ComplexQuery(a, a2w, a_margin), m_v(v) 
+	{}
+
+	bool operator()(const DT_Convex& b) const { return intersect(m_a, m_a2w, m_a_margin, b, m_v); }
+
+private:
+	MT_Vector3& m_v;
+};
+
+class ComplexCommon_pointQuery : public ComplexQuery {
+public:
+	typedef bool Result;
+
+	ComplexCommon_pointQuery(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin, 
+							 MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) : 
+		ComplexQuery(a, a2w, a_margin), m_v(v), m_pa(pa), m_pb(pb) 
+	{}
+
+	bool operator()(const DT_Convex& b) const { return common_point(m_a, m_a2w, m_a_margin, b, m_v, m_pa, m_pb); }
+
+private:
+	MT_Vector3& m_v;
+	MT_Point3&  m_pa;
+	MT_Point3&  m_pb;
+};
+
+class ComplexPenetration_depthQuery : public ComplexQuery {
+public:
+	typedef bool Result;
+
+	ComplexPenetration_depthQuery(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin, 
+								  MT_Scalar b_margin, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) : 
+		ComplexQuery(a, a2w, a_margin), m_b_margin(b_margin), m_v(v), m_pa(pa), m_pb(pb) 
+	{}
+
+	bool operator()(const DT_Convex& b) const 
+	{ 
+		return penetration_depth(m_a, m_a2w, m_a_margin, b, m_b_margin, m_v, m_pa, m_pb); 
+	}
+
+private:
+	MT_Scalar   m_b_margin;
+	MT_Vector3& m_v;
+	MT_Point3&  m_pa;
+	MT_Point3&  m_pb;
+};
+
+class ComplexClosest_pointsQuery : public ComplexQuery {
+public:
+	typedef MT_Scalar Result;
+
+	ComplexClosest_pointsQuery(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin, 
+							   MT_Point3& pa, MT_Point3& pb) : 
+		ComplexQuery(a, a2w, a_margin), m_pa(pa), m_pb(pb) 
+	{}
+
+	MT_Scalar operator()(const DT_Convex& b) const { return closest_points(m_a, m_a2w, m_a_margin, b, m_pa, m_pb); }
+
+private:
+	MT_Point3& m_pa;
+	MT_Point3& m_pb;
+};
+
 
 bool intersectConvexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 						   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
                            MT_Vector3& v) 
 {
-	DT_Transform ta(a2w, (const DT_Convex&)a);
-	DT_Transform tb(b2w, (const DT_Convex&)b);
-    return intersect((a_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : static_cast<const DT_Convex&>(ta)), 
-			         (b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), v);
+	DT_GJK gjk;
+	return place(IntersectQuery(v, gjk), a, a2w, a_margin, b, b2w, b_margin);
 }
 
 bool intersectComplexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 						    const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
                             MT_Vector3& v) 
 {
-	DT_Transform tb(b2w, (const DT_Convex&)b);
-    return intersect((const DT_Complex&)a, a2w, a_margin, 
-		             (b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), v);
+	return place(ComplexIntersectQuery(a, a2w, a_margin, v), b, b2w, b_margin);
+}
+
+bool intersectComplexSphere(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+							const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+							MT_Vector3& v) 
+{
+	MT_Point3 center;
+	MT_Scalar radius;
+	if (!sphere(b, b2w, center, radius))
+	{
+		return intersectComplexConvex(a, a2w, a_margin, b, b2w, b_margin, v);
+	}
+	
+	return intersect((const DT_Complex&)a, centered(a2w, center), a_margin, DT_Sphere(radius + b_margin), v);
 }
 
 bool intersectComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -119,14 +584,20 @@ bool intersectComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_Scal
 IntersectTable& intersectInitialize() 
 {
     static IntersectTable table;
-    table.addEntry(COMPLEX, COMPLEX, intersectComplexComplex);
-    table.addEntry(COMPLEX, CONVEX, intersectComplexConvex);
-    table.addEntry(CONVEX, CONVEX, intersectConvexConvex);
+	addGeneralEntries(table, intersectComplexComplex, intersectComplexConvex, intersectConvexConvex);
+    table.addEntry(COMPLEX, SPHERE, intersectComplexSphere);
     return table;
 }
 
 bool intersect(const DT_Object& a, const DT_Object& b, MT_Vector3& v) 
 {
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return intersect(w, v);
+	}
+
     static const IntersectTable& intersectTable = intersectInitialize();
     Intersect intersect = intersectTable.lookup(a.getType(), b.getType());
     return intersect(a.m_shape, a.m_xform, a.m_margin, 
@@ -137,19 +608,35 @@ bool common_pointConvexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Sca
 							  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
 							  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-	DT_Transform ta(a2w, (const DT_Convex&)a);
-	DT_Transform tb(b2w, (const DT_Convex&)b);
-    return common_point((a_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : static_cast<const DT_Convex&>(ta)), 
-						(b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), v, pa, pb);
+	DT_GJK gjk;
+	return place(Common_pointQuery(v, pa, pb, gjk), a, a2w, a_margin, b, b2w, b_margin);
 }
 
 bool common_pointComplexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 							   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
 							   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
- 	DT_Transform tb(b2w, (const DT_Convex&)b);
-	return common_point((const DT_Complex&)a, a2w, a_margin,
-			            (b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), v, pa, pb);
+	return place(ComplexCommon_pointQuery(a, a2w, a_margin, v, pa, pb), b, b2w, b_margin);
+}
+
+bool common_pointComplexSphere(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+							   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+							   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
+{
+	MT_Point3 center;
+	MT_Scalar radius;
+	if (!sphere(b, b2w, center, radius))
+	{
+		return common_pointComplexConvex(a, a2w, a_margin, b, b2w, b_margin, v, pa, pb);
+	}
+	
+	if (common_point((const DT_Complex&)a, centered(a2w, center), a_margin, DT_Sphere(radius + b_margin), v, pa, pb))
+	{
+		pa += center;
+		pb += center;
+		return true;
+	}
+	return false;
 }
 
 bool common_pointComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -163,14 +650,20 @@ bool common_pointComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_S
 const Common_pointTable& common_pointInitialize() 
 {
     static Common_pointTable table;
-    table.addEntry(COMPLEX, COMPLEX, common_pointComplexComplex);
-    table.addEntry(COMPLEX, CONVEX, common_pointComplexConvex);
-    table.addEntry(CONVEX, CONVEX, common_pointConvexConvex);
+	addGeneralEntries(table, common_pointComplexComplex, common_pointComplexConvex, common_pointConvexConvex);
+    table.addEntry(COMPLEX, SPHERE, common_pointComplexSphere);
     return table;
 }
 
 bool common_point(const DT_Object& a, const DT_Object& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return common_point(w, v, pa, pb);
+	}
+
     static const Common_pointTable& common_pointTable = common_pointInitialize();
     Common_point common_point = common_pointTable.lookup(a.getType(), b.getType());
     return common_point(a.m_shape, a.m_xform, a.m_margin, 
@@ -183,16 +676,36 @@ bool penetration_depthConvexConvex(const DT_Shape& a, const MT_Transform& a2w, M
 								   const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
                                    MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    return hybrid_penetration_depth(DT_Transform(a2w, (const DT_Convex&)a), a_margin, 
-									DT_Transform(b2w, (const DT_Convex&)b), b_margin, v, pa, pb);
+	DT_GJK gjk;
+	return place(Penetration_depthQuery(a_margin, b_margin, v, pa, pb, gjk), 
+				 a, a2w, MT_Scalar(0.0), b, b2w, MT_Scalar(0.0));
 }
 
 bool penetration_depthComplexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 									const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
                                     MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    return penetration_depth((const DT_Complex&)a, a2w, a_margin,
-							 DT_Transform(b2w, (const DT_Convex&)b), b_margin, v, pa, pb);
+	return place(ComplexPenetration_depthQuery(a, a2w, a_margin, b_margin, v, pa, pb), b, b2w, MT_Scalar(0.0));
+}
+
+bool penetration_depthComplexSphere(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+									const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+									MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
+{
+	MT_Point3 center;
+	MT_Scalar radius;
+	if (!sphere(b, b2w, center, radius))
+	{
+		return penetration_depthComplexConvex(a, a2w, a_margin, b, b2w, b_margin, v, pa, pb);
+	}
+	
+	if (penetration_depth((const DT_Complex&)a, centered(a2w, center), a_margin, DT_Sphere(radius), b_margin, v, pa, pb))
+	{
+		pa += center;
+		pb += center;
+		return true;
+	}
+	return false;
 }
 
 bool penetration_depthComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -205,14 +718,20 @@ bool penetration_depthComplexComplex(const DT_Shape& a, const MT_Transform& a2w,
 const Penetration_depthTable& penetration_depthInitialize() 
 {
     static Penetration_depthTable table;
-    table.addEntry(COMPLEX, COMPLEX, penetration_depthComplexComplex);
-    table.addEntry(COMPLEX, CONVEX, penetration_depthComplexConvex);
-    table.addEntry(CONVEX, CONVEX, penetration_depthConvexConvex);
+	addGeneralEntries(table, penetration_depthComplexComplex, penetration_depthComplexConvex, penetration_depthConvexConvex);
+    table.addEntry(COMPLEX, SPHERE, penetration_depthComplexSphere);
     return table;
 }
 
 bool penetration_depth(const DT_Object& a, const DT_Object& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return penetration_depth(w, v, pa, pb);
+	}
+
     static const Penetration_depthTable& penetration_depthTable = penetration_depthInitialize();
     Penetration_depth penetration_depth = penetration_depthTable.lookup(a.getType(), b.getType());
     return penetration_depth(a.m_shape, a.m_xform, a.m_margin, 
@@ -224,19 +743,31 @@ MT_Scalar closest_pointsConvexConvex(const DT_Shape& a, const MT_Transform& a2w,
 									 const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
 									 MT_Point3& pa, MT_Point3& pb)
 {
-	DT_Transform ta(a2w, (const DT_Convex&)a);
-	DT_Transform tb(b2w, (const DT_Convex&)b);
-    return closest_points((a_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : static_cast<const DT_Convex&>(ta)), 
-						  (b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), MT_INFINITY, pa, pb);
+	return place(Closest_pointsQuery(pa, pb), a, a2w, a_margin, b, b2w, b_margin);
 }
 
 MT_Scalar closest_pointsComplexConvex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
 									  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
 									  MT_Point3& pa, MT_Point3& pb)
 {
-	DT_Transform tb(b2w, (const DT_Convex&)b);
-    return closest_points((const DT_Complex&)a, a2w, a_margin,
-						  (b_margin > MT_Scalar(0.0) ? static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : static_cast<const DT_Convex&>(tb)), pa, pb);
+	return place(ComplexClosest_pointsQuery(a, a2w, a_margin, pa, pb), b, b2w, b_margin);
+}
+
+MT_Scalar closest_pointsComplexSphere(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+									  const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin,
+									  MT_Point3& pa, MT_Point3& pb)
+{
+	MT_Point3 center;
+	MT_Scalar radius;
+	if (!sphere(b, b2w, center, radius))
+	{
+		return closest_pointsComplexConvex(a, a2w, a_margin, b, b2w, b_margin, pa, pb);
+	}
+	
+	MT_Scalar dist2 = closest_points((const DT_Complex&)a, centered(a2w, center), a_margin, DT_Sphere(radius + b_margin), pa, pb);
+	pa += center;
+	pb += center;
+	return dist2;
 }
 
 MT_Scalar closest_pointsComplexComplex(const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -250,18 +781,123 @@ MT_Scalar closest_pointsComplexComplex(const DT_Shape& a, const MT_Transform& a2
 const Closest_pointsTable& closest_pointsInitialize()
 {
     static Closest_pointsTable table;
-    table.addEntry(COMPLEX, COMPLEX, closest_pointsComplexComplex);
-    table.addEntry(COMPLEX, CONVEX, closest_pointsComplexConvex);
-    table.addEntry(CONVEX, CONVEX, closest_pointsConvexConvex);
+	addGeneralEntries(table, closest_pointsComplexComplex, closest_pointsComplexConvex, closest_pointsConvexConvex);
+    table.addEntry(COMPLEX, SPHERE, closest_pointsComplexSphere);
     return table;
 }
 
 MT_Scalar closest_points(const DT_Object& a, const DT_Object& b,
 						 MT_Point3& pa, MT_Point3& pb) 
 {
+	static const WitnessTable& closestTable = closestInitialize();
+	DT_Witness w;
+	if (witness(closestTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return closest_points(w, MT_INFINITY, pa, pb);
+	}
+
     static const Closest_pointsTable& closest_pointsTable = closest_pointsInitialize();
     Closest_points closest_points = closest_pointsTable.lookup(a.getType(), b.getType());
     return closest_points(a.m_shape, a.m_xform, a.m_margin, 
 						  b.m_shape, b.m_xform, b.m_margin, pa, pb);
 }
 
+
+// The tests on pairs of convex objects with a simplex cache. The simplex of 
+// the hybrid penetration depth method is that of the objects without their 
+// margins. Pairs with closed-form tests leave the cache alone.
+
+bool intersect(const DT_Object& a, const DT_Object& b, MT_Vector3& v, DT_SimplexCache& cache) 
+{
+	if (a.getType() == COMPLEX || b.getType() == COMPLEX)
+	{
+		return intersect(a, b, v);
+	}
+
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return intersect(w, v);
+	}
+
+	DT_GJK gjk;
+	cache.seed(gjk, a.m_xform, a.m_margin, a.m_stamp, b.m_xform, b.m_margin, b.m_stamp, v);
+
+	bool result = place(IntersectQuery(v, gjk), a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin);
+
+	cache.store(gjk, a.m_xform, a.m_margin, a.m_stamp, b.m_xform, b.m_margin, b.m_stamp);
+	return result;
+}
+
+bool common_point(const DT_Object& a, const DT_Object& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, 
+				  DT_SimplexCache& cache) 
+{
+	if (a.getType() == COMPLEX || b.getType() == COMPLEX)
+	{
+		return common_point(a, b, v, pa, pb);
+	}
+
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return common_point(w, v, pa, pb);
+	}
+
+	DT_GJK gjk;
+	cache.seed(gjk, a.m_xform, a.m_margin, a.m_stamp, b.m_xform, b.m_margin, b.m_stamp, v);
+
+	bool result = place(Common_pointQuery(v, pa, pb, gjk), a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin);
+
+	cache.store(gjk, a.m_xform, a.m_margin, a.m_stamp, b.m_xform, b.m_margin, b.m_stamp);
+	return result;
+}
+
+bool penetration_depth(const DT_Object& a, const DT_Object& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, 
+					   DT_SimplexCache& cache) 
+{
+	if (a.getType() == COMPLEX || b.getType() == COMPLEX)
+	{
+		return penetration_depth(a, b, v, pa, pb);
+	}
+
+	static const WitnessTable& witnessTable = witnessInitialize();
+	DT_Witness w;
+	if (witness(witnessTable, a.m_shape, a.m_xform, a.m_margin, b.m_shape, b.m_xform, b.m_margin, w))
+	{
+		return penetration_depth(w, v, pa, pb);
+	}
+
+	DT_GJK gjk;
+	cache.seed(gjk, a.m_xform, MT_Scalar(0.0), a.m_stamp, b.m_xform, MT_Scalar(0.0), b.m_stamp, v);
+
+	bool result = place(Penetration_depthQuery(a.m_margin, b.m_margin, v, pa, pb, gjk), 
+						a.m_shape, a.m_xform, MT_Scalar(0.0), b.m_shape, b.m_xform, MT_Scalar(0.0));
+
+	cache.store(gjk, a.m_xform, MT_Scalar(0.0), a.m_stamp, b.m_xform, MT_Scalar(0.0), b.m_stamp);
+	return result;
+}
+
+bool apart(const DT_Object& a, const DT_Object& b, const DT_SeparationBound& bound)
+{
+	return a.getType() != COMPLEX && b.getType() != COMPLEX &&
+		bound.holds(a.m_xform, a.m_margin, a.m_radius, b.m_xform, b.m_margin, b.m_radius);
+}
+
+void bound_separation(const DT_Object& a, const DT_Object& b, const MT_Vector3& v, 
+					  DT_SeparationBound& bound)
+{
+	MT_Scalar len = v.length();
+	if (a.getType() == COMPLEX || b.getType() == COMPLEX || len == MT_Scalar(0.0))
+	{
+		bound.clear();
+		return;
+	}
+
+	// The gap between the projections of the enlarged objects on 'v'
+	DT_Transform ta(a.m_xform, (const DT_Convex&)a.m_shape);
+	DT_Transform tb(b.m_xform, (const DT_Convex&)b.m_shape);
+	MT_Scalar dist = -(ta.supportH(-v) + tb.supportH(v)) / len - a.m_margin - b.m_margin;
+	bound.store(dist, a.m_xform, a.m_margin, b.m_xform, b.m_margin);
+}
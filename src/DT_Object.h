@@ -36,6 +36,9 @@
 #include "DT_Complex.h"
 
 class DT_Convex;
+class DT_Scene;
+class DT_SimplexCache;
+class DT_SeparationBound;
 
 class DT_Object {
 public:
@@ -43,13 +46,22 @@ public:
 		m_client_object(client_object),
 		m_responseClass(0),
 		m_shape(shape), 
-		m_margin(MT_Scalar(0.0))
+		m_margin(MT_Scalar(0.0)),
+		m_mode(DT_DYNAMIC),
+		m_stamp(0),
+		m_radius(MT_Scalar(0.0)),
+		m_dirty(false)
 	{
 		m_xform.setIdentity();
 		if (m_shape.getType() == COMPLEX)
 		{
 			static_cast<const DT_Complex&>(m_shape).subscribe(this);
 		}
+		else
+		{
+			MT_BBox bbox = m_shape.bbox(m_xform, MT_Scalar(0.0));
+			m_radius = (bbox.getCenter().absolute() + bbox.getExtent()).length();
+		}
 		setBBox();
 	}
 
@@ -64,39 +76,52 @@ public:
 	void setMargin(MT_Scalar margin) 
 	{ 
 		m_margin = margin; 
-		setBBox();
+		++m_stamp;
+		invalidateBBox();
 	}
 
 	void setScaling(const MT_Vector3& scaling)
 	{
         m_xform.scale(scaling);
-        setBBox();
+		++m_stamp;
+        invalidateBBox();
     }
 
     void setPosition(const MT_Point3& pos) 
 	{ 
         m_xform.setOrigin(pos);
-        setBBox();
+        invalidateBBox();
     }
     
     void setOrientation(const MT_Quaternion& orn)
 	{
 		m_xform.setRotation(orn);
-		setBBox();
+		invalidateBBox();
+    }
+
+    void setTransform(const MT_Point3& pos, const MT_Quaternion& orn)
+	{
+		m_xform.setOrigin(pos);
+		m_xform.setRotation(orn);
+		invalidateBBox();
     }
 
 	void setMatrix(const float *m) 
 	{
+		MT_Matrix3x3 metric = getMetric();
         m_xform.setValue(m);
 		assert(m_xform.getBasis().determinant() != MT_Scalar(0.0));
-        setBBox();
+		stampMetric(metric);
+        invalidateBBox();
     }
 
     void setMatrix(const double *m)
 	{
+		MT_Matrix3x3 metric = getMetric();
         m_xform.setValue(m);
 		assert(m_xform.getBasis().determinant() != MT_Scalar(0.0));
-        setBBox();
+		stampMetric(metric);
+        invalidateBBox();
     }
 
     void getMatrix(float *m) const
@@ -111,6 +136,27 @@ public:
 
 	void setBBox();
 
+	// Placement changes only mark the bounding box as out of date. The first 
+	// change puts the object on the dirty lists of its scenes, which bring 
+	// the box up to date once before testing or casting rays.
+	void invalidateBBox() 
+	{ 
+		if (!m_dirty)
+		{
+			markDirty();
+		}
+	}
+	
+	void updateBBox() 
+	{ 
+		if (m_dirty) 
+		{
+			setBBox();
+		}
+	}
+	
+	bool isDirty() const { return m_dirty; }
+
 	const MT_BBox& getBBox() const { return m_bbox; }	
 	
     DT_ResponseClass getResponseClass() const { return m_responseClass; }
@@ -126,12 +172,27 @@ public:
 
 	bool ray_cast(const MT_Point3& source, const MT_Point3& target, 
 				  MT_Scalar& param, MT_Vector3& normal) const; 
+	bool ray_test(const MT_Point3& source, const MT_Point3& target, MT_Scalar param) const; 
 
-	void addProxy(BP_ProxyHandle proxy) { m_proxies.push_back(proxy); }
+	void setMode(DT_ProxyMode mode);
+	DT_ProxyMode getMode() const { return m_mode; }
+
+	void addProxy(DT_Scene *scene, BP_ProxyHandle proxy) 
+	{ 
+		m_proxies.push_back(std::make_pair(scene, proxy)); 
+		if (m_mode != DT_DYNAMIC)
+		{
+			BP_SetProxyMode(proxy, m_mode);
+		}
+	}
 
 	void removeProxy(BP_ProxyHandle proxy) 
 	{ 
-		T_ProxyList::iterator it = std::find(m_proxies.begin(), m_proxies.end(), proxy);
+		T_ProxyList::iterator it = m_proxies.begin();
+		while (it != m_proxies.end() && (*it).second != proxy) 
+		{
+			++it;
+		}
 		if (it != m_proxies.end()) {
 			m_proxies.erase(it);
 		}
@@ -149,8 +210,38 @@ public:
 	friend MT_Scalar closest_points(const DT_Object&, const DT_Object&, 
 									MT_Point3&, MT_Point3&);
 
+	// The same tests, starting from the simplex of the previous test on the
+	// pair if both objects are convex, and leaving the new one in the cache.
+	// Pairs of primitives with closed-form tests do not use the cache.
+	friend bool intersect(const DT_Object&, const DT_Object&, MT_Vector3& v, 
+						  DT_SimplexCache&);
+	
+	friend bool common_point(const DT_Object&, const DT_Object&, MT_Vector3&, 
+							 MT_Point3&, MT_Point3&, DT_SimplexCache&);
+	
+	friend bool penetration_depth(const DT_Object&, const DT_Object&, 
+								  MT_Vector3&, MT_Point3&, MT_Point3&, DT_SimplexCache&);
+
+	// Whether a pair of convex objects is still apart by the bound on their
+	// distance, and the update of the bound after a test found the objects
+	// apart, from the separating axis 'v' left by the test.
+	friend bool apart(const DT_Object&, const DT_Object&, const DT_SeparationBound&);
+
+	friend void bound_separation(const DT_Object&, const DT_Object&, const MT_Vector3& v,
+								 DT_SeparationBound&);
+
 private:
-	typedef std::vector<BP_ProxyHandle> T_ProxyList;
+	typedef std::vector<std::pair<DT_Scene *, BP_ProxyHandle> > T_ProxyList;
+
+	void markDirty();
+
+	// The lengths of and angles between the axes of the basis
+	MT_Matrix3x3 getMetric() const 
+	{ 
+		return m_xform.getBasis().transposeTimes(m_xform.getBasis()); 
+	}
+
+	void stampMetric(const MT_Matrix3x3& metric);
 
 	void              *m_client_object;
 	DT_ResponseClass   m_responseClass;
@@ -158,7 +249,11 @@ private:
     MT_Scalar          m_margin;
 	MT_Transform       m_xform;
 	T_ProxyList		   m_proxies;
+	DT_ProxyMode       m_mode;
+	unsigned int       m_stamp;    // counts changes of margin and scaling
+	MT_Scalar          m_radius;   // of a convex shape about its local origin
 	MT_BBox            m_bbox;
+	bool               m_dirty;
 };
 
 #endif
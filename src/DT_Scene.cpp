@@ -24,6 +24,10 @@
 #include "DT_Scene.h"
 #include "DT_Object.h"
 #include "DT_Convex.h"
+#include "DT_RespTable.h"
+#include "GEN_MinMax.h"
+
+#include <algorithm>
 
 //#define DEBUG
 
@@ -80,18 +84,58 @@ static bool objectRayCast(void *client_data,
 	return false;
 }
 
-DT_Scene::DT_Scene() 
-	: m_broadphase(BP_CreateScene(this, &beginOverlap, &endOverlap)),
-	  m_state(0x0)
+struct DT_RayTestData {
+	DT_RayTestData(const void *ignore) 
+	  : m_ignore(ignore),
+		m_hit(false)
+	{}
+
+	const void  *m_ignore;
+	bool         m_hit;
+};
+
+// Once an object is hit, the ray is cut down to nothing, so that the broad 
+// phase has nothing left to visit.
+static bool objectRayTest(void *client_data, 
+						  void *object,  
+						  const DT_Vector3 source,
+						  const DT_Vector3 target,
+						  DT_Scalar *lambda) 
+{
+	DT_RayTestData *data = static_cast<DT_RayTestData *>(client_data); 
+	if (!data->m_hit && 
+		((DT_Object *)object)->getClientObject() != data->m_ignore &&
+		((DT_Object *)object)->ray_test(MT_Point3(source), MT_Point3(target), MT_Scalar(*lambda)))
+	{
+		data->m_hit = true;
+		*lambda = DT_Scalar(0.0);
+		return true;
+	}
+	return false;
+}
+
+DT_Scene::DT_Scene(DT_BroadphaseType type, DT_Scalar param) 
+	: m_broadphase(BP_CreateSceneOfType(type, param, this, &beginOverlap, &endOverlap)),
+	  m_state(0x0),
+	  m_warm_start(true),
+	  m_cull(false)
 {}
 
 DT_Scene::~DT_Scene()
 {
+	// The objects outlive the scene, so they must not keep its proxies
+	T_ObjectList::iterator it;
+	for (it = m_objectList.begin(); it != m_objectList.end(); ++it)
+	{
+		(*it).first->removeProxy((*it).second);
+	}
+
 	BP_DestroyScene(m_broadphase);
 }
 
 void DT_Scene::addObject(DT_Object &object)
 {
+	object.updateBBox();
 	const MT_BBox& bbox = object.getBBox();
 	DT_Vector3 min, max;
 	bbox.getMin().getValue(min);
@@ -106,7 +150,7 @@ void DT_Scene::addObject(DT_Object &object)
 	}
 	std::cout << std::endl;
 #endif
-	object.addProxy(proxy);
+	object.addProxy(this, proxy);
     m_objectList.push_back(std::make_pair(&object, proxy));
 }
 
@@ -126,6 +170,8 @@ void DT_Scene::removeObject(DT_Object& object)
 		object.removeProxy((*it).second);
         BP_DestroyProxy(m_broadphase, (*it).second);
 		m_objectList.erase(it);
+		m_dirtyList.erase(std::remove(m_dirtyList.begin(), m_dirtyList.end(), &object), 
+						  m_dirtyList.end());
 
 #ifdef DEBUG
 		std::cout << "Remove " << &object << ':';
@@ -143,18 +189,163 @@ void DT_Scene::removeObject(DT_Object& object)
 
 
 
+void DT_Scene::addObjects(DT_Size count, DT_Object *const *objects)
+{
+	// The proxies are created in one batch per mode
+	std::vector<void *> batch;
+	std::vector<DT_Scalar> min, max;
+	std::vector<BP_ProxyHandle> proxies;
+
+	int mode;
+	for (mode = DT_DYNAMIC; mode <= DT_SLEEPING; ++mode)
+	{
+		DT_Size i;
+		for (i = 0; i != count; ++i)
+		{
+			DT_Object *object = objects[i];
+			if (object->getMode() == mode)
+			{
+				object->updateBBox();
+				const MT_BBox& bbox = object->getBBox();
+				DT_Vector3 bbox_min, bbox_max;
+				bbox.getMin().getValue(bbox_min);
+				bbox.getMax().getValue(bbox_max);
+
+				batch.push_back(object);
+				min.insert(min.end(), bbox_min, bbox_min + 3);
+				max.insert(max.end(), bbox_max, bbox_max + 3);
+			}
+		}
+
+		if (batch.empty())
+		{
+			continue;
+		}
+
+		proxies.resize(batch.size());
+		BP_CreateProxies(m_broadphase, DT_Size(batch.size()), &batch[0], 
+						 reinterpret_cast<const DT_Vector3 *>(&min[0]),
+						 reinterpret_cast<const DT_Vector3 *>(&max[0]),
+						 DT_ProxyMode(mode), &proxies[0]);
+
+		for (i = 0; i != batch.size(); ++i)
+		{
+			DT_Object *object = static_cast<DT_Object *>(batch[i]);
+			object->addProxy(this, proxies[i]);
+			m_objectList.push_back(std::make_pair(object, proxies[i]));
+		}
+
+		batch.clear();
+		min.clear();
+		max.clear();
+	}
+}
+
+void DT_Scene::removeObjects(DT_Size count, DT_Object *const *objects)
+{
+	std::vector<DT_Object *> removed(objects, objects + count);
+	std::sort(removed.begin(), removed.end());
+
+	std::vector<BP_ProxyHandle> proxies;
+
+	// A single pass over the object list collects the proxies and closes 
+	// the gaps.
+	T_ObjectList::iterator it;
+	T_ObjectList::iterator kept = m_objectList.begin();
+	for (it = m_objectList.begin(); it != m_objectList.end(); ++it)
+	{
+		if (std::binary_search(removed.begin(), removed.end(), (*it).first))
+		{
+			(*it).first->removeProxy((*it).second);
+			proxies.push_back((*it).second);
+		}
+		else 
+		{
+			*kept++ = *it;
+		}
+	}
+	m_objectList.erase(kept, m_objectList.end());
+
+	std::vector<DT_Object *>::iterator dirty;
+	std::vector<DT_Object *>::iterator kept_dirty = m_dirtyList.begin();
+	for (dirty = m_dirtyList.begin(); dirty != m_dirtyList.end(); ++dirty)
+	{
+		if (!std::binary_search(removed.begin(), removed.end(), *dirty))
+		{
+			*kept_dirty++ = *dirty;
+		}
+	}
+	m_dirtyList.erase(kept_dirty, m_dirtyList.end());
+
+	if (!proxies.empty())
+	{
+		BP_DestroyProxies(m_broadphase, DT_Size(proxies.size()), &proxies[0]);
+	}
+}
+
+void DT_Scene::beginUpdate()
+{
+	assert((m_state & UPDATING) == 0x0);
+
+	m_state |= UPDATING;
+	BP_BeginUpdate(m_broadphase);
+}
+
+void DT_Scene::commitUpdate()
+{
+	assert((m_state & UPDATING) != 0x0);
+
+	updateBBoxes();
+	BP_CommitUpdate(m_broadphase);
+	m_state &= ~UPDATING;
+}
+
+void DT_Scene::updateBBoxes()
+{
+	// Only the objects that were moved since the last call are visited, so 
+	// this is cheap if nothing moved. Each gets its bounding box recomputed 
+	// once, and the new boxes are passed to the broad phase in a single 
+	// update, unless the client already has an update pending. An object 
+	// that is on the list more than once, or that was brought up to date by 
+	// another scene, is skipped.
+	if (m_dirtyList.empty())
+	{
+		return;
+	}
+
+	bool update = (m_state & UPDATING) == 0x0;
+	if (update)
+	{
+		BP_BeginUpdate(m_broadphase);
+	}
+
+	std::vector<DT_Object *>::const_iterator it;
+	for (it = m_dirtyList.begin(); it != m_dirtyList.end(); ++it)
+	{
+		(*it)->updateBBox();
+	}
+	m_dirtyList.clear();
+
+	if (update)
+	{
+		BP_CommitUpdate(m_broadphase);
+	}
+}
+
 int DT_Scene::handleCollisions(const DT_RespTable *respTable)
 {
     int count = 0;
 
     assert(respTable);
 
+	updateBBoxes();
+
 	m_state |= TESTING;
 
 	DT_EncounterTable::iterator it;	
 	for (it = m_encounterTable.begin(); it != m_encounterTable.end(); ++it)
 	{
-		if ((*it).exactTest(respTable, count))
+		if ((*it).exactTest(respTable, m_warm_start, m_cull, count))
 		{
 			break;
         }
@@ -165,10 +356,74 @@ int DT_Scene::handleCollisions(const DT_RespTable *respTable)
     return count;
 }
 
+int DT_Scene::handleCollisionsParallel(const DT_RespTable *respTable)
+{
+    int count = 0;
+
+    assert(respTable);
+
+	updateBBoxes();
+
+	m_state |= TESTING;
+
+	// The encounters are tested in blocks. The exact tests of a block run on
+	// all threads. Then the responses are called on this thread in the order 
+	// of the encounter table, as in 'handleCollisions'. The new separating 
+	// axes, simplices and bounds are stored in the encounters only then, so the 
+	// outcome does not depend on the number of threads, even if a response 
+	// returns DT_DONE.
+	int num_encounters = int(m_encounterTable.size());
+	m_results.resize(GEN_min(num_encounters, int(TEST_BLOCK_SIZE)));
+
+	bool done = false;
+	int first;
+	for (first = 0; first < num_encounters && !done; first += TEST_BLOCK_SIZE)
+	{
+		int last = GEN_min(first + int(TEST_BLOCK_SIZE), num_encounters);
+
+		int i;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+		for (i = first; i < last; ++i)
+		{
+			const DT_Encounter& e = m_encounterTable[i];
+			T_TestResult& result = m_results[i - first];
+			result.m_type = respTable->find(e.first(), e.second()).getType();
+			result.m_sep_axis = e.separatingAxis();
+			result.m_simplex = e.simplex();
+			result.m_separation = e.separation();
+			result.m_hit = e.test(result.m_type, result.m_sep_axis, m_warm_start ? &result.m_simplex : 0, 
+								  m_cull ? &result.m_separation : 0, result.m_point1, result.m_point2);
+		}
+
+		for (i = first; i < last && !done; ++i)
+		{
+			const DT_Encounter& e = m_encounterTable[i];
+			const T_TestResult& result = m_results[i - first];
+			e.setSeparatingAxis(result.m_sep_axis);
+			e.setSimplex(result.m_simplex);
+			e.setSeparation(result.m_separation);
+			if (result.m_hit)
+			{
+				++count;
+				done = e.respond(respTable, respTable->find(e.first(), e.second()), 
+								 result.m_point1, result.m_point2) == DT_DONE;
+			}
+		}
+	}
+
+	m_state &= ~TESTING;
+
+    return count;
+}
+
 void *DT_Scene::rayCast(const void *ignore_client,
 						const DT_Vector3 source, const DT_Vector3 target, 
-						DT_Scalar& lambda, DT_Vector3 normal) const 
+						DT_Scalar& lambda, DT_Vector3 normal)
 {
+	updateBBoxes();
+
 	DT_RayCastData data(ignore_client);
 	DT_Object *object = (DT_Object *)BP_RayCast(m_broadphase, 
 												&objectRayCast, 
@@ -183,3 +438,18 @@ void *DT_Scene::rayCast(const void *ignore_client,
 	
 	return 0;
 }
+
+void *DT_Scene::rayTest(const void *ignore_client,
+						const DT_Vector3 source, const DT_Vector3 target, 
+						DT_Scalar lambda)
+{
+	updateBBoxes();
+
+	DT_RayTestData data(ignore_client);
+	DT_Object *object = (DT_Object *)BP_RayCast(m_broadphase, 
+												&objectRayTest, 
+												&data, 
+												source, target,
+												&lambda);
+	return object ? object->getClientObject() : 0;
+}
@@ -33,14 +33,29 @@ class DT_Object;
 class DT_RespTable;
 
 class DT_Scene {
-	enum { TESTING = 0x4 };
+	enum { TESTING = 0x4, UPDATING = 0x8 };
+	enum { TEST_BLOCK_SIZE = 1024 };
 public:
-    DT_Scene();
+    DT_Scene(DT_BroadphaseType type = DT_SWEEP_AND_PRUNE, DT_Scalar param = DT_Scalar(0.0));
     ~DT_Scene();
 
     void addObject(DT_Object& object);
     void removeObject(DT_Object& object);
 
+	void addObjects(DT_Size count, DT_Object *const *objects);
+	void removeObjects(DT_Size count, DT_Object *const *objects);
+
+	void beginUpdate();
+	void commitUpdate();
+	void updateBBoxes();
+
+	// Called by an object of the scene the first time it is moved after its 
+	// bounding box was brought up to date
+	void addDirty(DT_Object *object) { m_dirtyList.push_back(object); }
+
+	void setWarmStart(bool warm_start) { m_warm_start = warm_start; }
+	void setCulling(bool cull) { m_cull = cull; }
+
     void addEncounter(const DT_Encounter& e)
     {
 		assert((m_state & TESTING) == 0x0);
@@ -60,18 +75,39 @@ public:
 
 
     int  handleCollisions(const DT_RespTable *respTable);
+    int  handleCollisionsParallel(const DT_RespTable *respTable);
 
 	void *rayCast(const void *ignore_client, 
 				  const DT_Vector3 source, const DT_Vector3 target, 
-				  DT_Scalar& lambda, DT_Vector3 normal) const;
+				  DT_Scalar& lambda, DT_Vector3 normal);
+	void *rayTest(const void *ignore_client, 
+				  const DT_Vector3 source, const DT_Vector3 target, 
+				  DT_Scalar lambda);
 
 private:
 	typedef std::vector<std::pair<DT_Object *, BP_ProxyHandle> > T_ObjectList;
 
+	// Outcome of the exact test of an encounter, kept until the response 
+	// is called.
+	struct T_TestResult {
+		DT_ResponseType    m_type;
+		bool               m_hit;
+		MT_Vector3         m_sep_axis;
+		DT_SimplexCache    m_simplex;
+		DT_SeparationBound m_separation;
+		MT_Point3          m_point1;
+		MT_Point3          m_point2;
+	};
+
 	BP_SceneHandle      m_broadphase;
 	T_ObjectList        m_objectList;
+	std::vector<DT_Object *> m_dirtyList;
     DT_EncounterTable   m_encounterTable;
 	unsigned int        m_state;
+	bool                m_warm_start;
+	bool                m_cull;
+
+	std::vector<T_TestResult> m_results;
 };
 
 #endif
@@ -0,0 +1,86 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_SEPARATIONBOUND_H
+#define DT_SEPARATIONBOUND_H
+
+#include "MT_Scalar.h"
+#include "MT_Transform.h"
+
+// A lower bound on the distance between two convex objects, found by the last
+// test on the pair, together with the placements of the objects at the time.
+// No point of an object is further from where it was than the displacement of
+// its origin plus the change of its basis times the radius of its shape. As 
+// long as the displacements of both objects add up to less than the bound, 
+// the objects are still apart. A changed margin voids the bound.
+
+class DT_SeparationBound {
+public:
+	DT_SeparationBound() : 
+		m_dist(MT_Scalar(0.0)),
+		m_a_margin(MT_Scalar(0.0)),
+		m_b_margin(MT_Scalar(0.0))
+	{}
+
+	void clear() { m_dist = MT_Scalar(0.0); }
+
+	bool holds(const MT_Transform& a2w, MT_Scalar a_margin, MT_Scalar a_radius,
+			   const MT_Transform& b2w, MT_Scalar b_margin, MT_Scalar b_radius) const
+	{
+		return m_dist > MT_Scalar(0.0) && 
+			a_margin == m_a_margin && b_margin == m_b_margin &&
+			displacement(m_a2w, a2w, a_radius) + displacement(m_b2w, b2w, b_radius) < m_dist;
+	}
+
+	void store(MT_Scalar dist, 
+			   const MT_Transform& a2w, MT_Scalar a_margin,
+			   const MT_Transform& b2w, MT_Scalar b_margin)
+	{
+		m_dist     = dist;
+		m_a2w      = a2w;
+		m_a_margin = a_margin;
+		m_b2w      = b2w;
+		m_b_margin = b_margin;
+	}
+
+private:
+	static MT_Scalar displacement(const MT_Transform& from, const MT_Transform& to, 
+								  MT_Scalar radius)
+	{
+		// The Frobenius norm bounds the spectral norm of the change of basis 
+		const MT_Matrix3x3& b0 = from.getBasis();
+		const MT_Matrix3x3& b1 = to.getBasis();
+		MT_Scalar norm2 = (b1[0] - b0[0]).length2() + 
+			(b1[1] - b0[1]).length2() + 
+			(b1[2] - b0[2]).length2();
+		return (to.getOrigin() - from.getOrigin()).length() + MT_sqrt(norm2) * radius;
+	}
+
+	MT_Scalar    m_dist;
+	MT_Transform m_a2w;
+	MT_Scalar    m_a_margin;
+	MT_Transform m_b2w;
+	MT_Scalar    m_b_margin;
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_SIMPLEXCACHE_H
+#define DT_SIMPLEXCACHE_H
+
+#include "MT_Point3.h"
+#include "MT_Transform.h"
+#include "DT_GJK.h"
+
+// The simplex of the last GJK run on a pair of convex objects, from which the
+// next run on the pair can start. The vertices are stored in the local 
+// coordinates of the objects, so they are still points of the objects after 
+// these have moved. This also holds for scaled objects, but not for a vertex 
+// on an object enlarged by a margin, once the margin or the scaling of the 
+// object is changed. The stamp of an object tells whether either one was.
+
+class DT_SimplexCache {
+public:
+	DT_SimplexCache() : 
+		m_num_verts(0),
+		m_a_margin(MT_Scalar(0.0)),
+		m_b_margin(MT_Scalar(0.0)),
+		m_a_stamp(0),
+		m_b_stamp(0)
+	{}
+
+	void clear() { m_num_verts = 0; }
+
+	// Seeds 'gjk' with the cached simplex for a run on the objects enlarged 
+	// by 'a_margin' and 'b_margin', if it is still valid.
+	bool seed(DT_GJK& gjk, 
+			  const MT_Transform& a2w, MT_Scalar a_margin, unsigned int a_stamp,
+			  const MT_Transform& b2w, MT_Scalar b_margin, unsigned int b_stamp,
+			  MT_Vector3& v) const
+	{
+		if (m_num_verts == 0 ||
+			!valid(m_a_margin, m_a_stamp, a_margin, a_stamp) ||
+			!valid(m_b_margin, m_b_stamp, b_margin, b_stamp))
+		{
+			return false;
+		}
+
+		MT_Point3 pBuf[4];
+		MT_Point3 qBuf[4];
+		int i;
+		for (i = 0; i != m_num_verts; ++i)
+		{
+			pBuf[i] = a2w(m_p[i]);
+			qBuf[i] = b2w(m_q[i]);
+		}
+		return gjk.seed(m_num_verts, pBuf, qBuf, v);
+	}
+
+	void store(const DT_GJK& gjk, 
+			   const MT_Transform& a2w, MT_Scalar a_margin, unsigned int a_stamp,
+			   const MT_Transform& b2w, MT_Scalar b_margin, unsigned int b_stamp)
+	{
+		MT_Point3  pBuf[4];
+		MT_Point3  qBuf[4];
+		MT_Vector3 yBuf[4];
+		m_num_verts = gjk.getSimplex(pBuf, qBuf, yBuf);
+		if (m_num_verts != 0)
+		{
+			MT_Transform w2a = a2w.inverse();
+			MT_Transform w2b = b2w.inverse();
+			int i;
+			for (i = 0; i != m_num_verts; ++i)
+			{
+				m_p[i] = w2a(pBuf[i]);
+				m_q[i] = w2b(qBuf[i]);
+			}
+		}
+		m_a_margin = a_margin;
+		m_a_stamp  = a_stamp;
+		m_b_margin = b_margin;
+		m_b_stamp  = b_stamp;
+	}
+
+private:
+	// A vertex on the object itself is also a point of the enlarged object
+	static bool valid(MT_Scalar margin, unsigned int stamp, 
+					  MT_Scalar new_margin, unsigned int new_stamp)
+	{
+		return margin == MT_Scalar(0.0) || (margin == new_margin && stamp == new_stamp);
+	}
+
+	int          m_num_verts;
+	MT_Scalar    m_a_margin;
+	MT_Scalar    m_b_margin;
+	unsigned int m_a_stamp;
+	unsigned int m_b_stamp;
+	MT_Point3    m_p[4];
+	MT_Point3    m_q[4];
+};
+
+#endif
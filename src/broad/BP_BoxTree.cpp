@@ -0,0 +1,455 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <assert.h>
+
+#include "GEN_MinMax.h"
+#include "BP_BoxTree.h"
+#include "BP_Clip.h"
+
+inline void setBox(BP_BoxNode& node, const DT_Vector3 min, const DT_Vector3 max)
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		node.m_min[i] = min[i];
+		node.m_max[i] = max[i];
+	}
+}
+
+inline void combine(BP_BoxNode& node, const BP_BoxNode& a, const BP_BoxNode& b)
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		node.m_min[i] = GEN_min(a.m_min[i], b.m_min[i]);
+		node.m_max[i] = GEN_max(a.m_max[i], b.m_max[i]);
+	}
+}
+
+inline DT_Scalar area(const DT_Vector3 min, const DT_Vector3 max)
+{
+	DT_Scalar x = max[0] - min[0];
+	DT_Scalar y = max[1] - min[1];
+	DT_Scalar z = max[2] - min[2];
+	return x * y + y * z + z * x;
+}
+
+inline DT_Scalar area(const BP_BoxNode& node)
+{
+	return area(node.m_min, node.m_max);
+}
+
+inline DT_Scalar combinedArea(const BP_BoxNode& a, const BP_BoxNode& b)
+{
+	DT_Vector3 min, max;
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		min[i] = GEN_min(a.m_min[i], b.m_min[i]);
+		max[i] = GEN_max(a.m_max[i], b.m_max[i]);
+	}
+	return area(min, max);
+}
+
+int BP_BoxTree::allocateNode()
+{
+	if (m_freeList == -1)
+	{
+		m_nodes.push_back(BP_BoxNode());
+		m_nodes.back().m_parent = m_freeList;
+		m_nodes.back().m_height = -1;
+		m_freeList = int(m_nodes.size()) - 1;
+	}
+
+	int index = m_freeList;
+	BP_BoxNode& node = m_nodes[index];
+	m_freeList = node.m_parent;
+	node.m_parent = -1;
+	node.m_child1 = -1;
+	node.m_child2 = -1;
+	node.m_height = 0;
+	node.m_proxy = 0;
+	return index;
+}
+
+void BP_BoxTree::freeNode(int index)
+{
+	m_nodes[index].m_parent = m_freeList;
+	m_nodes[index].m_height = -1;
+	m_freeList = index;
+}
+
+int BP_BoxTree::createLeaf(BP_Proxy *proxy, const DT_Vector3 min, const DT_Vector3 max)
+{
+	int leaf = allocateNode();
+	m_nodes[leaf].m_proxy = proxy;
+	setBox(m_nodes[leaf], min, max);
+	insertLeaf(leaf);
+	return leaf;
+}
+
+void BP_BoxTree::destroyLeaf(int leaf)
+{
+	removeLeaf(leaf);
+	freeNode(leaf);
+}
+
+void BP_BoxTree::moveLeaf(int leaf, const DT_Vector3 min, const DT_Vector3 max)
+{
+	removeLeaf(leaf);
+	setBox(m_nodes[leaf], min, max);
+	insertLeaf(leaf);
+}
+
+bool BP_BoxTree::contains(int leaf, const DT_Vector3 min, const DT_Vector3 max) const
+{
+	const BP_BoxNode& node = m_nodes[leaf];
+	return node.m_min[0] <= min[0] && max[0] <= node.m_max[0] &&
+		   node.m_min[1] <= min[1] && max[1] <= node.m_max[1] &&
+		   node.m_min[2] <= min[2] && max[2] <= node.m_max[2];
+}
+
+void BP_BoxTree::query(const DT_Vector3 min, const DT_Vector3 max, T_ProxyList& result)
+{
+	if (m_root == -1)
+	{
+		return;
+	}
+
+	m_stack.push_back(m_root);
+	while (!m_stack.empty())
+	{
+		const BP_BoxNode& node = m_nodes[m_stack.back()];
+		m_stack.pop_back();
+
+		if (node.m_min[0] <= max[0] && min[0] <= node.m_max[0] &&
+			node.m_min[1] <= max[1] && min[1] <= node.m_max[1] &&
+			node.m_min[2] <= max[2] && min[2] <= node.m_max[2])
+		{
+			if (node.isLeaf())
+			{
+				result.push_back(node.m_proxy);
+			}
+			else
+			{
+				m_stack.push_back(node.m_child1);
+				m_stack.push_back(node.m_child2);
+			}
+		}
+	}
+}
+
+BP_Proxy *BP_BoxTree::rayCast(BP_RayCastCallback objectRayCast,
+							  void *client_data,
+							  const DT_Vector3 source, 
+							  const DT_Vector3 target, 
+							  DT_Scalar& lambda) const
+{
+	BP_Proxy *hit = 0;
+
+	if (m_root == -1)
+	{
+		return hit;
+	}
+
+	DT_Vector3 delta;
+	delta[0] = target[0] - source[0];
+	delta[1] = target[1] - source[1];
+	delta[2] = target[2] - source[2];
+
+	std::vector<int> stack;
+	stack.push_back(m_root);
+	while (!stack.empty())
+	{
+		const BP_BoxNode& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (BP_clip(node.m_min, node.m_max, source, delta, lambda))
+		{
+			if (node.isLeaf())
+			{
+				if ((*objectRayCast)(client_data, node.m_proxy->getObject(), source, target, &lambda))
+				{
+					hit = node.m_proxy;
+				}
+			}
+			else
+			{
+				stack.push_back(node.m_child1);
+				stack.push_back(node.m_child2);
+			}
+		}
+	}
+
+	return hit;
+}
+
+void BP_BoxTree::insertLeaf(int leaf)
+{
+	if (m_root == -1)
+	{
+		m_root = leaf;
+		m_nodes[m_root].m_parent = -1;
+		return;
+	}
+
+	// Find the best sibling for the leaf by descending into the child 
+	// that increases the surface area of the tree the least.
+	int index = m_root;
+	while (!m_nodes[index].isLeaf())
+	{
+		const BP_BoxNode& node = m_nodes[index];
+		const BP_BoxNode& box = m_nodes[leaf];
+		
+		DT_Scalar node_area = area(node);
+		DT_Scalar combined_area = combinedArea(node, box);
+
+		// Cost of creating a new parent for this node and the new leaf
+		DT_Scalar cost = DT_Scalar(2.0) * combined_area;
+
+		// Minimum cost of pushing the leaf further down the tree
+		DT_Scalar inheritance_cost = DT_Scalar(2.0) * (combined_area - node_area);
+
+		const BP_BoxNode& child1 = m_nodes[node.m_child1];
+		DT_Scalar cost1 = combinedArea(child1, box) + inheritance_cost;
+		if (!child1.isLeaf())
+		{
+			cost1 -= area(child1);
+		}
+
+		const BP_BoxNode& child2 = m_nodes[node.m_child2];
+		DT_Scalar cost2 = combinedArea(child2, box) + inheritance_cost;
+		if (!child2.isLeaf())
+		{
+			cost2 -= area(child2);
+		}
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = cost1 < cost2 ? node.m_child1 : node.m_child2;
+	}
+
+	int sibling = index;
+
+	int old_parent = m_nodes[sibling].m_parent;
+	int new_parent = allocateNode();
+	m_nodes[new_parent].m_parent = old_parent;
+	m_nodes[new_parent].m_height = m_nodes[sibling].m_height + 1;
+	m_nodes[new_parent].m_child1 = sibling;
+	m_nodes[new_parent].m_child2 = leaf;
+	combine(m_nodes[new_parent], m_nodes[sibling], m_nodes[leaf]);
+	m_nodes[sibling].m_parent = new_parent;
+	m_nodes[leaf].m_parent = new_parent;
+
+	if (old_parent == -1)
+	{
+		m_root = new_parent;
+	}
+	else if (m_nodes[old_parent].m_child1 == sibling)
+	{
+		m_nodes[old_parent].m_child1 = new_parent;
+	}
+	else
+	{
+		m_nodes[old_parent].m_child2 = new_parent;
+	}
+
+	refit(old_parent);
+}
+
+void BP_BoxTree::removeLeaf(int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+
+	int parent = m_nodes[leaf].m_parent;
+	int grand_parent = m_nodes[parent].m_parent;
+	int sibling = m_nodes[parent].m_child1 == leaf ? 
+		m_nodes[parent].m_child2 : m_nodes[parent].m_child1;
+
+	m_nodes[sibling].m_parent = grand_parent;
+	if (grand_parent == -1)
+	{
+		m_root = sibling;
+	}
+	else
+	{
+		if (m_nodes[grand_parent].m_child1 == parent)
+		{
+			m_nodes[grand_parent].m_child1 = sibling;
+		}
+		else
+		{
+			m_nodes[grand_parent].m_child2 = sibling;
+		}
+	}
+	freeNode(parent);
+
+	refit(grand_parent);
+}
+
+// Walks up from 'index' to the root, restoring the boxes and heights and 
+// rebalancing on the way.
+
+void BP_BoxTree::refit(int index)
+{
+	while (index != -1)
+	{
+		index = balance(index);
+
+		BP_BoxNode& node = m_nodes[index];
+		const BP_BoxNode& child1 = m_nodes[node.m_child1];
+		const BP_BoxNode& child2 = m_nodes[node.m_child2];
+
+		node.m_height = 1 + GEN_max(child1.m_height, child2.m_height);
+		combine(node, child1, child2);
+
+		index = node.m_parent;
+	}
+}
+
+// Performs a left or right rotation if node A is imbalanced, and returns 
+// the index of the node that takes the place of A.
+
+int BP_BoxTree::balance(int iA)
+{
+	BP_BoxNode& A = m_nodes[iA];
+	if (A.isLeaf() || A.m_height < 2)
+	{
+		return iA;
+	}
+
+	int iB = A.m_child1;
+	int iC = A.m_child2;
+	BP_BoxNode& B = m_nodes[iB];
+	BP_BoxNode& C = m_nodes[iC];
+
+	int balance = C.m_height - B.m_height;
+
+	if (balance > 1)
+	{
+		// Rotate C up
+		int iF = C.m_child1;
+		int iG = C.m_child2;
+		BP_BoxNode& F = m_nodes[iF];
+		BP_BoxNode& G = m_nodes[iG];
+
+		C.m_child1 = iA;
+		C.m_parent = A.m_parent;
+		A.m_parent = iC;
+
+		if (C.m_parent == -1)
+		{
+			m_root = iC;
+		}
+		else if (m_nodes[C.m_parent].m_child1 == iA)
+		{
+			m_nodes[C.m_parent].m_child1 = iC;
+		}
+		else
+		{
+			m_nodes[C.m_parent].m_child2 = iC;
+		}
+
+		if (F.m_height > G.m_height)
+		{
+			C.m_child2 = iF;
+			A.m_child2 = iG;
+			G.m_parent = iA;
+			combine(A, B, G);
+			combine(C, A, F);
+			A.m_height = 1 + GEN_max(B.m_height, G.m_height);
+			C.m_height = 1 + GEN_max(A.m_height, F.m_height);
+		}
+		else
+		{
+			C.m_child2 = iG;
+			A.m_child2 = iF;
+			F.m_parent = iA;
+			combine(A, B, F);
+			combine(C, A, G);
+			A.m_height = 1 + GEN_max(B.m_height, F.m_height);
+			C.m_height = 1 + GEN_max(A.m_height, G.m_height);
+		}
+
+		return iC;
+	}
+	
+	if (balance < -1)
+	{
+		// Rotate B up
+		int iD = B.m_child1;
+		int iE = B.m_child2;
+		BP_BoxNode& D = m_nodes[iD];
+		BP_BoxNode& E = m_nodes[iE];
+
+		B.m_child1 = iA;
+		B.m_parent = A.m_parent;
+		A.m_parent = iB;
+
+		if (B.m_parent == -1)
+		{
+			m_root = iB;
+		}
+		else if (m_nodes[B.m_parent].m_child1 == iA)
+		{
+			m_nodes[B.m_parent].m_child1 = iB;
+		}
+		else
+		{
+			m_nodes[B.m_parent].m_child2 = iB;
+		}
+
+		if (D.m_height > E.m_height)
+		{
+			B.m_child2 = iD;
+			A.m_child1 = iE;
+			E.m_parent = iA;
+			combine(A, C, E);
+			combine(B, A, D);
+			A.m_height = 1 + GEN_max(C.m_height, E.m_height);
+			B.m_height = 1 + GEN_max(A.m_height, D.m_height);
+		}
+		else
+		{
+			B.m_child2 = iE;
+			A.m_child1 = iD;
+			D.m_parent = iA;
+			combine(A, C, D);
+			combine(B, A, E);
+			A.m_height = 1 + GEN_max(C.m_height, D.m_height);
+			B.m_height = 1 + GEN_max(A.m_height, E.m_height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
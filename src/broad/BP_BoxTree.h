@@ -0,0 +1,88 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_BOXTREE_H
+#define BP_BOXTREE_H
+
+#include <vector>
+
+#include "SOLID_broad.h"
+#include "BP_Proxy.h"
+
+class BP_BoxNode {
+public:
+	bool isLeaf() const { return m_child1 == -1; }
+
+	DT_Vector3    m_min;
+	DT_Vector3    m_max;
+	int           m_parent;     // Next free node for nodes on the free list
+	int           m_child1;
+	int           m_child2;
+	int           m_height;     // Leaves have height 0, free nodes -1 
+	BP_Proxy     *m_proxy;
+};
+
+// Bounding volume tree over the boxes of a set of proxies. Leaves are 
+// inserted next to the node that increases the surface area of the tree 
+// the least, and the tree is kept balanced by rotations as leaves are 
+// inserted and removed. Leaves are referred to by index. 
+
+class BP_BoxTree {
+public:
+	typedef std::vector<BP_Proxy *> T_ProxyList;
+
+	BP_BoxTree() : m_root(-1), m_freeList(-1) {}
+
+	int  createLeaf(BP_Proxy *proxy, const DT_Vector3 min, const DT_Vector3 max);
+	void destroyLeaf(int leaf);
+	void moveLeaf(int leaf, const DT_Vector3 min, const DT_Vector3 max);
+
+	bool empty() const { return m_root == -1; }
+	bool contains(int leaf, const DT_Vector3 min, const DT_Vector3 max) const;
+
+	// Appends the proxies of the leaves whose boxes overlap the given box. 
+	// Unlike 'rayCast', this uses scratch storage of the tree.
+	void query(const DT_Vector3 min, const DT_Vector3 max, T_ProxyList& result);
+
+	BP_Proxy *rayCast(BP_RayCastCallback objectRayCast,
+					  void *client_data,
+					  const DT_Vector3 source, 
+					  const DT_Vector3 target, 
+					  DT_Scalar& lambda) const;
+
+private:
+	int  allocateNode();
+	void freeNode(int index);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	int  balance(int index);
+	void refit(int index);
+
+	std::vector<BP_BoxNode>  m_nodes;
+	int                      m_root;
+	int                      m_freeList;
+	std::vector<int>         m_stack;
+};
+
+#endif
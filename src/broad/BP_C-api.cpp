@@ -23,16 +23,45 @@
 
 #include "SOLID_broad.h"
 
-#include "BP_Scene.h"
-#include "BP_Proxy.h"
+#include "BP_SAPScene.h"
+#include "BP_GridScene.h"
+#include "BP_MultiSAPScene.h"
+#include "BP_TreeScene.h"
 
 BP_SceneHandle BP_CreateScene(void *client_data,
 							  BP_Callback beginOverlap,
 							  BP_Callback endOverlap)
 {
-	return (BP_SceneHandle)new BP_Scene(client_data, 
-										beginOverlap, 
-										endOverlap);
+	return (BP_SceneHandle)static_cast<BP_Scene *>(new BP_SAPScene(client_data, 
+																   beginOverlap, 
+																   endOverlap));
+}
+
+BP_SceneHandle BP_CreateSceneOfType(DT_BroadphaseType type,
+									DT_Scalar param,
+									void *client_data,
+									BP_Callback beginOverlap,
+									BP_Callback endOverlap)
+{
+	BP_Scene *scene = 0;
+	switch (type)
+	{
+	case DT_SWEEP_AND_PRUNE:
+		scene = new BP_SAPScene(client_data, beginOverlap, endOverlap);
+		break;
+	case DT_DYNAMIC_TREE:
+		scene = new BP_TreeScene(client_data, beginOverlap, endOverlap, param);
+		break;
+	case DT_HASHED_GRID:
+		scene = new BP_GridScene(client_data, beginOverlap, endOverlap, param);
+		break;
+	case DT_MULTI_SWEEP_AND_PRUNE:
+		scene = new BP_MultiSAPScene(client_data, beginOverlap, endOverlap, param);
+		break;
+	default:
+		assert(false);
+	}
+	return (BP_SceneHandle)scene;
 }
 
  
@@ -57,11 +86,38 @@ void BP_DestroyProxy(BP_SceneHandle scene, BP_ProxyHandle proxy)
 
 
 
+void BP_CreateProxies(BP_SceneHandle scene, DT_Size count, void *const *objects,
+					  const DT_Vector3 *min, const DT_Vector3 *max, 
+					  DT_ProxyMode mode, BP_ProxyHandle *proxies)
+{
+	((BP_Scene *)scene)->createProxies(count, objects, min, max, mode, (BP_Proxy **)proxies);
+}
+
+void BP_DestroyProxies(BP_SceneHandle scene, DT_Size count, const BP_ProxyHandle *proxies) 
+{
+	((BP_Scene *)scene)->destroyProxies(count, (BP_Proxy *const *)proxies);
+}
+
 void BP_SetBBox(BP_ProxyHandle proxy, const DT_Vector3 min, const DT_Vector3 max)	
 {
 	((BP_Proxy *)proxy)->setBBox(min, max);
 }
 
+void BP_SetProxyMode(BP_ProxyHandle proxy, DT_ProxyMode mode)
+{
+	((BP_Proxy *)proxy)->setMode(mode);
+}
+
+void BP_BeginUpdate(BP_SceneHandle scene)
+{
+	((BP_Scene *)scene)->beginUpdate();
+}
+
+void BP_CommitUpdate(BP_SceneHandle scene)
+{
+	((BP_Scene *)scene)->commitUpdate();
+}
+
 void *BP_RayCast(BP_SceneHandle scene, 
 				 BP_RayCastCallback objectRayCast,
 				 void *client_data,
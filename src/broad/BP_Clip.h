@@ -0,0 +1,69 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_CLIP_H
+#define BP_CLIP_H
+
+#include <algorithm>
+
+#include "GEN_MinMax.h"
+#include "SOLID_types.h"
+
+// Clips the segment source + t * delta, 0 <= t <= lambda, against the box
+
+inline bool BP_clip(const DT_Vector3 min, const DT_Vector3 max, 
+				    const DT_Vector3 source, const DT_Vector3 delta, 
+				    DT_Scalar lambda)
+{
+	DT_Scalar lambda_enter = DT_Scalar(0.0);
+	DT_Scalar lambda_exit = lambda;
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		if (delta[i] == DT_Scalar(0.0))
+		{
+			if (source[i] < min[i] || max[i] < source[i])
+			{
+				return false;
+			}
+		}
+		else 
+		{
+			DT_Scalar t0 = (min[i] - source[i]) / delta[i];
+			DT_Scalar t1 = (max[i] - source[i]) / delta[i];
+			if (t1 < t0)
+			{
+				std::swap(t0, t1);
+			}
+			lambda_enter = GEN_max(lambda_enter, t0);
+			lambda_exit = GEN_min(lambda_exit, t1);
+			if (lambda_exit < lambda_enter)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
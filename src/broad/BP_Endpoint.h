@@ -26,75 +26,59 @@
 
 #include "SOLID_types.h"
 
-class BP_Proxy;
+typedef unsigned int Uint32;
 
-class BP_Link {
-public:
-	BP_Link() {}
-	explicit BP_Link(BP_Proxy *proxy) :
-		m_proxy(proxy)
-	{}
-
-	DT_Index  m_index;
-	DT_Count  m_count;
-	BP_Proxy *m_proxy;
-};
+// Maps a position to an unsigned integer key that has the same order, so 
+// that endpoints can be compared as integers and sorted by radix. Note that
+// the broad phase works on DT_Scalar, which is a float also in builds that
+// use doubles for MT_Scalar. Both zeros get the key of +0, as they compare 
+// equal as floats.
 
-typedef unsigned int Uint32;
+inline Uint32 BP_encode(DT_Scalar pos)
+{
+	union {
+		DT_Scalar  m_pos;
+		Uint32     m_bits;
+	} u;
+	u.m_pos = pos;
+	if ((u.m_bits & 0x7fffffff) == 0)
+	{
+		u.m_bits = 0;
+	}
+	return (u.m_bits & 0x80000000) ? ~u.m_bits : (u.m_bits | 0x80000000);
+}
+
+inline DT_Scalar BP_decode(Uint32 key)
+{
+	union {
+		DT_Scalar  m_pos;
+		Uint32     m_bits;
+	} u;
+	u.m_bits = (key & 0x80000000) ? (key & 0x7fffffff) : ~key;
+	return u.m_pos;
+}
+
+// An endpoint is stored as the key of its position, with the type in the 
+// lowest bit. Minima round down and maxima round up, so that touching 
+// intervals always overlap.
 
 class BP_Endpoint {
 public:
     enum { 
 		MINIMUM = 0x00000000, 
-		MAXIMUM = 0x80000000,	
+		MAXIMUM = 0x00000001,	
 		TYPEBIT = 0x00000001
 	};
 
-    BP_Endpoint() {}
-    BP_Endpoint(DT_Scalar pos, Uint32 type, BP_Link *link) 
-	  :	m_link(link)
-	{
-		setPos(pos, type);
-	}
- 
-	DT_Scalar getPos()   const { return m_pos; }
-	DT_Index&   getIndex() const { return m_link->m_index; }
-	DT_Count&   getCount() const { return m_link->m_count; }
-	BP_Proxy *getProxy() const { return m_link->m_proxy; }
-	
-	DT_Index   getEndIndex()   const { return (m_link + 1)->m_index; }
-	
-	Uint32 getType() const 
-	{ 
-		return (m_bits & TYPEBIT) ? (~m_bits & MAXIMUM) : (m_bits & MAXIMUM);
-	}
-
-	void setPos(DT_Scalar pos, Uint32 type) 
+	static Uint32 makeKey(DT_Scalar pos, Uint32 type) 
 	{
-		m_pos = pos; 
-		if ((m_bits & MAXIMUM) == type) 
-		{
-			m_bits &= ~TYPEBIT;
-		}
-		else 
-		{
-			m_bits |= TYPEBIT;
-		}
+		return (BP_encode(pos) & ~Uint32(TYPEBIT)) | type;
 	}
 
-private:
-	union {
-		DT_Scalar    m_pos;
-		Uint32       m_bits;
-	};
-	BP_Link        *m_link;
+	static Uint32    getType(Uint32 key) { return key & TYPEBIT; }
+	static DT_Scalar getPos(Uint32 key)  { return BP_decode(key); }
 };
 
-inline bool operator<(const BP_Endpoint& a, const BP_Endpoint& b) 
-{
-    return a.getPos() < b.getPos(); 
-}
-
 #endif
 
 
@@ -25,25 +25,24 @@
 #include <algorithm>
 
 #include "BP_EndpointList.h"
-#include "BP_Scene.h"
-#include "BP_Proxy.h"
+#include "BP_SAPScene.h"
+#include "BP_SAPProxy.h"
 #include "BP_ProxyList.h"
 
-DT_Index BP_EndpointList::stab(const BP_Endpoint& pos, BP_ProxyList& proxies) const 
+DT_Index BP_EndpointList::stab(Uint32 key, BP_ProxyList& proxies) const 
 {
-	DT_Index result = std::upper_bound(begin(), end(), pos) - begin();
+	DT_Index result = std::upper_bound(m_keys.begin(), m_keys.end(), key) - m_keys.begin();
 	
 	if (result != 0) 
 	{
 		DT_Index i = result - 1;
-		DT_Count count = (*this)[i].getCount(); 
+		DT_Count count = m_counts[i]; 
 		while (count) 
 		{
-			const BP_Endpoint& endpoint = (*this)[i];
-			if (endpoint.getType() == BP_Endpoint::MINIMUM &&
-				pos < (*this)[endpoint.getEndIndex()]) 
+			if (getType(i) == BP_Endpoint::MINIMUM &&
+				key < m_proxies[i]->getMax(m_axis)) 
 			{
-				proxies.add(endpoint.getProxy());
+				proxies.add(m_proxies[i]);
 				--count;
 			}
 			assert(i != 0 || count == 0);
@@ -63,14 +62,14 @@ DT_Scalar BP_EndpointList::nextLambda(DT_Index& index,
 		{
 			if (index != 0) 
 			{
-				return ((*this)[--index].getPos() - source) / delta;
+				return (getPos(--index) - source) / delta;
 			}
 		}
 		else 
 		{
 			if (index != size()) 
 			{
-				return ((*this)[index++].getPos() - source) / delta;
+				return (getPos(index++) - source) / delta;
 			}
 		}
 	}
@@ -78,160 +77,405 @@ DT_Scalar BP_EndpointList::nextLambda(DT_Index& index,
 }
 
 
-void BP_EndpointList::range(const BP_Endpoint& min, 
-							const BP_Endpoint& max,
+void BP_EndpointList::range(Uint32 min, Uint32 max,
 							DT_Index& first, DT_Index& last,
 							BP_ProxyList& proxies) const 
 {
 	first = stab(min, proxies);
-	last  = std::upper_bound(begin(), end(), max) - begin();
+	last  = std::upper_bound(m_keys.begin(), m_keys.end(), max) - m_keys.begin();
 	
 	DT_Index i;
 	for (i = first; i != last; ++i) 
 	{
-		const BP_Endpoint& endpoint = (*this)[i];
-		if (endpoint.getType() == BP_Endpoint::MINIMUM) 
+		if (getType(i) == BP_Endpoint::MINIMUM) 
 		{
-			proxies.add(endpoint.getProxy());
+			proxies.add(m_proxies[i]);
 		}
 	}
 }
 
-void BP_EndpointList::addInterval(const BP_Endpoint& min, 
-								  const BP_Endpoint& max,
-								  BP_ProxyList& proxies) 
+void BP_EndpointList::addInterval(BP_SAPProxy *proxy, BP_ProxyList& proxies) 
 {
 	assert(invariant());
+
+	Uint32 min = proxy->getMin(m_axis);
+	Uint32 max = proxy->getMax(m_axis);
+
 	DT_Index first, last;
 	range(min, max, first, last, proxies);
-	insert(begin() + last, max);
-	insert(begin() + first, min);
+	m_keys.insert(m_keys.begin() + last, max);
+	m_proxies.insert(m_proxies.begin() + last, proxy);
+	m_counts.insert(m_counts.begin() + last, DT_Count(0));
+	m_keys.insert(m_keys.begin() + first, min);
+	m_proxies.insert(m_proxies.begin() + first, proxy);
+	m_counts.insert(m_counts.begin() + first, DT_Count(0));
 	++last; 
 	
-	(*this)[first].getCount() = first != 0 ? (*this)[first - 1].getCount() : 0;
-	(*this)[last].getCount() = (*this)[last - 1].getCount();
-	
+	m_counts[first] = first != 0 ? m_counts[first - 1] : 0;
+	m_counts[last] = m_counts[last - 1];
 	
 	DT_Index i;
 	for (i = first; i != last; ++i) 
 	{
-		++(*this)[i].getCount();
-		(*this)[i].getIndex() = i;
+		++m_counts[i];
+		setIndex(i);
 	} 
 	for (; i != size(); ++i) 
 	{
-		(*this)[i].getIndex() = i;
+		setIndex(i);
 	} 
 	
 	assert(invariant());
 }
 
-void BP_EndpointList::removeInterval(DT_Index first, DT_Index last,
-									 BP_ProxyList& proxies) 
+void BP_EndpointList::removeInterval(BP_SAPProxy *proxy, BP_ProxyList& proxies) 
 { 
 	assert(invariant());
 	
-	BP_Endpoint min = (*this)[first];
-	BP_Endpoint max = (*this)[last]; 
+	DT_Index first = proxy->getIndex(m_axis, BP_Endpoint::MINIMUM);
+	DT_Index last = proxy->getIndex(m_axis, BP_Endpoint::MAXIMUM);
 	
-	erase(begin() + last);
-	erase(begin() + first);
+	m_keys.erase(m_keys.begin() + last);
+	m_proxies.erase(m_proxies.begin() + last);
+	m_counts.erase(m_counts.begin() + last);
+	m_keys.erase(m_keys.begin() + first);
+	m_proxies.erase(m_proxies.begin() + first);
+	m_counts.erase(m_counts.begin() + first);
 	--last;
 	
 	DT_Index i;
 	for (i = first; i != last; ++i) 
 	{
-		--(*this)[i].getCount();
-		(*this)[i].getIndex() = i;
+		--m_counts[i];
+		setIndex(i);
 	} 
 	for (; i != size(); ++i) 
 	{
-		(*this)[i].getIndex() = i;
+		setIndex(i);
 	} 
 	
-	range(min, max, first, last, proxies);
+	range(proxy->getMin(m_axis), proxy->getMax(m_axis), first, last, proxies);
 	
 	assert(invariant());
 }
 
-void BP_EndpointList::move(DT_Index index, DT_Scalar pos, Uint32 type,  
-						   BP_Scene& scene, T_Overlap overlap)
+void BP_EndpointList::addIntervals(const std::vector<BP_SAPProxy *>& proxies)
+{
+	assert(invariant());
+
+	if (proxies.empty())
+	{
+		return;
+	}
+
+	std::vector<std::pair<Uint32, BP_SAPProxy *> > endpoints;
+	endpoints.reserve(2 * proxies.size());
+
+	std::vector<BP_SAPProxy *>::const_iterator it;
+	for (it = proxies.begin(); it != proxies.end(); ++it)
+	{
+		endpoints.push_back(std::make_pair((*it)->getMin(m_axis), *it));
+		endpoints.push_back(std::make_pair((*it)->getMax(m_axis), *it));
+	}
+
+	std::sort(endpoints.begin(), endpoints.end());
+
+	// Merge from the back, so that every endpoint is moved at most once
+	DT_Index i = size();
+	DT_Index j = DT_Index(endpoints.size());
+	DT_Index k = i + j;
+
+	m_keys.resize(k);
+	m_proxies.resize(k);
+	m_counts.resize(k);
+
+	while (j != 0)
+	{
+		--k;
+		if (i != 0 && endpoints[j - 1].first < m_keys[i - 1])
+		{
+			--i;
+			m_keys[k] = m_keys[i];
+			m_proxies[k] = m_proxies[i];
+		}
+		else 
+		{
+			--j;
+			m_keys[k] = endpoints[j].first;
+			m_proxies[k] = endpoints[j].second;
+		}
+	}
+
+	updateCounts(k);
+}
+
+void BP_EndpointList::removeIntervals(const std::vector<BP_SAPProxy *>& proxies)
+{
+	assert(invariant());
+
+	if (proxies.empty())
+	{
+		return;
+	}
+
+	std::vector<DT_Index> indices;
+	indices.reserve(2 * proxies.size());
+
+	std::vector<BP_SAPProxy *>::const_iterator it;
+	for (it = proxies.begin(); it != proxies.end(); ++it)
+	{
+		indices.push_back((*it)->getIndex(m_axis, BP_Endpoint::MINIMUM));
+		indices.push_back((*it)->getIndex(m_axis, BP_Endpoint::MAXIMUM));
+	}
+
+	std::sort(indices.begin(), indices.end());
+
+	DT_Index first = indices.front();
+	DT_Index k = first;
+	DT_Index j = 0;
+	DT_Index i;
+	for (i = first; i != size(); ++i)
+	{
+		if (j != indices.size() && indices[j] == i)
+		{
+			++j;
+		}
+		else
+		{
+			m_keys[k] = m_keys[i];
+			m_proxies[k] = m_proxies[i];
+			++k;
+		}
+	}
+
+	m_keys.resize(k);
+	m_proxies.resize(k);
+	m_counts.resize(k);
+
+	updateCounts(first);
+}
+
+// Recomputes the counts and indices of the endpoints from 'first' on
+
+void BP_EndpointList::updateCounts(DT_Index first)
+{
+	DT_Count count = first != 0 ? m_counts[first - 1] : 0;
+	DT_Index i;
+	for (i = first; i != size(); ++i) 
+	{
+		if (getType(i) == BP_Endpoint::MINIMUM) 
+		{
+			++count;
+		}
+		else 
+		{
+			--count;
+		}
+		m_counts[i] = count;
+		setIndex(i);
+	}
+
+	assert(invariant());
+}
+
+void BP_EndpointList::move(DT_Index index, Uint32 key,  
+						   BP_SAPScene& scene, T_Overlap overlap)
 {
 	assert(invariant());
 	
-	BP_Endpoint endpoint = (*this)[index];
-    DT_Scalar delta = pos - endpoint.getPos();
-	
-    if (delta != DT_Scalar(0.0)) 
+	if (key != m_keys[index]) 
 	{
-		endpoint.setPos(pos, type);
-		if (delta < DT_Scalar(0.0)) 
+		BP_SAPProxy *proxy = m_proxies[index];
+		DT_Count count = m_counts[index];
+
+		if (key < m_keys[index]) 
 		{
-			while (index != 0 && endpoint < (*this)[index - 1]) 
+			while (index != 0 && key < m_keys[index - 1]) 
 			{
-				(*this)[index] = (*this)[index - 1];
-				(*this)[index].getIndex() = index;
-				encounters((*this)[index], endpoint, scene, overlap);
+				encounters(m_keys[index - 1], m_proxies[index - 1], m_counts[index - 1], 
+						   key, proxy, count, scene, overlap);
+				assign(index, m_keys[index - 1], m_proxies[index - 1], m_counts[index - 1]);
 				--index;
 			}
 		}
 		else 
 		{
 			DT_Index last = size() - 1;
-			while (index != last && (*this)[index + 1] < endpoint) 
+			while (index != last && m_keys[index + 1] < key) 
 			{
-				(*this)[index] = (*this)[index + 1];
-				(*this)[index].getIndex() = index;
-				encounters(endpoint, (*this)[index], scene, overlap);
+				encounters(key, proxy, count, 
+						   m_keys[index + 1], m_proxies[index + 1], m_counts[index + 1], 
+						   scene, overlap);
+				assign(index, m_keys[index + 1], m_proxies[index + 1], m_counts[index + 1]);
 				++index;
 			}
 		}
-		(*this)[index] = endpoint;
-		(*this)[index].getIndex() = index;
+		assign(index, key, proxy, count);
+		proxy->setKey(m_axis, key);
     }
 
 	assert(invariant());
 }
 
-void BP_EndpointList::encounters(const BP_Endpoint& a, const BP_Endpoint& b,
-								 BP_Scene& scene, T_Overlap overlap)
+void BP_EndpointList::sort(BP_ProxyPairList& pairs, T_Overlap overlap)
+{
+	DT_Index i;
+	for (i = 1; i < size(); ++i) 
+	{
+		if (m_keys[i] < m_keys[i - 1]) 
+		{
+			Uint32 key = m_keys[i];
+			Uint32 type = BP_Endpoint::getType(key);
+			BP_SAPProxy *proxy = m_proxies[i];
+			DT_Count count = m_counts[i];
+			DT_Index index = i;
+			do
+			{
+				Uint32 prev = getType(index - 1);
+				
+				// Same bookkeeping as for 'encounters', only the overlap 
+				// status is resolved by the caller once all axes are sorted.
+				if (prev != type)
+				{
+					if (overlap(*m_proxies[index - 1], *proxy))
+					{
+						pairs.push_back(BP_makePair(m_proxies[index - 1], proxy));
+					}
+					if (prev == BP_Endpoint::MAXIMUM) 
+					{
+						++m_counts[index - 1];
+						++count;
+					}
+					else
+					{
+						--m_counts[index - 1];
+						--count;
+					}
+				}
+				else if (prev == BP_Endpoint::MAXIMUM) 
+				{
+					--m_counts[index - 1];
+					++count;
+				}
+				else 
+				{
+					++m_counts[index - 1];
+					--count;
+				}
+
+				assign(index, m_keys[index - 1], m_proxies[index - 1], m_counts[index - 1]);
+				--index;
+			}
+			while (index != 0 && key < m_keys[index - 1]);
+
+			assign(index, key, proxy, count);
+		}
+	}
+
+	assert(invariant());
+}
+
+void BP_EndpointList::rebuild()
+{
+	enum { RADIX_BITS = 11, RADIX_SIZE = 1 << RADIX_BITS, RADIX_MASK = RADIX_SIZE - 1 };
+
+	// Three passes of eleven bits cover the 32-bit keys. The counts for all 
+	// passes are gathered in a single sweep over the list.
+	DT_Index histogram[3][RADIX_SIZE];
+	std::fill(&histogram[0][0], &histogram[0][0] + 3 * RADIX_SIZE, 0);
+
+	DT_Index n = size();
+	DT_Index i;
+	for (i = 0; i != n; ++i) 
+	{
+		Uint32 key = m_keys[i];
+		++histogram[0][key & RADIX_MASK];
+		++histogram[1][(key >> RADIX_BITS) & RADIX_MASK];
+		++histogram[2][key >> (2 * RADIX_BITS)];
+	}
+
+	std::vector<Uint32> keys(n);
+	std::vector<BP_SAPProxy *> proxies(n);
+
+	int pass;
+	for (pass = 0; pass != 3; ++pass) 
+	{
+		int shift = pass * RADIX_BITS;
+		DT_Index *offset = histogram[pass];
+
+		// A pass in which all keys have the same digit changes nothing
+		if (n == 0 || offset[(m_keys[0] >> shift) & RADIX_MASK] == n)
+		{
+			continue;
+		}
+
+		DT_Index sum = 0;
+		int j;
+		for (j = 0; j != RADIX_SIZE; ++j) 
+		{
+			DT_Index count = offset[j];
+			offset[j] = sum;
+			sum += count;
+		}
+
+		for (i = 0; i != n; ++i) 
+		{
+			DT_Index k = offset[(m_keys[i] >> shift) & RADIX_MASK]++;
+			keys[k] = m_keys[i];
+			proxies[k] = m_proxies[i];
+		}
+
+		m_keys.swap(keys);
+		m_proxies.swap(proxies);
+	}
+
+	m_counts.resize(n);
+	updateCounts(0);
+}
+
+void BP_EndpointList::encounters(Uint32 a, BP_SAPProxy *proxy_a, DT_Count& count_a, 
+								 Uint32 b, BP_SAPProxy *proxy_b, DT_Count& count_b,
+								 BP_SAPScene& scene, T_Overlap overlap)
 {
-	assert(a.getProxy() != b.getProxy());
+	assert(proxy_a != proxy_b);
 	
-	if (a.getType() != b.getType()) 
+	Uint32 type_a = BP_Endpoint::getType(a);
+	Uint32 type_b = BP_Endpoint::getType(b);
+
+	if (type_a != type_b) 
 	{
-		if (a.getType() == BP_Endpoint::MAXIMUM) 
+		if (type_a == BP_Endpoint::MAXIMUM) 
 		{
-			if (overlap(*a.getProxy(), *b.getProxy())) 
+			if (overlap(*proxy_a, *proxy_b)) 
 			{
-				scene.callBeginOverlap(a.getProxy()->getObject(), 
-									   b.getProxy()->getObject());
+				scene.callBeginOverlap(proxy_a->getObject(), 
+									   proxy_b->getObject());
 			}
-			++a.getCount();
-			++b.getCount();
+			++count_a;
+			++count_b;
 		}
 		else 
 		{
-			if (overlap(*a.getProxy(), *b.getProxy())) 
+			if (overlap(*proxy_a, *proxy_b)) 
 			{
-				scene.callEndOverlap(a.getProxy()->getObject(), 
-									 b.getProxy()->getObject());
+				scene.callEndOverlap(proxy_a->getObject(), 
+									 proxy_b->getObject());
 			}
-			--a.getCount();
-			--b.getCount();
+			--count_a;
+			--count_b;
 		}
 	}
 	else 
 	{
-		if (a.getType() == BP_Endpoint::MAXIMUM) 
+		if (type_a == BP_Endpoint::MAXIMUM) 
 		{
-			--a.getCount();
-			++b.getCount();
+			--count_a;
+			++count_b;
 		}
 		else 
 		{
-			++a.getCount();
-			--b.getCount();
+			++count_a;
+			--count_b;
 		}
 	}
 }
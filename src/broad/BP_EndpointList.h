@@ -30,45 +30,90 @@
 
 #include "BP_Endpoint.h"
 #include "BP_ProxyList.h"
+#include "BP_SAPProxy.h"
 
-class BP_Scene;
+class BP_SAPScene;
 
-typedef bool (*T_Overlap)(const BP_Proxy& a, const BP_Proxy& b);
+typedef bool (*T_Overlap)(const BP_SAPProxy& a, const BP_SAPProxy& b);
 
-class BP_EndpointList : public std::vector<BP_Endpoint> {
+// The endpoints of the intervals on one axis, sorted by key. The keys, the 
+// proxies they belong to, and the number of intervals that contain each 
+// endpoint are stored in separate arrays, so that the sweeps only touch 
+// the keys as long as no endpoints are passed. 
+
+class BP_EndpointList {
 public:
-	BP_EndpointList() {}
+	BP_EndpointList() : m_axis(0) {}
+
+	void setAxis(int axis) { m_axis = axis; }
+
+	DT_Index     size()                const { return DT_Index(m_keys.size()); }
+	Uint32       getKey(DT_Index i)    const { return m_keys[i]; }
+	Uint32       getType(DT_Index i)   const { return BP_Endpoint::getType(m_keys[i]); }
+	DT_Scalar    getPos(DT_Index i)    const { return BP_Endpoint::getPos(m_keys[i]); }
+	BP_SAPProxy *getProxy(DT_Index i)  const { return m_proxies[i]; }
+	DT_Count     getCount(DT_Index i)  const { return m_counts[i]; }
 	
-	DT_Index stab(const BP_Endpoint& pos, BP_ProxyList& proxies) const;
+	DT_Index stab(Uint32 key, BP_ProxyList& proxies) const;
 	
 	DT_Index stab(DT_Scalar pos, BP_ProxyList& proxies) const
 	{
-		return stab(BP_Endpoint(pos, BP_Endpoint::MINIMUM, 0), proxies);
+		return stab(BP_Endpoint::makeKey(pos, BP_Endpoint::MINIMUM), proxies);
 	}
-	
 
-   void range(const BP_Endpoint& min, const BP_Endpoint& max, 
-			  DT_Index& first, DT_Index& last, BP_ProxyList& proxies) const;
+	void range(Uint32 min, Uint32 max, 
+			   DT_Index& first, DT_Index& last, BP_ProxyList& proxies) const;
 	
-	void range(DT_Scalar lb, DT_Scalar ub, DT_Index& first, DT_Index& last, BP_ProxyList& proxies) const 
+	// The interval is given by the keys stored in the proxy
+	void addInterval(BP_SAPProxy *proxy, BP_ProxyList& proxies);
+	void removeInterval(BP_SAPProxy *proxy, BP_ProxyList& proxies);
+
+	// Insert or remove the intervals of any number of proxies in a single 
+	// pass over the list. The new endpoints are sorted and merged into the 
+	// list. No overlaps are reported.
+	void addIntervals(const std::vector<BP_SAPProxy *>& proxies);
+	void removeIntervals(const std::vector<BP_SAPProxy *>& proxies);
+
+	void move(DT_Index index, Uint32 key, BP_SAPScene& scene, T_Overlap overlap);	
+
+	// Gives an endpoint a new key in place, leaving the list unsorted
+	void setKey(DT_Index index, Uint32 key)
 	{
-		range(BP_Endpoint(lb, BP_Endpoint::MINIMUM, 0), 
-			  BP_Endpoint(ub, BP_Endpoint::MAXIMUM, 0),
-			  first, last, proxies);
+		m_keys[index] = key;
+		m_proxies[index]->setKey(m_axis, key);
 	}
-	
-	void addInterval(const BP_Endpoint& min, const BP_Endpoint& max, BP_ProxyList& proxies);
-	void removeInterval(DT_Index first, DT_Index last, BP_ProxyList& proxies);
 
-	void move(DT_Index index, DT_Scalar pos, Uint32 type, BP_Scene& scene, T_Overlap overlap);	
+	// Restores the order after any number of endpoints have been given new 
+	// positions in place. The pairs of proxies whose intervals started or 
+	// stopped overlapping on this axis, and that pass 'overlap' on the other 
+	// axes, are appended to 'pairs'.
+	void sort(BP_ProxyPairList& pairs, T_Overlap overlap);
+
+	// Sorts the list from scratch by a radix sort on the endpoint keys, and 
+	// recomputes the indices and counts of all endpoints. 
+	void rebuild();
    
-   DT_Scalar nextLambda(DT_Index& index, DT_Scalar source, DT_Scalar target) const;
-	
+	DT_Scalar nextLambda(DT_Index& index, DT_Scalar source, DT_Scalar target) const;
 
 private:
-	void encounters(const BP_Endpoint& a, const BP_Endpoint& b,
-					    BP_Scene& scene, T_Overlap overlap);
+	void setIndex(DT_Index i) 
+	{
+		m_proxies[i]->setIndex(m_axis, getType(i), i);
+	}
 
+	void assign(DT_Index i, Uint32 key, BP_SAPProxy *proxy, DT_Count count)
+	{
+		m_keys[i] = key;
+		m_proxies[i] = proxy;
+		m_counts[i] = count;
+		proxy->setIndex(m_axis, BP_Endpoint::getType(key), i);
+	}
+
+	void updateCounts(DT_Index first);
+
+	void encounters(Uint32 a, BP_SAPProxy *proxy_a, DT_Count& count_a, 
+					Uint32 b, BP_SAPProxy *proxy_b, DT_Count& count_b,
+					BP_SAPScene& scene, T_Overlap overlap);
 
 #ifdef PARANOID
 	bool invariant() const 
@@ -77,9 +122,7 @@ private:
 		DT_Index i;
 		for (i = 0; i != size(); ++i) 
 		{
-         const BP_Endpoint& endpoint = (*this)[i];
-
-			if (endpoint.getType() == BP_Endpoint::MINIMUM) 
+			if (getType(i) == BP_Endpoint::MINIMUM) 
 			{
 				++count;
 			}
@@ -87,11 +130,20 @@ private:
 			{
 				--count;
 			}
-			if (endpoint.getCount() != count)
+			if (m_counts[i] != count)
+			{
+				return false;
+			}
+			if (m_proxies[i]->getIndex(m_axis, getType(i)) != i) 
+			{
+				return false;
+			}
+			if ((getType(i) == BP_Endpoint::MINIMUM ? m_proxies[i]->getMin(m_axis) : 
+				 m_proxies[i]->getMax(m_axis)) != m_keys[i])
 			{
 				return false;
 			}
-			if (endpoint.getIndex() != i) 
+			if (i != 0 && m_keys[i] < m_keys[i - 1])
 			{
 				return false;
 			}
@@ -102,8 +154,10 @@ private:
 	bool invariant() const { return true; }
 #endif
 
+	int                          m_axis;
+	std::vector<Uint32>          m_keys;
+	std::vector<BP_SAPProxy *>   m_proxies;
+	std::vector<DT_Count>        m_counts;
 };
 
-
-
 #endif
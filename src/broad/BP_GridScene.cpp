@@ -0,0 +1,483 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+#include "BP_GridScene.h"
+#include "BP_Clip.h"
+
+// Proxies that cover more cells than this are not stored in the grid
+static const double MAX_CELLS       = 64.0;
+
+// Cell coordinates are clamped so that they fit an int
+static const DT_Scalar CELL_LIMIT   = DT_Scalar(1 << 29);
+
+static const unsigned int MIN_BUCKETS = 256;
+
+BP_GridProxy::BP_GridProxy(void *object, BP_GridScene& scene, 
+						   const DT_Vector3 min, const DT_Vector3 max)
+  : BP_Proxy(object),
+	m_index(-1),
+	m_stamp(0),
+	m_deferred(false),
+	m_scene(scene)
+{
+	setBounds(min, max);
+}
+
+void BP_GridProxy::setBBox(const DT_Vector3 min, const DT_Vector3 max)
+{
+	m_scene.setBBox(this, min, max);
+}
+
+BP_GridScene::BP_GridScene(void *client_data,
+						   BP_Callback beginOverlap,
+						   BP_Callback endOverlap,
+						   DT_Scalar cellSize) 
+  :	BP_Scene(client_data, beginOverlap, endOverlap),
+	m_cellSize(cellSize),
+	m_invCellSize(DT_Scalar(1.0) / cellSize),
+	m_buckets(MIN_BUCKETS),
+	m_mask(MIN_BUCKETS - 1),
+	m_stamp(0),
+	m_updating(false)
+{
+	assert(cellSize > DT_Scalar(0.0));
+}
+
+int BP_GridScene::cellOf(DT_Scalar x) const
+{
+	DT_Scalar c = floor(x * m_invCellSize);
+	return c < -CELL_LIMIT ? -int(CELL_LIMIT) : 
+		   c > CELL_LIMIT ? int(CELL_LIMIT) : 
+		   int(c);
+}
+
+unsigned int BP_GridScene::bucketOf(int x, int y, int z) const
+{
+	return ((unsigned int)x * 73856093u ^ 
+			(unsigned int)y * 19349663u ^ 
+			(unsigned int)z * 83492791u) & m_mask;
+}
+
+void BP_GridScene::computeCells(const DT_Vector3 min, const DT_Vector3 max, 
+								int lo[3], int hi[3]) const
+{
+	double count = 1.0;
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		lo[i] = cellOf(min[i]);
+		hi[i] = cellOf(max[i]);
+		count *= double(hi[i] - lo[i]) + 1.0;
+	}
+
+	if (!(count <= MAX_CELLS))
+	{
+		lo[0] = 1;
+		hi[0] = 0;
+	}
+}
+
+void BP_GridScene::insertCells(BP_GridProxy *proxy)
+{
+	if (proxy->isLarge())
+	{
+		m_large.push_back(proxy);
+		return;
+	}
+
+	int x, y, z;
+	for (x = proxy->m_lo[0]; x <= proxy->m_hi[0]; ++x)
+	{
+		for (y = proxy->m_lo[1]; y <= proxy->m_hi[1]; ++y)
+		{
+			for (z = proxy->m_lo[2]; z <= proxy->m_hi[2]; ++z)
+			{
+				m_buckets[bucketOf(x, y, z)].push_back(proxy);
+			}
+		}
+	}
+}
+
+void BP_GridScene::removeCells(BP_GridProxy *proxy)
+{
+	if (proxy->isLarge())
+	{
+		m_large.erase(std::find(m_large.begin(), m_large.end(), proxy));
+		return;
+	}
+
+	// A proxy occurs in a bucket once for each of its cells that hash to it
+	int x, y, z;
+	for (x = proxy->m_lo[0]; x <= proxy->m_hi[0]; ++x)
+	{
+		for (y = proxy->m_lo[1]; y <= proxy->m_hi[1]; ++y)
+		{
+			for (z = proxy->m_lo[2]; z <= proxy->m_hi[2]; ++z)
+			{
+				BP_GridProxy::T_ProxyList& bucket = m_buckets[bucketOf(x, y, z)];
+				BP_GridProxy::T_ProxyList::iterator it = std::find(bucket.begin(), bucket.end(), proxy);
+				assert(it != bucket.end());
+				*it = bucket.back();
+				bucket.pop_back();
+			}
+		}
+	}
+}
+
+void BP_GridScene::rehash()
+{
+	T_BucketList::iterator bt;
+	for (bt = m_buckets.begin(); bt != m_buckets.end(); ++bt)
+	{
+		(*bt).clear();
+	}
+	m_buckets.resize(m_buckets.size() * 2);
+	m_mask = (unsigned int)m_buckets.size() - 1;
+
+	BP_GridProxy::T_ProxyList::iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+	{
+		if (!(*it)->isLarge())
+		{
+			insertCells(*it);
+		}
+	}
+}
+
+BP_GridProxy *BP_GridScene::createProxy(void *object, 
+										const DT_Vector3 min,
+										const DT_Vector3 max)
+{
+	BP_GridProxy *proxy = new BP_GridProxy(object, *this, min, max);
+
+	proxy->m_index = int(m_proxies.size());
+	m_proxies.push_back(proxy);
+
+	computeCells(min, max, proxy->m_lo, proxy->m_hi);
+	insertCells(proxy);
+
+	if (m_proxies.size() > m_buckets.size())
+	{
+		rehash();
+	}
+
+	updatePairs(proxy);
+
+	return proxy;
+}
+
+void BP_GridScene::destroyProxy(BP_Proxy *p)
+{
+	BP_GridProxy *proxy = static_cast<BP_GridProxy *>(p);
+
+	if (proxy->m_deferred)
+	{
+		m_deferred.erase(std::find(m_deferred.begin(), m_deferred.end(), proxy));
+	}
+
+	BP_GridProxy::T_ProxyList::iterator it;
+	for (it = proxy->m_overlaps.begin(); it != proxy->m_overlaps.end(); ++it)
+	{
+		BP_GridProxy::T_ProxyList& overlaps = (*it)->m_overlaps;
+		overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+		callEndOverlap(proxy->getObject(), (*it)->getObject());
+	}
+
+	removeCells(proxy);
+
+	m_proxies[proxy->m_index] = m_proxies.back();
+	m_proxies[proxy->m_index]->m_index = proxy->m_index;
+	m_proxies.pop_back();
+
+	delete proxy;
+}
+
+void BP_GridScene::setBBox(BP_GridProxy *proxy, const DT_Vector3 min, const DT_Vector3 max)
+{
+	proxy->setBounds(min, max);
+
+	if (m_updating)
+	{
+		if (!proxy->m_deferred)
+		{
+			proxy->m_deferred = true;
+			m_deferred.push_back(proxy);
+		}
+	}
+	else 
+	{
+		moveCells(proxy);
+		updatePairs(proxy);
+	}
+}
+
+void BP_GridScene::beginUpdate()
+{
+	assert(!m_updating);
+	m_updating = true;
+}
+
+void BP_GridScene::commitUpdate()
+{
+	assert(m_updating);
+	m_updating = false;
+
+	std::vector<BP_GridProxy *>::iterator it;
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		moveCells(*it);
+	}
+
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		(*it)->m_deferred = false;
+		updatePairs(*it);
+	}
+
+	m_deferred.clear();
+}
+
+void BP_GridScene::moveCells(BP_GridProxy *proxy)
+{
+	int lo[3], hi[3];
+	computeCells(proxy->m_min, proxy->m_max, lo, hi);
+
+	if (lo[0] == proxy->m_lo[0] && hi[0] == proxy->m_hi[0] &&
+		lo[1] == proxy->m_lo[1] && hi[1] == proxy->m_hi[1] &&
+		lo[2] == proxy->m_lo[2] && hi[2] == proxy->m_hi[2])
+	{
+		return;
+	}
+
+	removeCells(proxy);
+
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		proxy->m_lo[i] = lo[i];
+		proxy->m_hi[i] = hi[i];
+	}
+
+	insertCells(proxy);
+}
+
+void BP_GridScene::updatePairs(BP_GridProxy *proxy)
+{
+	query(proxy, m_overlaps);
+	std::sort(m_overlaps.begin(), m_overlaps.end());
+	
+	BP_GridProxy::T_ProxyList& prev = proxy->m_overlaps;
+
+	// Merge the sorted lists of old and new overlaps
+	BP_GridProxy::T_ProxyList::iterator it = prev.begin();
+	BP_GridProxy::T_ProxyList::iterator jt = m_overlaps.begin();
+	while (it != prev.end() || jt != m_overlaps.end())
+	{
+		if (jt == m_overlaps.end() || (it != prev.end() && *it < *jt))
+		{
+			BP_GridProxy::T_ProxyList& overlaps = (*it)->m_overlaps;
+			overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+			callEndOverlap(proxy->getObject(), (*it)->getObject());
+			++it;
+		}
+		else if (it == prev.end() || *jt < *it)
+		{
+			BP_GridProxy::T_ProxyList& overlaps = (*jt)->m_overlaps;
+			overlaps.insert(std::lower_bound(overlaps.begin(), overlaps.end(), proxy), proxy);
+			callBeginOverlap(proxy->getObject(), (*jt)->getObject());
+			++jt;
+		}
+		else
+		{
+			++it;
+			++jt;
+		}
+	}
+
+	prev.swap(m_overlaps);
+	m_overlaps.clear();
+}
+
+unsigned int BP_GridScene::nextStamp()
+{
+	if (++m_stamp == 0)
+	{
+		BP_GridProxy::T_ProxyList::const_iterator it;
+		for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+		{
+			(*it)->m_stamp = 0;
+		}
+		m_stamp = 1;
+	}
+	return m_stamp;
+}
+
+inline void collect(const BP_GridProxy::T_ProxyList& proxies, 
+					const BP_GridProxy *proxy, unsigned int stamp,
+					BP_GridProxy::T_ProxyList& result)
+{
+	BP_GridProxy::T_ProxyList::const_iterator it;
+	for (it = proxies.begin(); it != proxies.end(); ++it)
+	{
+		if ((*it)->m_stamp != stamp)
+		{
+			(*it)->m_stamp = stamp;
+			if ((*it)->overlaps(*proxy))
+			{
+				result.push_back(*it);
+			}
+		}
+	}
+}
+
+void BP_GridScene::query(BP_GridProxy *proxy, BP_GridProxy::T_ProxyList& result)
+{
+	unsigned int stamp = nextStamp();
+	proxy->m_stamp = stamp;
+
+	if (proxy->isLarge())
+	{
+		collect(m_proxies, proxy, stamp, result);
+		return;
+	}
+
+	collect(m_large, proxy, stamp, result);
+
+	int x, y, z;
+	for (x = proxy->m_lo[0]; x <= proxy->m_hi[0]; ++x)
+	{
+		for (y = proxy->m_lo[1]; y <= proxy->m_hi[1]; ++y)
+		{
+			for (z = proxy->m_lo[2]; z <= proxy->m_hi[2]; ++z)
+			{
+				collect(m_buckets[bucketOf(x, y, z)], proxy, stamp, result);
+			}
+		}
+	}
+}
+
+inline bool covers(const BP_GridProxy *proxy, const int cell[3])
+{
+	return proxy->m_lo[0] <= cell[0] && cell[0] <= proxy->m_hi[0] &&
+		   proxy->m_lo[1] <= cell[1] && cell[1] <= proxy->m_hi[1] &&
+		   proxy->m_lo[2] <= cell[2] && cell[2] <= proxy->m_hi[2];
+}
+
+void BP_GridScene::visit(const BP_GridProxy::T_ProxyList& proxies, const int *prev, 
+						 BP_GridProxy *&hit, BP_RayCastCallback objectRayCast, void *client_data,
+						 const DT_Vector3 source, const DT_Vector3 target, 
+						 const DT_Vector3 delta, DT_Scalar& lambda) const
+{
+	BP_GridProxy::T_ProxyList::const_iterator it;
+	for (it = proxies.begin(); it != proxies.end(); ++it)
+	{
+		if ((prev == 0 || !covers(*it, prev)) &&
+			BP_clip((*it)->m_min, (*it)->m_max, source, delta, lambda) &&
+			(*objectRayCast)(client_data, (*it)->getObject(), source, target, &lambda))
+		{
+			hit = *it;
+		}
+	}
+}
+
+void *BP_GridScene::rayCast(BP_RayCastCallback objectRayCast,
+							void *client_data,
+							const DT_Vector3 source, 
+							const DT_Vector3 target, 
+							DT_Scalar& lambda) const
+{
+	BP_GridProxy *hit = 0;
+
+	DT_Vector3 delta;
+	delta[0] = target[0] - source[0];
+	delta[1] = target[1] - source[1];
+	delta[2] = target[2] - source[2];
+
+	visit(m_large, 0, hit, objectRayCast, client_data, source, target, delta, lambda);
+
+	// Walk the cells that are pierced by the ray in order. A long ray through 
+	// a sparse grid visits more cells than there are proxies, in which case 
+	// the proxies are simply tested one by one.
+	// The walk never turns back along an axis, so it passes through the cells 
+	// of a proxy in one stretch. A proxy is tested only in the first of its
+	// cells, which needs no marks on the proxies, so that rays can be cast 
+	// from several threads at once.
+	int cell[3], last[3], step[3], prev[3];
+	DT_Scalar next[3];
+	unsigned int count = 0;
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		cell[i] = cellOf(source[i]);
+		last[i] = cellOf(source[i] + lambda * delta[i]);
+		step[i] = cell[i] < last[i] ? 1 : -1;
+		count += (unsigned int)(last[i] > cell[i] ? last[i] - cell[i] : cell[i] - last[i]);
+	}
+
+	if (count > m_proxies.size())
+	{
+		visit(m_proxies, 0, hit, objectRayCast, client_data, source, target, delta, lambda);
+		return hit ? hit->getObject() : 0;
+	}
+
+	const int *skip = 0;
+	for (;;)
+	{
+		visit(m_buckets[bucketOf(cell[0], cell[1], cell[2])], skip, hit, 
+			  objectRayCast, client_data, source, target, delta, lambda);
+
+		// Find the axis along which the ray leaves the current cell first. 
+		// Axes that have reached the last cell are done. 
+		int axis = -1;
+		for (i = 0; i < 3; ++i) 
+		{
+			if (cell[i] != last[i])
+			{
+				int boundary = step[i] > 0 ? cell[i] + 1 : cell[i];
+				next[i] = (DT_Scalar(boundary) * m_cellSize - source[i]) / delta[i];
+				if (axis == -1 || next[i] < next[axis])
+				{
+					axis = i;
+				}
+			}
+		}
+
+		if (axis == -1 || lambda < next[axis])
+		{
+			break;
+		}
+
+		prev[0] = cell[0];
+		prev[1] = cell[1];
+		prev[2] = cell[2];
+		skip = prev;
+
+		cell[axis] += step[axis];
+	}
+
+	return hit ? hit->getObject() : 0;
+}
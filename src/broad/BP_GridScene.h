@@ -0,0 +1,140 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_GRIDSCENE_H
+#define BP_GRIDSCENE_H
+
+#include <vector>
+
+#include "BP_Scene.h"
+#include "BP_Proxy.h"
+
+class BP_GridScene;
+
+class BP_GridProxy : public BP_Proxy {
+public:
+	typedef std::vector<BP_GridProxy *> T_ProxyList;
+
+	BP_GridProxy(void *object, BP_GridScene& scene, 
+				 const DT_Vector3 min, const DT_Vector3 max);
+
+	virtual void setBBox(const DT_Vector3 min, const DT_Vector3 max);
+
+	void setBounds(const DT_Vector3 min, const DT_Vector3 max)
+	{
+		int i;
+		for (i = 0; i < 3; ++i) 
+		{
+			m_min[i] = min[i];
+			m_max[i] = max[i];
+		}
+	}
+
+	bool overlaps(const BP_GridProxy& other) const
+	{
+		return m_min[0] <= other.m_max[0] && other.m_min[0] <= m_max[0] && 
+			   m_min[1] <= other.m_max[1] && other.m_min[1] <= m_max[1] &&
+			   m_min[2] <= other.m_max[2] && other.m_min[2] <= m_max[2];
+	}
+
+	bool isLarge() const { return m_lo[0] > m_hi[0]; }
+
+	DT_Vector3    m_min;
+	DT_Vector3    m_max;
+	int           m_lo[3];      // Range of cells covered by the box, empty 
+	int           m_hi[3];      // for proxies that cover too many cells
+	int           m_index;      // Position in the scene's list of proxies
+	unsigned int  m_stamp;      // Last pair query that visited this proxy 
+	bool          m_deferred;
+
+	// The proxies whose boxes currently overlap this one, sorted by address
+	T_ProxyList   m_overlaps;
+
+private:
+	BP_GridScene& m_scene;
+};
+
+// Uniform grid of cubic cells that are hashed into a table of buckets. A 
+// proxy is stored in the bucket of each cell its box covers, so the cost of
+// a move depends only on the number of proxies nearby. Proxies that cover 
+// more than a few cells are kept in a separate list and are tested against 
+// everything. The cell size should be about the size of a typical object. 
+
+class BP_GridScene : public BP_Scene {
+public:
+    BP_GridScene(void *client_data,
+				 BP_Callback beginOverlap,
+				 BP_Callback endOverlap,
+				 DT_Scalar cellSize);
+
+    virtual BP_GridProxy *createProxy(void *object, 
+									  const DT_Vector3 min,
+									  const DT_Vector3 max);
+
+    virtual void destroyProxy(BP_Proxy *proxy);
+
+	virtual void beginUpdate();
+	virtual void commitUpdate();
+
+	virtual void *rayCast(BP_RayCastCallback objectRayCast,
+						  void *client_data,
+						  const DT_Vector3 source, 
+						  const DT_Vector3 target, 
+						  DT_Scalar& lambda) const;
+
+	void setBBox(BP_GridProxy *proxy, const DT_Vector3 min, const DT_Vector3 max);
+
+private:
+	typedef std::vector<BP_GridProxy::T_ProxyList> T_BucketList;
+
+	int cellOf(DT_Scalar x) const;
+	unsigned int bucketOf(int x, int y, int z) const;
+
+	void computeCells(const DT_Vector3 min, const DT_Vector3 max, 
+					  int lo[3], int hi[3]) const;
+	void insertCells(BP_GridProxy *proxy);
+	void removeCells(BP_GridProxy *proxy);
+	void rehash();
+
+	void moveCells(BP_GridProxy *proxy);
+	void updatePairs(BP_GridProxy *proxy);
+	void query(BP_GridProxy *proxy, BP_GridProxy::T_ProxyList& result);
+	unsigned int nextStamp();
+	void visit(const BP_GridProxy::T_ProxyList& proxies, const int *prev, 
+			   BP_GridProxy *&hit, BP_RayCastCallback objectRayCast, void *client_data,
+			   const DT_Vector3 source, const DT_Vector3 target, 
+			   const DT_Vector3 delta, DT_Scalar& lambda) const;
+
+	DT_Scalar                    m_cellSize;
+	DT_Scalar                    m_invCellSize;
+	T_BucketList                 m_buckets;
+	unsigned int                 m_mask;
+	BP_GridProxy::T_ProxyList    m_proxies;
+	BP_GridProxy::T_ProxyList    m_large;
+	std::vector<BP_GridProxy *>  m_deferred;
+	BP_GridProxy::T_ProxyList    m_overlaps;
+	unsigned int                 m_stamp;
+	bool                         m_updating;
+};
+
+#endif
@@ -0,0 +1,530 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#include "BP_MultiSAPScene.h"
+#include "BP_Clip.h"
+
+// Proxies that span more regions than this are not added to the regions
+static const double MAX_REGIONS    = 64.0;
+
+// Region coordinates are clamped. The outermost regions extend to infinity.
+static const int    REGION_LIMIT   = 1 << 20;
+
+static void beginRegionOverlap(void *client_data, void *object1, void *object2) 
+{
+	static_cast<BP_MultiSAPScene *>(client_data)->addPair(static_cast<BP_MultiSAPProxy *>(object1), 
+														   static_cast<BP_MultiSAPProxy *>(object2));
+}
+
+static void endRegionOverlap(void *client_data, void *object1, void *object2) 
+{
+	static_cast<BP_MultiSAPScene *>(client_data)->removePair(static_cast<BP_MultiSAPProxy *>(object1), 
+															 static_cast<BP_MultiSAPProxy *>(object2));
+}
+
+struct BP_MultiSAPRayCastData {
+	BP_MultiSAPRayCastData(BP_RayCastCallback objectRayCast, void *client_data) 
+	  : m_objectRayCast(objectRayCast),
+		m_client_data(client_data)
+	{}
+
+	BP_RayCastCallback  m_objectRayCast;
+	void               *m_client_data;
+};
+
+static bool regionRayCast(void *client_data, 
+						  void *object,  
+						  const DT_Vector3 source,
+						  const DT_Vector3 target,
+						  DT_Scalar *lambda) 
+{
+	BP_MultiSAPRayCastData *data = static_cast<BP_MultiSAPRayCastData *>(client_data);
+	return (*data->m_objectRayCast)(data->m_client_data, 
+									static_cast<BP_MultiSAPProxy *>(object)->getObject(),
+									source, target, lambda);
+}
+
+BP_MultiSAPProxy::BP_MultiSAPProxy(void *object, BP_MultiSAPScene& scene, 
+								   const DT_Vector3 min, const DT_Vector3 max)
+  : BP_Proxy(object),
+	m_index(-1),
+	m_deferred(false),
+	m_scene(scene)
+{
+	setBounds(min, max);
+}
+
+void BP_MultiSAPProxy::setBBox(const DT_Vector3 min, const DT_Vector3 max)
+{
+	m_scene.setBBox(this, min, max);
+}
+
+BP_MultiSAPScene::BP_MultiSAPScene(void *client_data,
+								   BP_Callback beginOverlap,
+								   BP_Callback endOverlap,
+								   DT_Scalar regionSize) 
+  :	BP_Scene(client_data, beginOverlap, endOverlap),
+	m_regionSize(regionSize),
+	m_invRegionSize(DT_Scalar(1.0) / regionSize),
+	m_updating(false)
+{
+	assert(regionSize > DT_Scalar(0.0));
+}
+
+BP_MultiSAPScene::~BP_MultiSAPScene()
+{
+	T_RegionMap::iterator it;
+	for (it = m_regions.begin(); it != m_regions.end(); ++it)
+	{
+		delete (*it).second->m_scene;
+		delete (*it).second;
+	}
+}
+
+int BP_MultiSAPScene::regionOf(DT_Scalar x) const
+{
+	DT_Scalar c = floor(x * m_invRegionSize);
+	return c < DT_Scalar(-REGION_LIMIT) ? -REGION_LIMIT : 
+		   c > DT_Scalar(REGION_LIMIT) ? REGION_LIMIT : 
+		   int(c);
+}
+
+void BP_MultiSAPScene::computeRegions(const DT_Vector3 min, const DT_Vector3 max, 
+									  int lo[3], int hi[3]) const
+{
+	double count = 1.0;
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		lo[i] = regionOf(min[i]);
+		hi[i] = regionOf(max[i]);
+		count *= double(hi[i] - lo[i]) + 1.0;
+	}
+
+	if (!(count <= MAX_REGIONS))
+	{
+		for (i = 0; i < 3; ++i) 
+		{
+			lo[i] = 1;
+			hi[i] = 0;
+		}
+	}
+}
+
+bool BP_MultiSAPScene::regionsChanged(const BP_MultiSAPProxy *proxy) const
+{
+	int lo[3], hi[3];
+	computeRegions(proxy->m_min, proxy->m_max, lo, hi);
+
+	return lo[0] != proxy->m_lo[0] || hi[0] != proxy->m_hi[0] ||
+		   lo[1] != proxy->m_lo[1] || hi[1] != proxy->m_hi[1] ||
+		   lo[2] != proxy->m_lo[2] || hi[2] != proxy->m_hi[2];
+}
+
+BP_Region *BP_MultiSAPScene::findRegion(int x, int y, int z)
+{
+	T_RegionKey key(x, y, z);
+	T_RegionMap::iterator it = m_regions.lower_bound(key);
+	if (it == m_regions.end() || key < (*it).first)
+	{
+		BP_SAPScene *scene = new BP_SAPScene(this, &beginRegionOverlap, &endRegionOverlap);
+		it = m_regions.insert(it, std::make_pair(key, new BP_Region(x, y, z, scene)));
+	}
+	return (*it).second;
+}
+
+void BP_MultiSAPScene::releaseRegion(BP_Region *region)
+{
+	if (--region->m_count == 0)
+	{
+		m_regions.erase(T_RegionKey(region->m_cell[0], region->m_cell[1], region->m_cell[2]));
+		delete region->m_scene;
+		delete region;
+	}
+}
+
+void BP_MultiSAPScene::getBounds(const BP_Region *region, DT_Vector3 min, DT_Vector3 max) const
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		int cell = region->m_cell[i];
+		min[i] = cell == -REGION_LIMIT ? -FLT_MAX : DT_Scalar(cell) * m_regionSize;
+		max[i] = cell == REGION_LIMIT ? FLT_MAX : DT_Scalar(cell + 1) * m_regionSize;
+	}
+}
+
+void BP_MultiSAPScene::addToRegions(BP_MultiSAPProxy *proxy)
+{
+	if (proxy->isLarge())
+	{
+		m_large.push_back(proxy);
+		return;
+	}
+
+	int x, y, z;
+	for (x = proxy->m_lo[0]; x <= proxy->m_hi[0]; ++x)
+	{
+		for (y = proxy->m_lo[1]; y <= proxy->m_hi[1]; ++y)
+		{
+			for (z = proxy->m_lo[2]; z <= proxy->m_hi[2]; ++z)
+			{
+				BP_Region *region = findRegion(x, y, z);
+				++region->m_count;
+				BP_SAPProxy *child = region->m_scene->createProxy(proxy, proxy->m_min, proxy->m_max);
+				proxy->m_children.push_back(std::make_pair(region, child));
+			}
+		}
+	}
+}
+
+void BP_MultiSAPScene::removeFromRegions(BP_MultiSAPProxy *proxy)
+{
+	if (proxy->isLarge())
+	{
+		m_large.erase(std::find(m_large.begin(), m_large.end(), proxy));
+		return;
+	}
+
+	std::vector<BP_RegionProxy>::iterator it;
+	for (it = proxy->m_children.begin(); it != proxy->m_children.end(); ++it)
+	{
+		(*it).first->m_scene->destroyProxy((*it).second);
+		releaseRegion((*it).first);
+	}
+	proxy->m_children.clear();
+}
+
+void BP_MultiSAPScene::moveRegions(BP_MultiSAPProxy *proxy)
+{
+	int lo[3], hi[3];
+	computeRegions(proxy->m_min, proxy->m_max, lo, hi);
+
+	int i;
+	if (proxy->isLarge() || lo[0] > hi[0])
+	{
+		// The pairs of a large proxy are not counted by the regions, so 
+		// they are ended before the proxy is moved into the regions.
+		if (proxy->isLarge())
+		{
+			std::vector<BP_MultiSAPProxy *>::iterator it;
+			for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+			{
+				if (*it != proxy && !(*it)->isLarge())
+				{
+					setPair(proxy, *it, false);
+				}
+			}
+		}
+
+		removeFromRegions(proxy);
+		for (i = 0; i < 3; ++i) 
+		{
+			proxy->m_lo[i] = lo[i];
+			proxy->m_hi[i] = hi[i];
+		}
+		addToRegions(proxy);
+		return;
+	}
+
+	// Keep the regions that are still spanned, and leave the others
+	std::vector<BP_RegionProxy> children;
+	children.swap(proxy->m_children);
+
+	std::vector<BP_RegionProxy>::iterator it;
+	for (it = children.begin(); it != children.end(); ++it)
+	{
+		const int *cell = (*it).first->m_cell;
+		if (lo[0] <= cell[0] && cell[0] <= hi[0] &&
+			lo[1] <= cell[1] && cell[1] <= hi[1] &&
+			lo[2] <= cell[2] && cell[2] <= hi[2])
+		{
+			(*it).second->setBBox(proxy->m_min, proxy->m_max);
+			proxy->m_children.push_back(*it);
+		}
+		else 
+		{
+			(*it).first->m_scene->destroyProxy((*it).second);
+			releaseRegion((*it).first);
+		}
+	}
+
+	int x, y, z;
+	for (x = lo[0]; x <= hi[0]; ++x)
+	{
+		for (y = lo[1]; y <= hi[1]; ++y)
+		{
+			for (z = lo[2]; z <= hi[2]; ++z)
+			{
+				if (x < proxy->m_lo[0] || proxy->m_hi[0] < x ||
+					y < proxy->m_lo[1] || proxy->m_hi[1] < y ||
+					z < proxy->m_lo[2] || proxy->m_hi[2] < z)
+				{
+					BP_Region *region = findRegion(x, y, z);
+					++region->m_count;
+					BP_SAPProxy *child = region->m_scene->createProxy(proxy, proxy->m_min, proxy->m_max);
+					proxy->m_children.push_back(std::make_pair(region, child));
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < 3; ++i) 
+	{
+		proxy->m_lo[i] = lo[i];
+		proxy->m_hi[i] = hi[i];
+	}
+}
+
+BP_MultiSAPProxy *BP_MultiSAPScene::createProxy(void *object, 
+												const DT_Vector3 min,
+												const DT_Vector3 max)
+{
+	BP_MultiSAPProxy *proxy = new BP_MultiSAPProxy(object, *this, min, max);
+
+	proxy->m_index = int(m_proxies.size());
+	m_proxies.push_back(proxy);
+
+	computeRegions(min, max, proxy->m_lo, proxy->m_hi);
+	addToRegions(proxy);
+	updateLargePairs(proxy);
+
+	return proxy;
+}
+
+void BP_MultiSAPScene::destroyProxy(BP_Proxy *p)
+{
+	BP_MultiSAPProxy *proxy = static_cast<BP_MultiSAPProxy *>(p);
+
+	if (proxy->m_deferred)
+	{
+		m_deferred.erase(std::find(m_deferred.begin(), m_deferred.end(), proxy));
+	}
+
+	std::vector<BP_MultiSAPProxy *>& others = proxy->isLarge() ? m_proxies : m_large;
+	std::vector<BP_MultiSAPProxy *>::iterator it;
+	for (it = others.begin(); it != others.end(); ++it)
+	{
+		if (*it != proxy)
+		{
+			setPair(proxy, *it, false);
+		}
+	}
+
+	removeFromRegions(proxy);
+
+	m_proxies[proxy->m_index] = m_proxies.back();
+	m_proxies[proxy->m_index]->m_index = proxy->m_index;
+	m_proxies.pop_back();
+
+	delete proxy;
+}
+
+void BP_MultiSAPScene::setBBox(BP_MultiSAPProxy *proxy, const DT_Vector3 min, const DT_Vector3 max)
+{
+	proxy->setBounds(min, max);
+
+	if (m_updating)
+	{
+		if (!proxy->m_deferred)
+		{
+			proxy->m_deferred = true;
+			m_deferred.push_back(proxy);
+		}
+	}
+	else 
+	{
+		if (regionsChanged(proxy))
+		{
+			moveRegions(proxy);
+		}
+		else 
+		{
+			std::vector<BP_RegionProxy>::iterator it;
+			for (it = proxy->m_children.begin(); it != proxy->m_children.end(); ++it)
+			{
+				(*it).second->setBBox(min, max);
+			}
+		}
+		updateLargePairs(proxy);
+	}
+}
+
+void BP_MultiSAPScene::beginUpdate()
+{
+	assert(!m_updating);
+	m_updating = true;
+}
+
+void BP_MultiSAPScene::commitUpdate()
+{
+	assert(m_updating);
+	m_updating = false;
+
+	// Proxies that stay in the same regions are moved in one batch per 
+	// region. Proxies that enter or leave regions are moved afterwards.
+	T_RegionMap::iterator rt;
+	for (rt = m_regions.begin(); rt != m_regions.end(); ++rt)
+	{
+		(*rt).second->m_scene->beginUpdate();
+	}
+
+	std::vector<BP_MultiSAPProxy *> moved;
+
+	std::vector<BP_MultiSAPProxy *>::iterator it;
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		BP_MultiSAPProxy *proxy = *it;
+		proxy->m_deferred = false;
+		if (regionsChanged(proxy))
+		{
+			moved.push_back(proxy);
+		}
+		else 
+		{
+			std::vector<BP_RegionProxy>::iterator jt;
+			for (jt = proxy->m_children.begin(); jt != proxy->m_children.end(); ++jt)
+			{
+				(*jt).second->setBBox(proxy->m_min, proxy->m_max);
+			}
+		}
+	}
+
+	for (rt = m_regions.begin(); rt != m_regions.end(); ++rt)
+	{
+		(*rt).second->m_scene->commitUpdate();
+	}
+
+	for (it = moved.begin(); it != moved.end(); ++it)
+	{
+		moveRegions(*it);
+	}
+
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		updateLargePairs(*it);
+	}
+
+	m_deferred.clear();
+}
+
+void BP_MultiSAPScene::updateLargePairs(BP_MultiSAPProxy *proxy)
+{
+	std::vector<BP_MultiSAPProxy *>& others = proxy->isLarge() ? m_proxies : m_large;
+	std::vector<BP_MultiSAPProxy *>::iterator it;
+	for (it = others.begin(); it != others.end(); ++it)
+	{
+		if (*it != proxy)
+		{
+			setPair(proxy, *it, proxy->overlaps(**it));
+		}
+	}
+}
+
+void BP_MultiSAPScene::setPair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b, bool overlap)
+{
+	T_Pair pair = makePair(a, b);
+	T_PairTable::iterator it = m_pairs.lower_bound(pair);
+	bool found = it != m_pairs.end() && (*it).first == pair;
+
+	if (overlap && !found)
+	{
+		m_pairs.insert(it, std::make_pair(pair, 1u));
+		callBeginOverlap(a->getObject(), b->getObject());
+	}
+	else if (!overlap && found)
+	{
+		m_pairs.erase(it);
+		callEndOverlap(a->getObject(), b->getObject());
+	}
+}
+
+void BP_MultiSAPScene::addPair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b)
+{
+	if (++m_pairs[makePair(a, b)] == 1)
+	{
+		callBeginOverlap(a->getObject(), b->getObject());
+	}
+}
+
+void BP_MultiSAPScene::removePair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b)
+{
+	T_PairTable::iterator it = m_pairs.find(makePair(a, b));
+	assert(it != m_pairs.end());
+	if (--(*it).second == 0)
+	{
+		m_pairs.erase(it);
+		callEndOverlap(a->getObject(), b->getObject());
+	}
+}
+
+void *BP_MultiSAPScene::rayCast(BP_RayCastCallback objectRayCast,
+								void *client_data,
+								const DT_Vector3 source, 
+								const DT_Vector3 target, 
+								DT_Scalar& lambda) const
+{
+	void *client_object = 0;
+
+	DT_Vector3 delta;
+	delta[0] = target[0] - source[0];
+	delta[1] = target[1] - source[1];
+	delta[2] = target[2] - source[2];
+
+	std::vector<BP_MultiSAPProxy *>::const_iterator it;
+	for (it = m_large.begin(); it != m_large.end(); ++it)
+	{
+		if (BP_clip((*it)->m_min, (*it)->m_max, source, delta, lambda) &&
+			(*objectRayCast)(client_data, (*it)->getObject(), source, target, &lambda))
+		{
+			client_object = (*it)->getObject();
+		}
+	}
+
+	// A proxy that spans several regions may be tested more than once, but 
+	// only the first test can report a hit closer than 'lambda'.
+	BP_MultiSAPRayCastData data(objectRayCast, client_data);
+
+	T_RegionMap::const_iterator rt;
+	for (rt = m_regions.begin(); rt != m_regions.end(); ++rt)
+	{
+		DT_Vector3 min, max;
+		getBounds((*rt).second, min, max);
+		if (BP_clip(min, max, source, delta, lambda))
+		{
+			BP_MultiSAPProxy *proxy = static_cast<BP_MultiSAPProxy *>(
+				(*rt).second->m_scene->rayCast(&regionRayCast, &data, source, target, lambda));
+			if (proxy)
+			{
+				client_object = proxy->getObject();
+			}
+		}
+	}
+
+	return client_object;
+}
@@ -0,0 +1,179 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_MULTISAPSCENE_H
+#define BP_MULTISAPSCENE_H
+
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "BP_Scene.h"
+#include "BP_Proxy.h"
+#include "BP_SAPScene.h"
+
+class BP_MultiSAPScene;
+
+class BP_Region {
+public:
+	BP_Region(int x, int y, int z, BP_SAPScene *scene) 
+	  : m_scene(scene), 
+		m_count(0)
+	{
+		m_cell[0] = x;
+		m_cell[1] = y;
+		m_cell[2] = z;
+	}
+
+	BP_SAPScene  *m_scene;
+	unsigned int  m_count;
+	int           m_cell[3];
+};
+
+typedef std::pair<BP_Region *, BP_SAPProxy *> BP_RegionProxy;
+
+class BP_MultiSAPProxy : public BP_Proxy {
+public:
+	BP_MultiSAPProxy(void *object, BP_MultiSAPScene& scene, 
+					 const DT_Vector3 min, const DT_Vector3 max);
+
+	virtual void setBBox(const DT_Vector3 min, const DT_Vector3 max);
+
+	void setBounds(const DT_Vector3 min, const DT_Vector3 max)
+	{
+		int i;
+		for (i = 0; i < 3; ++i) 
+		{
+			m_min[i] = min[i];
+			m_max[i] = max[i];
+		}
+	}
+
+	bool overlaps(const BP_MultiSAPProxy& other) const
+	{
+		return m_min[0] <= other.m_max[0] && other.m_min[0] <= m_max[0] && 
+			   m_min[1] <= other.m_max[1] && other.m_min[1] <= m_max[1] &&
+			   m_min[2] <= other.m_max[2] && other.m_min[2] <= m_max[2];
+	}
+
+	bool isLarge() const { return m_lo[0] > m_hi[0]; }
+
+	DT_Vector3    m_min;
+	DT_Vector3    m_max;
+	int           m_lo[3];      // Range of regions spanned by the box, empty 
+	int           m_hi[3];      // for proxies that span too many regions
+	int           m_index;      // Position in the scene's list of proxies
+	bool          m_deferred;
+
+	// One sweep and prune proxy in each region spanned by the box
+	std::vector<BP_RegionProxy> m_children;
+
+private:
+	BP_MultiSAPScene& m_scene;
+};
+
+// Space is divided into cubic regions, each with its own sweep and prune 
+// scene, so the endpoint lists only hold the proxies in a region. A proxy 
+// is added to every region its box touches. Pairs that are found in more 
+// than one region are counted, so that a pair is only reported when it 
+// starts overlapping in the first region and stops in the last. Proxies 
+// that span too many regions are tested against all other proxies. 
+
+class BP_MultiSAPScene : public BP_Scene {
+public:
+    BP_MultiSAPScene(void *client_data,
+					 BP_Callback beginOverlap,
+					 BP_Callback endOverlap,
+					 DT_Scalar regionSize);
+
+	virtual ~BP_MultiSAPScene();
+
+    virtual BP_MultiSAPProxy *createProxy(void *object, 
+										  const DT_Vector3 min,
+										  const DT_Vector3 max);
+
+    virtual void destroyProxy(BP_Proxy *proxy);
+
+	virtual void beginUpdate();
+	virtual void commitUpdate();
+
+	virtual void *rayCast(BP_RayCastCallback objectRayCast,
+						  void *client_data,
+						  const DT_Vector3 source, 
+						  const DT_Vector3 target, 
+						  DT_Scalar& lambda) const;
+
+	void setBBox(BP_MultiSAPProxy *proxy, const DT_Vector3 min, const DT_Vector3 max);
+
+	void addPair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b);
+	void removePair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b);
+
+private:
+	typedef std::pair<BP_MultiSAPProxy *, BP_MultiSAPProxy *> T_Pair;
+	typedef std::map<T_Pair, unsigned int>                    T_PairTable;
+
+	struct T_RegionKey {
+		T_RegionKey(int x, int y, int z) : m_x(x), m_y(y), m_z(z) {}
+
+		bool operator<(const T_RegionKey& other) const
+		{
+			return m_x < other.m_x || (m_x == other.m_x && 
+				   (m_y < other.m_y || (m_y == other.m_y && m_z < other.m_z)));
+		}
+
+		int m_x, m_y, m_z;
+	};
+
+	typedef std::map<T_RegionKey, BP_Region *> T_RegionMap;
+
+	static T_Pair makePair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b)
+	{
+		return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+	}
+
+	int regionOf(DT_Scalar x) const;
+	void computeRegions(const DT_Vector3 min, const DT_Vector3 max, 
+						int lo[3], int hi[3]) const;
+	bool regionsChanged(const BP_MultiSAPProxy *proxy) const;
+
+	BP_Region *findRegion(int x, int y, int z);
+	void releaseRegion(BP_Region *region);
+	void getBounds(const BP_Region *region, DT_Vector3 min, DT_Vector3 max) const;
+
+	void addToRegions(BP_MultiSAPProxy *proxy);
+	void moveRegions(BP_MultiSAPProxy *proxy);
+	void removeFromRegions(BP_MultiSAPProxy *proxy);
+	void updateLargePairs(BP_MultiSAPProxy *proxy);
+	void setPair(BP_MultiSAPProxy *a, BP_MultiSAPProxy *b, bool overlap);
+
+	DT_Scalar                         m_regionSize;
+	DT_Scalar                         m_invRegionSize;
+	T_RegionMap                       m_regions;
+	std::vector<BP_MultiSAPProxy *>   m_proxies;
+	std::vector<BP_MultiSAPProxy *>   m_large;
+	std::vector<BP_MultiSAPProxy *>   m_deferred;
+	T_PairTable                       m_pairs;
+	bool                              m_updating;
+};
+
+#endif
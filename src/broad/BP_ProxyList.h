@@ -30,15 +30,23 @@
 #include <algorithm>
 #include <utility>
 
-class BP_Proxy;
+class BP_SAPProxy;
 
-typedef std::pair<BP_Proxy *, unsigned int> BP_ProxyEntry; 
+typedef std::pair<BP_SAPProxy *, unsigned int> BP_ProxyEntry; 
 
 inline bool operator<(const BP_ProxyEntry& a, const BP_ProxyEntry& b) 
 {
 	return a.first < b.first;
 }
 
+typedef std::pair<BP_SAPProxy *, BP_SAPProxy *> BP_ProxyPair;
+typedef std::vector<BP_ProxyPair> BP_ProxyPairList;
+
+inline BP_ProxyPair BP_makePair(BP_SAPProxy *a, BP_SAPProxy *b)
+{
+	return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
 class BP_ProxyList : public std::vector<BP_ProxyEntry> {
 public:
    BP_ProxyList(size_t n = 20)
@@ -46,7 +54,7 @@ public:
       reserve(n); 
    }      
 
-	iterator add(BP_Proxy *proxy) 
+	iterator add(BP_SAPProxy *proxy) 
 	{
 		BP_ProxyEntry entry = std::make_pair(proxy, 0);
 		iterator it = std::lower_bound(begin(), end(), entry);
@@ -59,14 +67,14 @@ public:
 		return it;
 	}
 
-   unsigned int operator[](BP_Proxy *proxy)
+   unsigned int operator[](BP_SAPProxy *proxy)
    {
       BP_ProxyEntry entry = std::make_pair(proxy, 0);
       iterator it = std::lower_bound(begin(), end(), entry);
       return (it == end() || (*it).first != proxy)  ? 0 : (*it).second;
    }
 
-	void remove(BP_Proxy *proxy) 
+	void remove(BP_SAPProxy *proxy) 
 	{
 		BP_ProxyEntry entry = std::make_pair(proxy, 0);
 		iterator it = std::lower_bound(begin(), end(), entry);
@@ -0,0 +1,219 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include "BP_SAPProxy.h"
+#include "BP_SAPScene.h"
+
+BP_SAPProxy::BP_SAPProxy(void *object, 
+						 BP_SAPScene& scene) 
+  :	BP_Proxy(object),
+	m_scene(scene),
+	m_deferred(false),
+	m_mode(DT_DYNAMIC),
+	m_leaf(-1)
+{}
+
+void BP_SAPProxy::setKeys(const DT_Vector3 min, const DT_Vector3 max) 
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		m_key[i][BP_Endpoint::MINIMUM] = BP_Endpoint::makeKey(min[i], BP_Endpoint::MINIMUM);
+		m_key[i][BP_Endpoint::MAXIMUM] = BP_Endpoint::makeKey(max[i], BP_Endpoint::MAXIMUM);
+	}
+}
+
+void BP_SAPProxy::getBounds(DT_Vector3 min, DT_Vector3 max) const
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		min[i] = BP_Endpoint::getPos(getMin(i));
+		max[i] = BP_Endpoint::getPos(getMax(i));
+	}
+}
+
+void BP_SAPProxy::add(BP_ProxyList& proxies) 
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		m_scene.getList(i).addInterval(this, proxies);
+	}
+}
+
+void BP_SAPProxy::remove(BP_ProxyList& proxies) 
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		m_scene.getList(i).removeInterval(this, proxies);
+	}
+}
+
+bool overlapXY(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return a.getMin(0) <= b.getMax(0) && b.getMin(0) <= a.getMax(0) && 
+		   a.getMin(1) <= b.getMax(1) && b.getMin(1) <= a.getMax(1);
+}
+
+bool overlapXZ(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return a.getMin(0) <= b.getMax(0) && b.getMin(0) <= a.getMax(0) && 
+		   a.getMin(2) <= b.getMax(2) && b.getMin(2) <= a.getMax(2); 
+}
+
+bool overlapYZ(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return a.getMin(1) <= b.getMax(1) && b.getMin(1) <= a.getMax(1) && 
+		   a.getMin(2) <= b.getMax(2) && b.getMin(2) <= a.getMax(2); 
+}
+
+// During a batched update a pair can only change its overlap status if it 
+// overlaps on the two remaining axes either before or after the update. 
+
+bool updateOverlapXY(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return (a.getMin(0) <= b.getMax(0) && b.getMin(0) <= a.getMax(0) && 
+			a.getMin(1) <= b.getMax(1) && b.getMin(1) <= a.getMax(1)) ||
+		   (a.getPrevMin(0) <= b.getPrevMax(0) && b.getPrevMin(0) <= a.getPrevMax(0) && 
+			a.getPrevMin(1) <= b.getPrevMax(1) && b.getPrevMin(1) <= a.getPrevMax(1));
+}
+
+bool updateOverlapXZ(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return (a.getMin(0) <= b.getMax(0) && b.getMin(0) <= a.getMax(0) && 
+			a.getMin(2) <= b.getMax(2) && b.getMin(2) <= a.getMax(2)) ||
+		   (a.getPrevMin(0) <= b.getPrevMax(0) && b.getPrevMin(0) <= a.getPrevMax(0) && 
+			a.getPrevMin(2) <= b.getPrevMax(2) && b.getPrevMin(2) <= a.getPrevMax(2));
+}
+
+bool updateOverlapYZ(const BP_SAPProxy& a, const BP_SAPProxy& b)
+{
+	return (a.getMin(1) <= b.getMax(1) && b.getMin(1) <= a.getMax(1) && 
+			a.getMin(2) <= b.getMax(2) && b.getMin(2) <= a.getMax(2)) ||
+		   (a.getPrevMin(1) <= b.getPrevMax(1) && b.getPrevMin(1) <= a.getPrevMax(1) && 
+			a.getPrevMin(2) <= b.getPrevMax(2) && b.getPrevMin(2) <= a.getPrevMax(2));
+}
+
+void BP_SAPProxy::setBBox(const DT_Vector3 min, const DT_Vector3 max)
+{	
+	if (!isDynamic())
+	{
+		m_scene.moveParked(this, min, max);
+	}
+	else if (m_scene.isUpdating())
+	{
+		deferBBox(min, max);
+	}
+	else 
+	{
+		moveBBox(min, max);
+		m_scene.updateParkedPairs(this);
+	}
+}
+
+void BP_SAPProxy::setMode(DT_ProxyMode mode)
+{
+	m_scene.setMode(this, mode);
+}
+
+void BP_SAPProxy::moveBBox(const DT_Vector3 min, const DT_Vector3 max)
+{	
+	Uint32 key[3][2];
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		key[i][BP_Endpoint::MINIMUM] = BP_Endpoint::makeKey(min[i], BP_Endpoint::MINIMUM);
+		key[i][BP_Endpoint::MAXIMUM] = BP_Endpoint::makeKey(max[i], BP_Endpoint::MAXIMUM);
+	}
+	moveKeys(key);
+}
+
+void BP_SAPProxy::moveKeys(const Uint32 key[3][2])
+{	
+	static T_Overlap overlap[3] = { overlapYZ, overlapXZ, overlapXY };
+
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		BP_EndpointList& list = m_scene.getList(i);
+		Uint32 min = key[i][BP_Endpoint::MINIMUM];
+		Uint32 max = key[i][BP_Endpoint::MAXIMUM];
+
+		if (min > getMax(i)) 
+		{
+			list.move(m_index[i][BP_Endpoint::MAXIMUM], max, m_scene, overlap[i]);
+			list.move(m_index[i][BP_Endpoint::MINIMUM], min, m_scene, overlap[i]);
+		}
+		else 
+		{
+			list.move(m_index[i][BP_Endpoint::MINIMUM], min, m_scene, overlap[i]);
+			list.move(m_index[i][BP_Endpoint::MAXIMUM], max, m_scene, overlap[i]);
+		}
+	}
+}
+
+void BP_SAPProxy::deferBBox(const DT_Vector3 min, const DT_Vector3 max)
+{
+	if (!m_deferred)
+	{
+		m_deferred = true;
+		m_scene.addDeferred(this);
+	}
+
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		m_saved[i][BP_Endpoint::MINIMUM] = BP_Endpoint::makeKey(min[i], BP_Endpoint::MINIMUM);
+		m_saved[i][BP_Endpoint::MAXIMUM] = BP_Endpoint::makeKey(max[i], BP_Endpoint::MAXIMUM);
+	}
+}
+
+void BP_SAPProxy::moveDeferredBBox()
+{
+	assert(m_deferred);
+	
+	m_deferred = false;
+	moveKeys(m_saved);
+}
+
+void BP_SAPProxy::applyDeferredBBox()
+{
+	assert(m_deferred);
+
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		BP_EndpointList& list = m_scene.getList(i);
+		
+		Uint32 prev_min = getMin(i);
+		Uint32 prev_max = getMax(i);
+		
+		list.setKey(m_index[i][BP_Endpoint::MINIMUM], m_saved[i][BP_Endpoint::MINIMUM]);
+		list.setKey(m_index[i][BP_Endpoint::MAXIMUM], m_saved[i][BP_Endpoint::MAXIMUM]);
+		
+		m_saved[i][BP_Endpoint::MINIMUM] = prev_min;
+		m_saved[i][BP_Endpoint::MAXIMUM] = prev_max;
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_SAPPROXY_H
+#define BP_SAPPROXY_H
+
+#include "BP_Proxy.h"
+#include "BP_Endpoint.h"
+#include "BP_ProxyList.h"
+
+#include <vector>
+
+class BP_SAPScene;
+
+class BP_SAPProxy : public BP_Proxy {
+	friend class BP_SAPScene;
+public:
+	typedef std::vector<BP_SAPProxy *> T_ProxyList;
+
+    BP_SAPProxy(void *object, BP_SAPScene& scene);
+
+	void setKeys(const DT_Vector3 min, const DT_Vector3 max);
+	void getBounds(DT_Vector3 min, DT_Vector3 max) const;
+
+	void add(BP_ProxyList& proxies);
+    void remove(BP_ProxyList& proxies);
+	
+	virtual void setBBox(const DT_Vector3 min, const DT_Vector3 max);
+	virtual void setMode(DT_ProxyMode mode);
+
+	DT_ProxyMode getMode() const { return m_mode; }
+	bool isDynamic() const { return m_mode == DT_DYNAMIC; }
+
+	void moveBBox(const DT_Vector3 min, const DT_Vector3 max);
+	void deferBBox(const DT_Vector3 min, const DT_Vector3 max);
+	void moveDeferredBBox();
+	void applyDeferredBBox();
+	void releaseDeferredBBox() { m_deferred = false; }
+	
+	bool isDeferred() const { return m_deferred; }
+
+	Uint32 getMin(int i) const { return m_key[i][BP_Endpoint::MINIMUM]; }
+	Uint32 getMax(int i) const { return m_key[i][BP_Endpoint::MAXIMUM]; }
+
+	Uint32 getPrevMin(int i) const { return m_deferred ? m_saved[i][BP_Endpoint::MINIMUM] : getMin(i); }
+	Uint32 getPrevMax(int i) const { return m_deferred ? m_saved[i][BP_Endpoint::MAXIMUM] : getMax(i); }
+
+	void setKey(int i, Uint32 key) { m_key[i][BP_Endpoint::getType(key)] = key; }
+
+	DT_Index getIndex(int i, Uint32 type) const { return m_index[i][type]; }
+	void     setIndex(int i, Uint32 type, DT_Index index) { m_index[i][type] = index; }
+
+private:
+	void moveKeys(const Uint32 key[3][2]);
+
+	// The keys of the endpoints are kept here as well as in the endpoint 
+	// lists, so that overlap tests do not have to look them up.
+	Uint32       m_key[3][2];
+	DT_Index     m_index[3][2];
+	BP_SAPScene& m_scene;
+
+	// While an update is pending these hold the deferred keys. Once the 
+	// update is applied they hold the keys that were replaced.
+	Uint32       m_saved[3][2];
+	bool         m_deferred;
+
+	// Static and sleeping proxies are kept out of the endpoint lists and 
+	// live in a leaf of the scene's box tree instead. Their pairs with 
+	// dynamic proxies are kept on both sides, sorted by address.
+	DT_ProxyMode m_mode;
+	int          m_leaf;
+	T_ProxyList  m_overlaps;
+};
+
+inline bool BP_overlap(const BP_SAPProxy *a, const BP_SAPProxy *b)
+{
+	return a->getMin(0) <= b->getMax(0) && b->getMin(0) <= a->getMax(0) && 
+		   a->getMin(1) <= b->getMax(1) && b->getMin(1) <= a->getMax(1) &&
+		   a->getMin(2) <= b->getMax(2) && b->getMin(2) <= a->getMax(2);
+}
+
+bool updateOverlapXY(const BP_SAPProxy& a, const BP_SAPProxy& b);
+bool updateOverlapXZ(const BP_SAPProxy& a, const BP_SAPProxy& b);
+bool updateOverlapYZ(const BP_SAPProxy& a, const BP_SAPProxy& b);
+
+inline bool BP_prevOverlap(const BP_SAPProxy *a, const BP_SAPProxy *b)
+{
+	return a->getPrevMin(0) <= b->getPrevMax(0) && b->getPrevMin(0) <= a->getPrevMax(0) && 
+		   a->getPrevMin(1) <= b->getPrevMax(1) && b->getPrevMin(1) <= a->getPrevMax(1) &&
+		   a->getPrevMin(2) <= b->getPrevMax(2) && b->getPrevMin(2) <= a->getPrevMax(2);
+}
+
+#endif
+
+
+
+
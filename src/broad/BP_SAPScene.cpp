@@ -0,0 +1,595 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include "BP_SAPScene.h"
+#include "BP_SAPProxy.h"
+
+#include <algorithm>
+
+BP_SAPProxy *BP_SAPScene::createProxy(void *object, 
+								const DT_Vector3 min,
+								const DT_Vector3 max)
+{
+	applyDeferred();
+
+	BP_SAPProxy *proxy = new BP_SAPProxy(object, *this);
+
+	proxy->setKeys(min, max);
+	proxy->add(m_proxies);
+	
+	BP_ProxyList::iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+	{
+		if ((*it).second == 3)
+		{
+			callBeginOverlap(proxy->getObject(), (*it).first->getObject());
+		}
+	}
+
+	m_proxies.clear();
+
+	updateParkedPairs(proxy);
+
+	return proxy;
+}
+
+void BP_SAPScene::destroyProxy(BP_Proxy *p)
+{
+	applyDeferred();
+
+	BP_SAPProxy *proxy = static_cast<BP_SAPProxy *>(p);
+
+	if (proxy->isDynamic())
+	{
+		proxy->remove(m_proxies);
+	
+		BP_ProxyList::iterator it;
+		for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+		{
+			if ((*it).second == 3)
+			{
+				callEndOverlap(proxy->getObject(), (*it).first->getObject());
+			}
+		}
+	
+		m_proxies.clear();
+	}
+	else 
+	{
+		m_parked.destroyLeaf(proxy->m_leaf);
+	}
+
+	setOverlaps(proxy);
+
+	delete proxy;
+}
+
+void BP_SAPScene::createProxies(DT_Size count,
+								void *const *objects, 
+								const DT_Vector3 *min,
+								const DT_Vector3 *max,
+								DT_ProxyMode mode,
+								BP_Proxy **proxies)
+{
+	applyDeferred();
+
+	BP_SAPProxy::T_ProxyList created(count);
+
+	DT_Size i;
+	for (i = 0; i != count; ++i)
+	{
+		BP_SAPProxy *proxy = new BP_SAPProxy(objects[i], *this);
+		proxy->setKeys(min[i], max[i]);
+		proxy->m_mode = mode;
+		created[i] = proxy;
+		proxies[i] = proxy;
+	}
+
+	BP_SAPProxy::T_ProxyList::iterator it;
+	if (mode == DT_DYNAMIC)
+	{
+		int j;
+		for (j = 0; j < 3; ++j) 
+		{
+			m_endpointList[j].addIntervals(created);
+		}
+
+		std::sort(created.begin(), created.end());
+		sweep(created, true);
+
+		for (it = created.begin(); it != created.end(); ++it)
+		{
+			updateParkedPairs(*it);
+		}
+	}
+	else 
+	{
+		for (it = created.begin(); it != created.end(); ++it)
+		{
+			DT_Vector3 bounds_min, bounds_max;
+			(*it)->getBounds(bounds_min, bounds_max);
+			(*it)->m_leaf = m_parked.createLeaf(*it, bounds_min, bounds_max);
+			updateDynamicPairs(*it);
+		}
+	}
+}
+
+void BP_SAPScene::destroyProxies(DT_Size count, BP_Proxy *const *proxies)
+{
+	applyDeferred();
+
+	BP_SAPProxy::T_ProxyList removed;
+
+	DT_Size i;
+	for (i = 0; i != count; ++i)
+	{
+		BP_SAPProxy *proxy = static_cast<BP_SAPProxy *>(proxies[i]);
+		if (proxy->isDynamic())
+		{
+			removed.push_back(proxy);
+		}
+	}
+
+	std::sort(removed.begin(), removed.end());
+	sweep(removed, false);
+
+	int j;
+	for (j = 0; j < 3; ++j) 
+	{
+		m_endpointList[j].removeIntervals(removed);
+	}
+
+	for (i = 0; i != count; ++i)
+	{
+		BP_SAPProxy *proxy = static_cast<BP_SAPProxy *>(proxies[i]);
+		if (!proxy->isDynamic())
+		{
+			m_parked.destroyLeaf(proxy->m_leaf);
+		}
+		setOverlaps(proxy);
+	}
+
+	for (i = 0; i != count; ++i)
+	{
+		delete proxies[i];
+	}
+}
+
+// Reports the overlapping pairs that have at least one proxy in the sorted 
+// list 'marked', by a single sweep along the first axis. The unmarked 
+// proxies are only tested against the marked ones.
+
+void BP_SAPScene::sweep(const BP_SAPProxy::T_ProxyList& marked, bool begin)
+{
+	if (marked.empty())
+	{
+		return;
+	}
+
+	BP_SAPProxy::T_ProxyList active[2];
+
+	const BP_EndpointList& list = m_endpointList[0];
+	DT_Index i;
+	for (i = 0; i != list.size(); ++i)
+	{
+		BP_SAPProxy *proxy = list.getProxy(i);
+		int is_marked = std::binary_search(marked.begin(), marked.end(), proxy) ? 1 : 0;
+
+		if (list.getType(i) == BP_Endpoint::MINIMUM)
+		{
+			int k;
+			for (k = 1 - is_marked; k != 2; ++k)
+			{
+				BP_SAPProxy::T_ProxyList::const_iterator it;
+				for (it = active[k].begin(); it != active[k].end(); ++it)
+				{
+					if (BP_overlap(proxy, *it))
+					{
+						if (begin)
+						{
+							callBeginOverlap(proxy->getObject(), (*it)->getObject());
+						}
+						else
+						{
+							callEndOverlap(proxy->getObject(), (*it)->getObject());
+						}
+					}
+				}
+			}
+			active[is_marked].push_back(proxy);
+		}
+		else 
+		{
+			BP_SAPProxy::T_ProxyList& overlapping = active[is_marked];
+			*std::find(overlapping.begin(), overlapping.end(), proxy) = overlapping.back();
+			overlapping.pop_back();
+		}
+	}
+}
+
+void BP_SAPScene::beginUpdate()
+{
+	assert(!m_updating);
+	m_updating = true;
+}
+
+void BP_SAPScene::commitUpdate()
+{
+	assert(m_updating);
+	applyDeferred();
+	m_updating = false;
+}
+
+void BP_SAPScene::applyDeferred()
+{
+	if (m_deferred.empty())
+	{
+		return;
+	}
+
+	std::vector<BP_SAPProxy *>::iterator it;
+
+	// Sorting touches every endpoint, so for a handful of proxies it is 
+	// cheaper to move them one at a time.
+	if (m_deferred.size() * MIN_DEFERRED_RATIO < m_endpointList[0].size())
+	{
+		for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+		{
+			(*it)->moveDeferredBBox();
+		}
+	}
+	else 
+	{
+		for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+		{
+			(*it)->applyDeferredBBox();
+		}
+
+		static T_Overlap overlap[3] = { updateOverlapYZ, updateOverlapXZ, updateOverlapXY };
+
+		int i;
+		for (i = 0; i < 3; ++i) 
+		{
+			m_endpointList[i].sort(m_pairs, overlap[i]);
+		}
+
+		// A pair may have passed each other on several axes, so compare the 
+		// overlap status before and after the update only once per pair.
+		std::sort(m_pairs.begin(), m_pairs.end());
+		BP_ProxyPairList::iterator last = std::unique(m_pairs.begin(), m_pairs.end());
+
+		BP_ProxyPairList::iterator jt;
+		for (jt = m_pairs.begin(); jt != last; ++jt)
+		{
+			bool prev = BP_prevOverlap((*jt).first, (*jt).second);
+			if (prev != BP_overlap((*jt).first, (*jt).second))
+			{
+				if (prev)
+				{
+					callEndOverlap((*jt).first->getObject(), (*jt).second->getObject());
+				}
+				else 
+				{
+					callBeginOverlap((*jt).first->getObject(), (*jt).second->getObject());
+				}
+			}
+		}
+
+		for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+		{
+			(*it)->releaseDeferredBBox();
+		}
+
+		m_pairs.clear();
+	}
+
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		updateParkedPairs(*it);
+	}
+
+	m_deferred.clear();
+}
+
+void BP_SAPScene::setMode(BP_SAPProxy *proxy, DT_ProxyMode mode)
+{
+	if (proxy->m_mode == mode)
+	{
+		return;
+	}
+
+	applyDeferred();
+
+	bool was_dynamic = proxy->isDynamic();
+	proxy->m_mode = mode;
+	
+	if (was_dynamic)
+	{
+		park(proxy);
+	}
+	else if (mode == DT_DYNAMIC)
+	{
+		unpark(proxy);
+	}
+}
+
+void BP_SAPScene::park(BP_SAPProxy *proxy)
+{
+	// End the pairs with the proxies that are already parked.
+	setOverlaps(proxy);
+
+	// The pairs with dynamic proxies carry over without any callbacks.
+	proxy->remove(m_proxies);
+
+	BP_ProxyList::iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+	{
+		if ((*it).second == 3)
+		{
+			BP_SAPProxy::T_ProxyList& overlaps = (*it).first->m_overlaps;
+			overlaps.insert(std::lower_bound(overlaps.begin(), overlaps.end(), proxy), proxy);
+			proxy->m_overlaps.push_back((*it).first);
+		}
+	}
+
+	m_proxies.clear();
+
+	DT_Vector3 min, max;
+	proxy->getBounds(min, max);
+	proxy->m_leaf = m_parked.createLeaf(proxy, min, max);
+}
+
+void BP_SAPScene::unpark(BP_SAPProxy *proxy)
+{
+	m_parked.destroyLeaf(proxy->m_leaf);
+	proxy->m_leaf = -1;
+
+	proxy->add(m_proxies);
+
+	BP_ProxyList::iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+	{
+		if ((*it).second == 3)
+		{
+			m_overlaps.push_back((*it).first);
+		}
+	}
+
+	m_proxies.clear();
+
+	// The pairs with dynamic proxies are maintained by the endpoint lists 
+	// from now on, so they are dropped from the overlap lists once the 
+	// callbacks are settled.
+	setOverlaps(proxy);
+
+	BP_SAPProxy::T_ProxyList::iterator jt;
+	for (jt = proxy->m_overlaps.begin(); jt != proxy->m_overlaps.end(); ++jt)
+	{
+		BP_SAPProxy::T_ProxyList& overlaps = (*jt)->m_overlaps;
+		overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+	}
+
+	proxy->m_overlaps.clear();
+
+	updateParkedPairs(proxy);
+}
+
+void BP_SAPScene::moveParked(BP_SAPProxy *proxy, const DT_Vector3 min, const DT_Vector3 max)
+{
+	if (proxy->m_mode == DT_SLEEPING)
+	{
+		setMode(proxy, DT_DYNAMIC);
+		proxy->setBBox(min, max);
+		return;
+	}
+
+	proxy->setKeys(min, max);
+
+	DT_Vector3 bounds_min, bounds_max;
+	proxy->getBounds(bounds_min, bounds_max);
+	m_parked.moveLeaf(proxy->m_leaf, bounds_min, bounds_max);
+	
+	updateDynamicPairs(proxy);
+}
+
+void BP_SAPScene::updateParkedPairs(BP_SAPProxy *proxy)
+{
+	if (m_parked.empty() && proxy->m_overlaps.empty())
+	{
+		return;
+	}
+
+	DT_Vector3 min, max;
+	proxy->getBounds(min, max);
+	m_parked.query(min, max, m_candidates);
+
+	BP_BoxTree::T_ProxyList::const_iterator it;
+	for (it = m_candidates.begin(); it != m_candidates.end(); ++it)
+	{
+		BP_SAPProxy *other = static_cast<BP_SAPProxy *>(*it);
+		if (BP_overlap(proxy, other))
+		{
+			m_overlaps.push_back(other);
+		}
+	}
+
+	m_candidates.clear();
+
+	std::sort(m_overlaps.begin(), m_overlaps.end());
+	setOverlaps(proxy);
+}
+
+void BP_SAPScene::updateDynamicPairs(BP_SAPProxy *proxy)
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		DT_Index first, last;
+		m_endpointList[i].range(proxy->getMin(i), proxy->getMax(i), first, last, m_proxies);
+	}
+
+	BP_ProxyList::iterator it;
+	for (it = m_proxies.begin(); it != m_proxies.end(); ++it)
+	{
+		if ((*it).second == 3)
+		{
+			m_overlaps.push_back((*it).first);
+		}
+	}
+
+	m_proxies.clear();
+
+	setOverlaps(proxy);
+}
+
+// Replaces the overlap list of the proxy by the sorted list in 'm_overlaps', 
+// and calls the callbacks for the pairs that were added or removed.
+
+void BP_SAPScene::setOverlaps(BP_SAPProxy *proxy)
+{
+	BP_SAPProxy::T_ProxyList& prev = proxy->m_overlaps;
+
+	BP_SAPProxy::T_ProxyList::iterator it = prev.begin();
+	BP_SAPProxy::T_ProxyList::iterator jt = m_overlaps.begin();
+	while (it != prev.end() || jt != m_overlaps.end())
+	{
+		if (jt == m_overlaps.end() || (it != prev.end() && *it < *jt))
+		{
+			BP_SAPProxy::T_ProxyList& overlaps = (*it)->m_overlaps;
+			overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+			callEndOverlap(proxy->getObject(), (*it)->getObject());
+			++it;
+		}
+		else if (it == prev.end() || *jt < *it)
+		{
+			BP_SAPProxy::T_ProxyList& overlaps = (*jt)->m_overlaps;
+			overlaps.insert(std::lower_bound(overlaps.begin(), overlaps.end(), proxy), proxy);
+			callBeginOverlap(proxy->getObject(), (*jt)->getObject());
+			++jt;
+		}
+		else
+		{
+			++it;
+			++jt;
+		}
+	}
+
+	prev.swap(m_overlaps);
+	m_overlaps.clear();
+}
+
+void *BP_SAPScene::rayCast(BP_RayCastCallback objectRayCast,
+						void *client_data,
+						const DT_Vector3 source, 
+						const DT_Vector3 target, 
+						DT_Scalar& lambda) const 
+{
+	void *client_object = 0;
+	
+	// The proxies that contain the current point of the ray on some axes
+	BP_ProxyList proxies;
+
+	DT_Index index[3];
+	index[0] = m_endpointList[0].stab(source[0], proxies);
+	index[1] = m_endpointList[1].stab(source[1], proxies);
+	index[2] = m_endpointList[2].stab(source[2], proxies);
+
+	BP_ProxyList::iterator it;
+	for (it = proxies.begin(); it != proxies.end(); ++it) 
+	{
+		if ((*it).second == 3 &&
+            (*objectRayCast)(client_data, (*it).first->getObject(), source, target, &lambda))
+		{
+			client_object = (*it).first->getObject();
+		}
+	}
+
+	DT_Vector3 delta;
+	delta[0] = target[0] - source[0];
+	delta[1] = target[1] - source[1];
+	delta[2] = target[2] - source[2];
+	
+	DT_Vector3 lambdas;
+	lambdas[0] = m_endpointList[0].nextLambda(index[0], source[0], delta[0]);
+	lambdas[1] = m_endpointList[1].nextLambda(index[1], source[1], delta[1]);
+	lambdas[2] = m_endpointList[2].nextLambda(index[2], source[2], delta[2]);
+	int closest = lambdas[0] < lambdas[1] ? (lambdas[0] < lambdas[2] ? 0 : 2) : (lambdas[1] < lambdas[2] ? 1 : 2);
+	
+	while (lambdas[closest] < lambda)
+	{
+		if (delta[closest] < 0.0f)
+		{
+			const BP_EndpointList& list = m_endpointList[closest];
+			DT_Index i = index[closest];
+
+			if (list.getType(i) == BP_Endpoint::MAXIMUM) 
+			{
+				it = proxies.add(list.getProxy(i));
+				if ((*it).second == 3 &&
+					(*objectRayCast)(client_data, (*it).first->getObject(), source, target, &lambda))
+				{
+					client_object = (*it).first->getObject();
+				}
+			}
+			else
+			{
+				proxies.remove(list.getProxy(i));
+			}
+		}
+		else 
+		{
+			const BP_EndpointList& list = m_endpointList[closest];
+			DT_Index i = index[closest] - 1;
+			
+			if (list.getType(i) == BP_Endpoint::MINIMUM) 
+			{
+				it = proxies.add(list.getProxy(i));
+				if ((*it).second == 3 &&
+					(*objectRayCast)(client_data, (*it).first->getObject(), source, target, &lambda))
+				{
+					client_object = (*it).first->getObject();
+				}
+			}
+			else
+			{
+				proxies.remove(list.getProxy(i));
+			}
+		}
+
+		lambdas[closest] = m_endpointList[closest].nextLambda(index[closest], source[closest], delta[closest]);
+		closest = lambdas[0] < lambdas[1] ?	(lambdas[0] < lambdas[2] ? 0 : 2) : (lambdas[1] < lambdas[2] ? 1 : 2);
+	}
+
+	if (!m_parked.empty())
+	{
+		BP_Proxy *proxy = m_parked.rayCast(objectRayCast, client_data, source, target, lambda);
+		if (proxy)
+		{
+			client_object = proxy->getObject();
+		}
+	}
+
+	return client_object;
+}
+
+
@@ -0,0 +1,112 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_SAPSCENE_H
+#define BP_SAPSCENE_H
+
+#include "BP_Scene.h"
+#include "BP_SAPProxy.h"
+#include "BP_EndpointList.h"
+#include "BP_ProxyList.h"
+#include "BP_BoxTree.h"
+
+// Three-axis sweep and prune
+
+class BP_SAPScene : public BP_Scene {
+	enum { MIN_DEFERRED_RATIO = 16 };
+public:
+    BP_SAPScene(void *client_data,
+				BP_Callback beginOverlap,
+				BP_Callback endOverlap) 
+      :	BP_Scene(client_data, beginOverlap, endOverlap),
+		m_proxies(20),
+		m_updating(false)
+	{
+		int i;
+		for (i = 0; i < 3; ++i) 
+		{
+			m_endpointList[i].setAxis(i);
+		}
+	}
+
+    virtual BP_SAPProxy *createProxy(void *object, 
+									 const DT_Vector3 min,
+									 const DT_Vector3 max);
+
+    virtual void destroyProxy(BP_Proxy *proxy);
+
+	virtual void createProxies(DT_Size count,
+							   void *const *objects, 
+							   const DT_Vector3 *min,
+							   const DT_Vector3 *max,
+							   DT_ProxyMode mode,
+							   BP_Proxy **proxies);
+
+	virtual void destroyProxies(DT_Size count, BP_Proxy *const *proxies);
+	
+	// Between 'beginUpdate' and 'commitUpdate' new bounds are only recorded.
+	// The commit sorts each endpoint list once and reports the overlap
+	// changes for all moved proxies in bulk.
+	virtual void beginUpdate();
+	virtual void commitUpdate();
+
+	bool isUpdating() const { return m_updating; }
+
+	void addDeferred(BP_SAPProxy *proxy) { m_deferred.push_back(proxy); }
+
+	// Static and sleeping proxies are parked in a box tree, which is only 
+	// queried for the dynamic proxies that move. Pairs in which neither 
+	// proxy is dynamic are not maintained. Moving a sleeping proxy wakes it.
+	void setMode(BP_SAPProxy *proxy, DT_ProxyMode mode);
+	void moveParked(BP_SAPProxy *proxy, const DT_Vector3 min, const DT_Vector3 max);
+	void updateParkedPairs(BP_SAPProxy *proxy);
+
+	virtual void *rayCast(BP_RayCastCallback objectRayCast,
+						  void *client_data,
+						  const DT_Vector3 source, 
+						  const DT_Vector3 target, 
+						  DT_Scalar& lambda) const;
+	
+	BP_EndpointList& getList(int i) { return m_endpointList[i]; }
+
+private:
+	void applyDeferred();
+	void sweep(const BP_SAPProxy::T_ProxyList& marked, bool begin);
+
+	void park(BP_SAPProxy *proxy);
+	void unpark(BP_SAPProxy *proxy);
+	void updateDynamicPairs(BP_SAPProxy *proxy);
+	void setOverlaps(BP_SAPProxy *proxy);
+
+    BP_EndpointList             m_endpointList[3];
+	BP_ProxyList                m_proxies;
+	std::vector<BP_SAPProxy *>  m_deferred;
+	BP_ProxyPairList            m_pairs;
+	bool                        m_updating;
+
+	BP_BoxTree                  m_parked;
+	BP_BoxTree::T_ProxyList     m_candidates;
+	BP_SAPProxy::T_ProxyList    m_overlaps;
+};
+
+#endif
@@ -26,10 +26,10 @@
 
 #include <SOLID_broad.h>
 
-#include "BP_EndpointList.h"
-#include "BP_ProxyList.h"
+#include "BP_Proxy.h"
 
-class BP_Proxy;
+// Common interface of the broad phase algorithms. A scene reports the pairs 
+// of proxies whose boxes start and stop overlapping through the callbacks.
 
 class BP_Scene {
 public:
@@ -38,23 +38,36 @@ public:
 			 BP_Callback endOverlap) 
       :	m_client_data(client_data),
 		m_beginOverlap(beginOverlap),
-		m_endOverlap(endOverlap),
-		m_proxies(20)
+		m_endOverlap(endOverlap)
 	{}
 
-    ~BP_Scene() {}
+    virtual ~BP_Scene() {}
 
-    BP_Proxy *createProxy(void *object, 
-						  const DT_Vector3 min,
-						  const DT_Vector3 max);
+    virtual BP_Proxy *createProxy(void *object, 
+								  const DT_Vector3 min,
+								  const DT_Vector3 max) = 0;
 
-    void destroyProxy(BP_Proxy *proxy);
+    virtual void destroyProxy(BP_Proxy *proxy) = 0;
+
+	// Scenes that can insert or remove many proxies at once faster than one 
+	// by one override these.
+	virtual void createProxies(DT_Size count,
+							   void *const *objects, 
+							   const DT_Vector3 *min,
+							   const DT_Vector3 *max,
+							   DT_ProxyMode mode,
+							   BP_Proxy **proxies);
+
+	virtual void destroyProxies(DT_Size count, BP_Proxy *const *proxies);
+
+	virtual void beginUpdate() = 0;
+	virtual void commitUpdate() = 0;
 	
-	void *rayCast(BP_RayCastCallback objectRayCast,
-				  void *client_data,
-				  const DT_Vector3 source, 
-				  const DT_Vector3 target, 
-				  DT_Scalar& lambda) const;
+	virtual void *rayCast(BP_RayCastCallback objectRayCast,
+						  void *client_data,
+						  const DT_Vector3 source, 
+						  const DT_Vector3 target, 
+						  DT_Scalar& lambda) const = 0;
 	
   	void callBeginOverlap(void *object1, void *object2) 
 	{
@@ -65,15 +78,38 @@ public:
 	{
 		(*m_endOverlap)(m_client_data, object1, object2);
 	}
-	
-	BP_EndpointList& getList(int i) { return m_endpointList[i]; }
 
 private:
 	void                    *m_client_data;
 	BP_Callback              m_beginOverlap; 
 	BP_Callback              m_endOverlap; 
-    BP_EndpointList          m_endpointList[3];
-	mutable BP_ProxyList     m_proxies;
 };
 
+inline void BP_Scene::createProxies(DT_Size count,
+									void *const *objects, 
+									const DT_Vector3 *min,
+									const DT_Vector3 *max,
+									DT_ProxyMode mode,
+									BP_Proxy **proxies)
+{
+	DT_Size i;
+	for (i = 0; i != count; ++i)
+	{
+		proxies[i] = createProxy(objects[i], min[i], max[i]);
+		if (mode != DT_DYNAMIC)
+		{
+			proxies[i]->setMode(mode);
+		}
+	}
+}
+
+inline void BP_Scene::destroyProxies(DT_Size count, BP_Proxy *const *proxies)
+{
+	DT_Size i;
+	for (i = 0; i != count; ++i)
+	{
+		destroyProxy(proxies[i]);
+	}
+}
+
 #endif
@@ -0,0 +1,219 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include <assert.h>
+#include <algorithm>
+
+#include "BP_TreeScene.h"
+
+BP_TreeProxy::BP_TreeProxy(void *object, BP_TreeScene& scene, 
+						   const DT_Vector3 min, const DT_Vector3 max)
+  : BP_Proxy(object),
+	m_leaf(-1),
+	m_deferred(false),
+	m_scene(scene)
+{
+	setBounds(min, max);
+}
+
+void BP_TreeProxy::setBBox(const DT_Vector3 min, const DT_Vector3 max)
+{
+	m_scene.setBBox(this, min, max);
+}
+
+BP_TreeScene::BP_TreeScene(void *client_data,
+						   BP_Callback beginOverlap,
+						   BP_Callback endOverlap,
+						   DT_Scalar margin) 
+  :	BP_Scene(client_data, beginOverlap, endOverlap),
+	m_margin(margin),
+	m_updating(false)
+{}
+
+BP_TreeProxy *BP_TreeScene::createProxy(void *object, 
+										const DT_Vector3 min,
+										const DT_Vector3 max)
+{
+	BP_TreeProxy *proxy = new BP_TreeProxy(object, *this, min, max);
+	
+	DT_Vector3 fat_min, fat_max;
+	enlarge(proxy, fat_min, fat_max);
+	proxy->m_leaf = m_tree.createLeaf(proxy, fat_min, fat_max);
+	
+	updatePairs(proxy);
+
+	return proxy;
+}
+
+void BP_TreeScene::destroyProxy(BP_Proxy *p)
+{
+	BP_TreeProxy *proxy = static_cast<BP_TreeProxy *>(p);
+
+	if (proxy->m_deferred)
+	{
+		m_deferred.erase(std::find(m_deferred.begin(), m_deferred.end(), proxy));
+	}
+
+	BP_TreeProxy::T_ProxyList::iterator it;
+	for (it = proxy->m_overlaps.begin(); it != proxy->m_overlaps.end(); ++it)
+	{
+		BP_TreeProxy::T_ProxyList& overlaps = (*it)->m_overlaps;
+		overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+		callEndOverlap(proxy->getObject(), (*it)->getObject());
+	}
+
+	m_tree.destroyLeaf(proxy->m_leaf);
+	
+	delete proxy;
+}
+
+void BP_TreeScene::setBBox(BP_TreeProxy *proxy, const DT_Vector3 min, const DT_Vector3 max)
+{
+	proxy->setBounds(min, max);
+
+	if (m_updating)
+	{
+		if (!proxy->m_deferred)
+		{
+			proxy->m_deferred = true;
+			m_deferred.push_back(proxy);
+		}
+	}
+	else 
+	{
+		moveLeaf(proxy);
+		updatePairs(proxy);
+	}
+}
+
+void BP_TreeScene::beginUpdate()
+{
+	assert(!m_updating);
+	m_updating = true;
+}
+
+void BP_TreeScene::commitUpdate()
+{
+	assert(m_updating);
+	m_updating = false;
+
+	// First bring the tree up to date, so that the pairs are computed from 
+	// the new boxes only.
+	std::vector<BP_TreeProxy *>::iterator it;
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		moveLeaf(*it);
+	}
+
+	for (it = m_deferred.begin(); it != m_deferred.end(); ++it)
+	{
+		(*it)->m_deferred = false;
+		updatePairs(*it);
+	}
+
+	m_deferred.clear();
+}
+
+void BP_TreeScene::enlarge(const BP_TreeProxy *proxy, DT_Vector3 min, DT_Vector3 max) const
+{
+	int i;
+	for (i = 0; i < 3; ++i) 
+	{
+		min[i] = proxy->m_min[i] - m_margin;
+		max[i] = proxy->m_max[i] + m_margin;
+	}
+}
+
+void BP_TreeScene::moveLeaf(BP_TreeProxy *proxy)
+{
+	if (!m_tree.contains(proxy->m_leaf, proxy->m_min, proxy->m_max))
+	{
+		DT_Vector3 min, max;
+		enlarge(proxy, min, max);
+		m_tree.moveLeaf(proxy->m_leaf, min, max);
+	}
+}
+
+void BP_TreeScene::updatePairs(BP_TreeProxy *proxy)
+{
+	query(proxy, m_overlaps);
+	std::sort(m_overlaps.begin(), m_overlaps.end());
+	
+	BP_TreeProxy::T_ProxyList& prev = proxy->m_overlaps;
+
+	// Merge the sorted lists of old and new overlaps
+	BP_TreeProxy::T_ProxyList::iterator it = prev.begin();
+	BP_TreeProxy::T_ProxyList::iterator jt = m_overlaps.begin();
+	while (it != prev.end() || jt != m_overlaps.end())
+	{
+		if (jt == m_overlaps.end() || (it != prev.end() && *it < *jt))
+		{
+			BP_TreeProxy::T_ProxyList& overlaps = (*it)->m_overlaps;
+			overlaps.erase(std::lower_bound(overlaps.begin(), overlaps.end(), proxy));
+			callEndOverlap(proxy->getObject(), (*it)->getObject());
+			++it;
+		}
+		else if (it == prev.end() || *jt < *it)
+		{
+			BP_TreeProxy::T_ProxyList& overlaps = (*jt)->m_overlaps;
+			overlaps.insert(std::lower_bound(overlaps.begin(), overlaps.end(), proxy), proxy);
+			callBeginOverlap(proxy->getObject(), (*jt)->getObject());
+			++jt;
+		}
+		else
+		{
+			++it;
+			++jt;
+		}
+	}
+
+	prev.swap(m_overlaps);
+	m_overlaps.clear();
+}
+
+void BP_TreeScene::query(const BP_TreeProxy *proxy, BP_TreeProxy::T_ProxyList& result)
+{
+	m_tree.query(proxy->m_min, proxy->m_max, m_candidates);
+
+	BP_BoxTree::T_ProxyList::const_iterator it;
+	for (it = m_candidates.begin(); it != m_candidates.end(); ++it)
+	{
+		BP_TreeProxy *other = static_cast<BP_TreeProxy *>(*it);
+		if (other != proxy && other->overlaps(*proxy))
+		{
+			result.push_back(other);
+		}
+	}
+
+	m_candidates.clear();
+}
+
+void *BP_TreeScene::rayCast(BP_RayCastCallback objectRayCast,
+							void *client_data,
+							const DT_Vector3 source, 
+							const DT_Vector3 target, 
+							DT_Scalar& lambda) const
+{
+	BP_Proxy *proxy = m_tree.rayCast(objectRayCast, client_data, source, target, lambda);
+	return proxy ? proxy->getObject() : 0;
+}
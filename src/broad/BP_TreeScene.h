@@ -0,0 +1,117 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef BP_TREESCENE_H
+#define BP_TREESCENE_H
+
+#include <vector>
+
+#include "BP_Scene.h"
+#include "BP_Proxy.h"
+#include "BP_BoxTree.h"
+
+class BP_TreeScene;
+
+class BP_TreeProxy : public BP_Proxy {
+public:
+	typedef std::vector<BP_TreeProxy *> T_ProxyList;
+
+	BP_TreeProxy(void *object, BP_TreeScene& scene, 
+				 const DT_Vector3 min, const DT_Vector3 max);
+
+	virtual void setBBox(const DT_Vector3 min, const DT_Vector3 max);
+
+	void setBounds(const DT_Vector3 min, const DT_Vector3 max)
+	{
+		int i;
+		for (i = 0; i < 3; ++i) 
+		{
+			m_min[i] = min[i];
+			m_max[i] = max[i];
+		}
+	}
+
+	bool overlaps(const BP_TreeProxy& other) const
+	{
+		return m_min[0] <= other.m_max[0] && other.m_min[0] <= m_max[0] && 
+			   m_min[1] <= other.m_max[1] && other.m_min[1] <= m_max[1] &&
+			   m_min[2] <= other.m_max[2] && other.m_min[2] <= m_max[2];
+	}
+
+	DT_Vector3   m_min;
+	DT_Vector3   m_max;
+	int          m_leaf;
+	bool         m_deferred;
+
+	// The proxies whose boxes currently overlap this one, sorted by address
+	T_ProxyList  m_overlaps;
+
+private:
+	BP_TreeScene& m_scene;
+};
+
+// Dynamic bounding volume tree. The leaves hold the boxes of the proxies 
+// enlarged by a margin, so that a proxy only has to be reinserted after it 
+// leaves its enlarged box. The tree is kept balanced by rotations as leaves 
+// are inserted and removed. The overlapping pairs are found by querying the 
+// tree for each proxy that moved.
+
+class BP_TreeScene : public BP_Scene {
+public:
+    BP_TreeScene(void *client_data,
+				 BP_Callback beginOverlap,
+				 BP_Callback endOverlap,
+				 DT_Scalar margin);
+
+    virtual BP_TreeProxy *createProxy(void *object, 
+									  const DT_Vector3 min,
+									  const DT_Vector3 max);
+
+    virtual void destroyProxy(BP_Proxy *proxy);
+
+	virtual void beginUpdate();
+	virtual void commitUpdate();
+
+	virtual void *rayCast(BP_RayCastCallback objectRayCast,
+						  void *client_data,
+						  const DT_Vector3 source, 
+						  const DT_Vector3 target, 
+						  DT_Scalar& lambda) const;
+
+	void setBBox(BP_TreeProxy *proxy, const DT_Vector3 min, const DT_Vector3 max);
+
+private:
+	void enlarge(const BP_TreeProxy *proxy, DT_Vector3 min, DT_Vector3 max) const;
+	void moveLeaf(BP_TreeProxy *proxy);
+	void updatePairs(BP_TreeProxy *proxy);
+	void query(const BP_TreeProxy *proxy, BP_TreeProxy::T_ProxyList& result);
+
+	DT_Scalar                    m_margin;
+	BP_BoxTree                   m_tree;
+	std::vector<BP_TreeProxy *>  m_deferred;
+	BP_BoxTree::T_ProxyList      m_candidates;
+	BP_TreeProxy::T_ProxyList    m_overlaps;
+	bool                         m_updating;
+};
+
+#endif
@@ -22,6 +22,16 @@
  */
 
 #include "DT_BBoxTree.h"
+#include "GEN_MinMax.h"
+
+// Tasks came with OpenMP 3.0
+#if defined(_OPENMP) && _OPENMP >= 200805
+#define PARALLEL_BUILD
+#endif
+
+#ifdef STATISTICS
+int num_box_tests = 0;
+#endif
 
 inline DT_CBox getBBox(int first, int last, const DT_CBox *boxes, const DT_Index *indices) 
 {
@@ -37,10 +47,9 @@ inline DT_CBox getBBox(int first, int last, const DT_CBox *boxes, const DT_Index
 	return bbox;
 }
 
-DT_BBoxNode::DT_BBoxNode(int first, int last, int& node, DT_BBoxNode *free_nodes, const DT_CBox *boxes, DT_Index *indices, const DT_CBox& bbox)
+// Splits at the center of the longest axis of the box
+static int splitCenter(int first, int last, const DT_CBox *boxes, DT_Index *indices, const DT_CBox& bbox)
 {
-	assert(last - first >= 2);
-	
 	int axis = bbox.longestAxis();
 	MT_Scalar abscissa = bbox.getCenter()[axis];
 	int i = first, mid = last;
@@ -61,30 +70,278 @@ DT_BBoxNode::DT_BBoxNode(int first, int last, int& node, DT_BBoxNode *free_nodes
 	{
 		mid = (first + last) / 2;
 	}
+
+	return mid;
+}
+
+static const int NUM_BINS = 16;
+
+// Half the surface area of a box
+inline MT_Scalar area(const MT_BBox& bbox)
+{
+	MT_Vector3 e = bbox.getExtent();
+	return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+}
+
+inline int bin(MT_Scalar c, MT_Scalar lower, MT_Scalar scale)
+{
+	return GEN_min(int((c - lower) * scale), NUM_BINS - 1);
+}
+
+// Splits by the surface area heuristic. The centers of the boxes are put in 
+// bins along each axis. Of the planes between the bins, the one with the least 
+// sum over both sides of the number of boxes times the area of their hull is 
+// taken.
+static int splitSAH(int first, int last, const DT_CBox *boxes, DT_Index *indices)
+{
+	MT_BBox centers(boxes[indices[first]].getCenter());
+	int i;
+	for (i = first + 1; i < last; ++i)
+	{
+		centers = centers.hull(MT_BBox(boxes[indices[i]].getCenter()));
+	}
+	MT_Point3 lower = centers.getMin();
+	MT_Vector3 extent = centers.getExtent();
+
+	MT_Scalar best_cost = MT_INFINITY;
+	int best_axis = -1;
+	int best_bin = 0;
+
+	int axis;
+	for (axis = 0; axis != 3; ++axis)
+	{
+		if (extent[axis] <= MT_Scalar(0.0))
+		{
+			continue;
+		}
+
+		MT_Scalar scale = MT_Scalar(NUM_BINS) / (MT_Scalar(2.0) * extent[axis]);
+
+		int     count[NUM_BINS];
+		MT_BBox bounds[NUM_BINS];
+		int b;
+		for (b = 0; b != NUM_BINS; ++b)
+		{
+			count[b] = 0;
+		}
+
+		for (i = first; i < last; ++i)
+		{
+			const DT_CBox& box = boxes[indices[i]];
+			b = bin(box.getCenter()[axis], lower[axis], scale);
+			bounds[b] = count[b] == 0 ? box.get() : bounds[b].hull(box.get());
+			++count[b];
+		}
+
+		// The right sides, from the last bin down
+		int       right_count[NUM_BINS];
+		MT_Scalar right_area[NUM_BINS];
+		MT_BBox   right;
+		int n = 0;
+		for (b = NUM_BINS - 1; b > 0; --b)
+		{
+			if (count[b] != 0)
+			{
+				right = n == 0 ? bounds[b] : right.hull(bounds[b]);
+				n += count[b];
+			}
+			right_count[b] = n;
+			right_area[b] = n == 0 ? MT_Scalar(0.0) : area(right);
+		}
+
+		MT_BBox left;
+		n = 0;
+		for (b = 1; b != NUM_BINS; ++b)
+		{
+			if (count[b - 1] != 0)
+			{
+				left = n == 0 ? bounds[b - 1] : left.hull(bounds[b - 1]);
+				n += count[b - 1];
+			}
+
+			if (n != 0 && right_count[b] != 0)
+			{
+				MT_Scalar cost = MT_Scalar(n) * area(left) + MT_Scalar(right_count[b]) * right_area[b];
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = b;
+				}
+			}
+		}
+	}
+
+	if (best_axis == -1)
+	{
+		// All centers coincide
+		return (first + last) / 2;
+	}
+
+	MT_Scalar scale = MT_Scalar(NUM_BINS) / (MT_Scalar(2.0) * extent[best_axis]);
+	int mid = last;
+	i = first;
+	while (i < mid) 
+	{
+		if (bin(boxes[indices[i]].getCenter()[best_axis], lower[best_axis], scale) < best_bin)
+		{
+			++i;
+		}
+		else
+		{
+			--mid;
+			std::swap(indices[i], indices[mid]);
+		}
+	}
+
+	if (mid == first || mid == last) 
+	{
+		mid = (first + last) / 2;
+	}
+
+	return mid;
+}
+
+// The number of quanta from 'lower' to 'x', rounded down
+inline int steps(MT_Scalar x, MT_Scalar lower, MT_Scalar quantum)
+{
+	return quantum > MT_Scalar(0.0) && x > lower ? 
+		   GEN_min(int((x - lower) / quantum), int(DT_BBoxNode::QUANTA)) : 
+		   0;
+}
+
+DT_CBox DT_Quantizer::quantize(const DT_CBox& box, unsigned short q[6]) const
+{
+	MT_BBox bbox = box.get();
+	MT_Point3 min = bbox.getMin();
+	MT_Point3 max = bbox.getMax();
+
+	int i;
+	for (i = 0; i != 3; ++i)
+	{
+		q[i] = (unsigned short)steps(min[i], m_lower[i], m_quantum[i]);
+		q[3 + i] = (unsigned short)(DT_BBoxNode::QUANTA - steps(m_upper[i], max[i], m_quantum[i]));
+	}
+
+	// Rounding errors in the dequantization are taken up by moving out 
+	// another quantum.
+	DT_CBox result = dequantize(q);
+	bool moved = true;
+	while (moved) 
+	{
+		moved = false;
+		for (i = 0; i != 3; ++i)
+		{
+			if (result.getCenter()[i] - result.getExtent()[i] > min[i] && q[i] > 0)
+			{
+				--q[i];
+				moved = true;
+			}
+			if (result.getCenter()[i] + result.getExtent()[i] < max[i] && q[3 + i] < DT_BBoxNode::QUANTA)
+			{
+				++q[3 + i];
+				moved = true;
+			}
+		}
+		if (moved)
+		{
+			result = dequantize(q);
+		}
+	}
 	
-	m_lbox = getBBox(first, mid, boxes, indices);
-	m_rbox = getBBox(mid, last, boxes, indices);
-	m_flags = 0x0;
+	return result;
+}
+
+void DT_BBoxNode::setBoxes(const DT_CBox& bounds, const DT_CBox& lbox, const DT_CBox& rbox, 
+						   DT_CBox& lbounds, DT_CBox& rbounds)
+{
+	DT_Quantizer quantizer(bounds);
+	lbounds = quantizer.quantize(lbox, m_lbox);
+	rbounds = quantizer.quantize(rbox, m_rbox);
+}
+
+#ifdef PARALLEL_BUILD
+
+// Subtrees of at least this many leaves are built as separate tasks
+static const int PARALLEL_BUILD_SIZE = 4096;
+
+#endif
+
+static void buildNode(DT_BBoxNode *nodes, int node, int first, int last, const DT_CBox *boxes, DT_Index *indices, 
+					  const DT_CBox& bbox, const DT_CBox& bounds, DT_BuildQuality quality)
+{
+#ifdef PARALLEL_BUILD
+	if (last - first >= PARALLEL_BUILD_SIZE)
+	{
+		DT_CBox task_bbox = bbox;
+		DT_CBox task_bounds = bounds;
+#pragma omp task firstprivate(nodes, node, first, last, boxes, indices, task_bbox, task_bounds, quality)
+		new(&nodes[node]) DT_BBoxNode(first, last, node, nodes, boxes, indices, task_bbox, task_bounds, quality);
+		return;
+	}
+#endif
+
+	new(&nodes[node]) DT_BBoxNode(first, last, node, nodes, boxes, indices, bbox, bounds, quality);
+}
+
+// The box 'bbox' of the node is used for splitting, 'bounds' is the box that 
+// a traversal dequantizes, on which the children are quantized. A subtree of 
+// k leaves has k - 1 nodes, which follow its root in the array. So, the 
+// places of both children are known up front, and the two subtrees can be 
+// built in any order, or at the same time.
+DT_BBoxNode::DT_BBoxNode(int first, int last, int node, DT_BBoxNode *nodes, const DT_CBox *boxes, DT_Index *indices, 
+						 const DT_CBox& bbox, const DT_CBox& bounds, DT_BuildQuality quality)
+{
+	assert(last - first >= 2);
+	
+	int mid = quality == DT_SAH_BUILD ? 
+			  splitSAH(first, last, boxes, indices) :
+			  splitCenter(first, last, boxes, indices, bbox);
+	
+	DT_CBox lbox = getBBox(first, mid, boxes, indices);
+	DT_CBox rbox = getBBox(mid, last, boxes, indices);
+	DT_CBox lbounds, rbounds;
+	setBoxes(bounds, lbox, rbox, lbounds, rbounds);
 
 	if (mid - first == 1)
 	{
-		m_flags |= LLEAF;
-		m_lchild = indices[first];
+		m_lchild = indices[first] | LEAF;
 	}
 	else 
 	{	
-		m_lchild = node++;
-		new(&free_nodes[m_lchild]) DT_BBoxNode(first, mid, node, free_nodes, boxes, indices, m_lbox);
+		m_lchild = node + 1;
+		buildNode(nodes, m_lchild, first, mid, boxes, indices, lbox, lbounds, quality);
 	}
 
 	if (last - mid == 1)
 	{
-		m_flags |= RLEAF;
-		m_rchild = indices[mid];
+		m_rchild = indices[mid] | LEAF;
 	}
 	else 
 	{
-		m_rchild = node++;
-		new(&free_nodes[m_rchild]) DT_BBoxNode(mid, last, node, free_nodes, boxes, indices, m_rbox); 
+		m_rchild = node + mid - first;
+		buildNode(nodes, m_rchild, mid, last, boxes, indices, rbox, rbounds, quality);
+	}
+}
+
+void buildTree(DT_Count n, DT_BBoxNode *nodes, const DT_CBox *boxes, DT_Index *indices, const DT_CBox& bbox, 
+			   DT_BuildQuality quality)
+{
+	assert(n >= 2);
+
+#ifdef PARALLEL_BUILD
+	if (int(n) >= PARALLEL_BUILD_SIZE)
+	{
+		// The tasks of the subtrees are run by the team, and are done at the 
+		// end of the parallel region.
+#pragma omp parallel
+		{
+#pragma omp single
+			new(&nodes[0]) DT_BBoxNode(0, int(n), 0, nodes, boxes, indices, bbox, bbox, quality);
+		}
+		return;
 	}
+#endif
+
+	new(&nodes[0]) DT_BBoxNode(0, int(n), 0, nodes, boxes, indices, bbox, bbox, quality);
 }
@@ -27,6 +27,8 @@
 #include <new>
 #include <algorithm>
 
+#include "SOLID_types.h"
+
 #include "DT_Convex.h"
 #include "DT_CBox.h"
 
@@ -51,61 +53,145 @@ public:
     DT_BBoxTree() {}
     DT_BBoxTree(const DT_CBox& cbox, DT_Index index, NodeType type) 
       : m_cbox(cbox),
+        m_bounds(cbox),
+        m_index(index),
+        m_type(type)
+    {}
+
+    DT_BBoxTree(const DT_CBox& bounds, const DT_CBox& added, DT_Index index, NodeType type) 
+      : m_cbox(bounds + added),
+        m_bounds(bounds),
         m_index(index),
         m_type(type)
     {}
     
-    DT_CBox  m_cbox;
+    DT_CBox  m_cbox;    // The box that is tested, including the margin
+    DT_CBox  m_bounds;  // The box on which the children are quantized
     DT_Index m_index;
     NodeType m_type;
 };
 
 
+// A node holds the boxes of its children, quantized to 16 bits per coordinate
+// on the box of the node itself. The lower bounds are offsets from the lower
+// bound of the node, the upper bounds from the upper bound, and both are 
+// rounded outwards, so a child box covers its contents. A node takes 32 bytes,
+// which is two to a cache line.
 
 class DT_BBoxNode {
 public:
+    enum { QUANTA = 0xffff };
+    
     DT_BBoxNode() {}    
-    DT_BBoxNode(int first, int last, int& node, DT_BBoxNode *free_nodes, const DT_CBox *boxes, DT_Index *indices, const DT_CBox& bbox);
+    DT_BBoxNode(int first, int last, int node, DT_BBoxNode *nodes, const DT_CBox *boxes, DT_Index *indices, 
+                const DT_CBox& bbox, const DT_CBox& bounds, DT_BuildQuality quality = DT_FAST_BUILD);
+
+    void makeChildren(const DT_CBox& bounds, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const;
+    void makeChildren(const DT_CBox& bounds, const DT_CBox& added, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const;
 
-    void makeChildren(DT_BBoxTree& ltree, DT_BBoxTree& rtree) const;
-    void makeChildren(const DT_CBox& added, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const;
+    // Quantizes the boxes of the children on 'bounds'. The boxes as they are
+    // seen in a traversal are returned in 'lbounds' and 'rbounds'.
+    void setBoxes(const DT_CBox& bounds, const DT_CBox& lbox, const DT_CBox& rbox, 
+                  DT_CBox& lbounds, DT_CBox& rbounds);
+    void setLBox(const DT_CBox& bounds, const DT_CBox& lbox, DT_CBox& lbounds);
+    void setRBox(const DT_CBox& bounds, const DT_CBox& rbox, DT_CBox& rbounds);
 
-    DT_CBox hull() const { return m_lbox.hull(m_rbox); }  
+    void getBoxes(const DT_CBox& bounds, DT_CBox& lbounds, DT_CBox& rbounds) const;
     
-    enum FlagType { LLEAF = 0x80, RLEAF = 0x40 };
+    bool     isLLeaf() const { return (m_lchild & LEAF) != 0; }
+    bool     isRLeaf() const { return (m_rchild & LEAF) != 0; }
+    DT_Index lchild() const { return m_lchild & ~LEAF; }
+    DT_Index rchild() const { return m_rchild & ~LEAF; }
+
+private:
+    enum { LEAF = 0x80000000 };
+
+    unsigned short m_lbox[6];
+    unsigned short m_rbox[6];
+    DT_Index       m_lchild;
+    DT_Index       m_rchild;
+};
+
+// Builds the tree over the boxes of 'n' leaves in the 'n' - 1 nodes of 
+// 'nodes'. The leaf indices in 'indices' are reordered, 'bbox' is the hull of
+// the boxes. Large trees are built on all threads if OpenMP is on, into the 
+// same nodes as on a single thread.
+void buildTree(DT_Count n, DT_BBoxNode *nodes, const DT_CBox *boxes, DT_Index *indices, const DT_CBox& bbox, 
+               DT_BuildQuality quality);
+
+struct DT_Quantizer {
+    explicit DT_Quantizer(const DT_CBox& bounds)
+      : m_lower(bounds.getCenter() - bounds.getExtent()),
+        m_upper(bounds.getCenter() + bounds.getExtent()),
+        m_quantum(bounds.getExtent() * (MT_Scalar(2.0) / MT_Scalar(DT_BBoxNode::QUANTA)))
+    {}
+
+    DT_CBox dequantize(const unsigned short q[6]) const
+    {
+        MT_Point3 min(m_lower[0] + MT_Scalar(q[0]) * m_quantum[0],
+                      m_lower[1] + MT_Scalar(q[1]) * m_quantum[1],
+                      m_lower[2] + MT_Scalar(q[2]) * m_quantum[2]);
+        MT_Point3 max(m_upper[0] - MT_Scalar(DT_BBoxNode::QUANTA - q[3]) * m_quantum[0],
+                      m_upper[1] - MT_Scalar(DT_BBoxNode::QUANTA - q[4]) * m_quantum[1],
+                      m_upper[2] - MT_Scalar(DT_BBoxNode::QUANTA - q[5]) * m_quantum[2]);
+        return DT_CBox(min.lerp(max, MT_Scalar(0.5)), (max - min) * MT_Scalar(0.5));
+    }
+
+    DT_CBox quantize(const DT_CBox& box, unsigned short q[6]) const;
 
-    DT_CBox              m_lbox;
-    DT_CBox              m_rbox;
-    DT_Index             m_lchild;
-    DT_Index             m_rchild;
-    unsigned char        m_flags;
+    MT_Point3  m_lower;
+    MT_Point3  m_upper;
+    MT_Vector3 m_quantum;
 };
 
-inline void DT_BBoxNode::makeChildren(DT_BBoxTree& ltree, DT_BBoxTree& rtree) const
+inline void DT_BBoxNode::setLBox(const DT_CBox& bounds, const DT_CBox& lbox, DT_CBox& lbounds)
 {
-    new (&ltree) DT_BBoxTree(m_lbox, m_lchild, (m_flags & LLEAF) ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
-    new (&rtree) DT_BBoxTree(m_rbox, m_rchild, (m_flags & RLEAF) ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    lbounds = DT_Quantizer(bounds).quantize(lbox, m_lbox);
+}
+
+inline void DT_BBoxNode::setRBox(const DT_CBox& bounds, const DT_CBox& rbox, DT_CBox& rbounds)
+{
+    rbounds = DT_Quantizer(bounds).quantize(rbox, m_rbox);
+}
+
+inline void DT_BBoxNode::getBoxes(const DT_CBox& bounds, DT_CBox& lbounds, DT_CBox& rbounds) const
+{
+    DT_Quantizer quantizer(bounds);
+    lbounds = quantizer.dequantize(m_lbox);
+    rbounds = quantizer.dequantize(m_rbox);
+}
 
+inline void DT_BBoxNode::makeChildren(const DT_CBox& bounds, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const
+{
+    DT_Quantizer quantizer(bounds);
+    new (&ltree) DT_BBoxTree(quantizer.dequantize(m_lbox), lchild(), isLLeaf() ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    new (&rtree) DT_BBoxTree(quantizer.dequantize(m_rbox), rchild(), isRLeaf() ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
 }
 
-inline void DT_BBoxNode::makeChildren(const DT_CBox& added, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const
+inline void DT_BBoxNode::makeChildren(const DT_CBox& bounds, const DT_CBox& added, DT_BBoxTree& ltree, DT_BBoxTree& rtree) const
 { 
-    new (&ltree) DT_BBoxTree(m_lbox + added, m_lchild, (m_flags & LLEAF) ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
-    new (&rtree) DT_BBoxTree(m_rbox + added, m_rchild, (m_flags & RLEAF) ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    DT_Quantizer quantizer(bounds);
+    new (&ltree) DT_BBoxTree(quantizer.dequantize(m_lbox), added, lchild(), isLLeaf() ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    new (&rtree) DT_BBoxTree(quantizer.dequantize(m_rbox), added, rchild(), isRLeaf() ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
 }
 
 
+class DT_QuadNode;
+
 template <typename Shape>
 class DT_RootData {
 public:
     DT_RootData(const DT_BBoxNode *nodes, 
-                const Shape *leaves) 
+                const Shape *leaves,
+                const DT_QuadNode *quad_nodes = 0) 
       : m_nodes(nodes),
-        m_leaves(leaves)
+        m_leaves(leaves),
+        m_quadNodes(quad_nodes)
     {}
 
     const DT_BBoxNode   *m_nodes;
     const Shape         *m_leaves;
+    const DT_QuadNode   *m_quadNodes;   // the collapsed tree, if any
 };
 
 template <typename Shape1, typename Shape2>
@@ -114,8 +200,9 @@ public:
     DT_ObjectData(const DT_BBoxNode *nodes, 
                   const Shape1 *leaves, 
                   const MT_Transform& xform, 
-                  Shape2 plus) 
-      : DT_RootData<Shape1>(nodes, leaves),
+                  Shape2 plus,
+                  const DT_QuadNode *quad_nodes = 0) 
+      : DT_RootData<Shape1>(nodes, leaves, quad_nodes),
         m_xform(xform),
         m_inv_xform(xform.inverse()),   
         m_plus(plus),
@@ -173,47 +260,205 @@ public:
     MT_Matrix3x3                   m_abs_b2a, m_abs_a2b;
 };
 
+// The traversals keep the subtrees that are still to be visited on a stack 
+// of fixed capacity. The subtree on top of the stack is replaced by its second
+// child, and the first child is pushed, so the children are made in place and
+// visited in the same order as in a recursive traversal. When the stack is 
+// full, the traversal is called for the first child instead, so trees of any 
+// depth are handled. The node of the second child is fetched while the first
+// is visited.
+
+#if defined(__GNUC__)
+#define DT_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define DT_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char *>(p), _MM_HINT_T0)
+#else
+#define DT_PREFETCH(p)
+#endif
 
-template <typename Shape>
-inline void refit(DT_BBoxNode& node, const DT_RootData<Shape>& rd)
+template <typename Entry>
+class DT_Stack {
+public:
+    enum { CAPACITY = 64 };
+
+    DT_Stack() : m_size(0) {}
+
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == CAPACITY; }
+
+    Entry& top() 
+    { 
+        assert(!empty());
+        return m_entries[m_size - 1]; 
+    }
+
+    Entry& push() 
+    { 
+        assert(!full());
+        return m_entries[m_size++]; 
+    }
+
+    void pop() 
+    { 
+        assert(!empty());
+        --m_size; 
+    }
+
+private:
+    Entry m_entries[CAPACITY];
+    int   m_size;
+};
+
+inline void prefetch(const DT_BBoxNode *nodes, const DT_BBoxTree& tree)
+{
+    if (tree.m_type == DT_BBoxTree::INTERNAL)
+    {
+        DT_PREFETCH(nodes + tree.m_index);
+    }
+}
+
+// Replaces 'tree' by its right child, and returns the left child in 'ltree'
+template <typename Shape1, typename Shape2>
+inline void split(DT_BBoxTree& tree, DT_BBoxTree& ltree, const DT_ObjectData<Shape1, Shape2>& data)
 {
-    node.m_lbox = (node.m_flags & DT_BBoxNode::LLEAF) ? 
-                  computeCBox(rd.m_leaves[node.m_lchild]) : 
-                  rd.m_nodes[node.m_lchild].hull(); 
-    node.m_rbox = (node.m_flags & DT_BBoxNode::RLEAF) ? 
-                  computeCBox(rd.m_leaves[node.m_rchild]) : 
-                  rd.m_nodes[node.m_rchild].hull(); 
+    data.m_nodes[tree.m_index].makeChildren(tree.m_bounds, data.m_added, ltree, tree);
+    prefetch(data.m_nodes, tree);
 }
 
+// A subtree with a lower bound for its distance, as used by closest_points
+struct DT_TreeEntry {
+    DT_TreeEntry() {}
+    DT_TreeEntry(const DT_BBoxTree& tree, MT_Scalar dist2) 
+      : m_tree(tree),
+        m_dist2(dist2)
+    {}
 
-template <typename Shape>
-bool rayCast(const DT_BBoxTree& a, const DT_RootData<Shape>& rd,
-              const MT_Point3& source, const MT_Point3& target, 
-              MT_Scalar& lambda, MT_Vector3& normal) 
+    DT_BBoxTree m_tree;
+    MT_Scalar   m_dist2;
+};
+
+// A pair of subtrees of two trees that are traversed together
+struct DT_TreePair {
+    DT_TreePair() {}
+    DT_TreePair(const DT_BBoxTree& a, const DT_BBoxTree& b, MT_Scalar dist2 = MT_Scalar(0.0)) 
+      : m_a(a),
+        m_b(b),
+        m_dist2(dist2)
+    {}
+
+    DT_BBoxTree m_a;
+    DT_BBoxTree m_b;
+    MT_Scalar   m_dist2;   // a lower bound for the distance, in closest_points
+};
+
+// Splits the larger tree of 'pair'. The pair is replaced by its second pair 
+// of children, and the first pair is returned in 'first'.
+template <typename Shape1, typename Shape2>
+inline void split(DT_TreePair& pair, DT_TreePair& first, const DT_DuoPack<Shape1, Shape2>& pack)
 {
-    if (!a.m_cbox.overlapsLineSegment(source, source.lerp(target, lambda))) 
+    if (pair.m_a.m_type == DT_BBoxTree::LEAF || 
+        (pair.m_b.m_type != DT_BBoxTree::LEAF && pair.m_a.m_cbox.size() < pair.m_b.m_cbox.size())) 
+    {
+        first.m_a = pair.m_a;
+        split(pair.m_b, first.m_b, pack.m_b);
+    }
+    else
     {
-        return false;
+        first.m_b = pair.m_b;
+        split(pair.m_a, first.m_a, pack.m_a);
     }
+}
 
-    if (a.m_type == DT_BBoxTree::LEAF) 
-    { 
-        return ray_cast(rd, a.m_index, source, target, lambda, normal); 
+
+// A ray from 'm_source' to 'm_target'. The reciprocals of its direction, 
+// zero along axes in which the ray does not move, give the parameters at 
+// which it enters boxes. With 'm_any', the cast stops at the first hit that
+// is found, which need not be the nearest.
+struct DT_Ray {
+    DT_Ray(const MT_Point3& source, const MT_Point3& target, bool any = false)
+      : m_source(source),
+        m_target(target),
+        m_any(any)
+    {
+        MT_Vector3 r = target - source;
+        int i;
+        for (i = 0; i != 3; ++i)
+        {
+            m_inv_dir[i] = r[i] != MT_Scalar(0.0) ? MT_Scalar(1.0) / r[i] : MT_Scalar(0.0);
+        }
     }
-    else 
+
+    MT_Point3  m_source;
+    MT_Point3  m_target;
+    MT_Vector3 m_inv_dir;
+    bool       m_any;
+};
+
+// The child whose box the ray enters first is visited first, so that far 
+// subtrees are tested against a segment that is shortened by near hits.
+template <typename Shape>
+bool rayCast(const DT_BBoxTree& a, const DT_RootData<Shape>& rd, const DT_Ray& ray,
+             MT_Scalar& lambda, MT_Vector3& normal) 
+{
+    const MT_Point3& source = ray.m_source;
+    const MT_Point3& target = ray.m_target;
+
+    DT_Stack<DT_BBoxTree> stack;
+    stack.push() = a;
+    MT_Point3 end = source.lerp(target, lambda);
+    bool result = false;
+    do
     {
-        DT_BBoxTree ltree, rtree;
-        rd.m_nodes[a.m_index].makeChildren(ltree, rtree);
-        
-        bool lresult = rayCast(ltree, rd, source, target, lambda, normal);
-        bool rresult = rayCast(rtree, rd, source, target, lambda, normal);
-        return lresult || rresult;
+        DT_BBoxTree& tree = stack.top();
+        if (!tree.m_cbox.overlapsLineSegment(source, end)) 
+        {
+            stack.pop();
+        }
+        else if (tree.m_type == DT_BBoxTree::LEAF) 
+        { 
+            if (ray_cast(rd, tree.m_index, source, target, lambda, normal))
+            {
+                if (ray.m_any)
+                {
+                    return true;
+                }
+                end = source.lerp(target, lambda);
+                result = true;
+            }
+            stack.pop();
+        }
+        else 
+        {
+            DT_BBoxTree overflow;
+            bool full = stack.full();
+            DT_BBoxTree& first = full ? overflow : stack.push();
+            rd.m_nodes[tree.m_index].makeChildren(tree.m_bounds, first, tree);
+            if (tree.m_cbox.entryParam(source, ray.m_inv_dir) < first.m_cbox.entryParam(source, ray.m_inv_dir))
+            {
+                std::swap(first, tree);
+            }
+            prefetch(rd.m_nodes, tree);
+
+            if (full && rayCast(first, rd, ray, lambda, normal))
+            {
+                if (ray.m_any)
+                {
+                    return true;
+                }
+                end = source.lerp(target, lambda);
+                result = true;
+            }
+        }
     }
+    while (!stack.empty());
+
+    return result;
 }
 
 
 #ifdef STATISTICS
-int num_box_tests = 0;
+extern int num_box_tests;
 #endif
 
 template <typename Shape1, typename Shape2>
@@ -240,217 +485,270 @@ inline bool intersect(const DT_CBox& a, const DT_CBox& b, const DT_DuoPack<Shape
 template <typename Shape1, typename Shape2>
 bool intersect(const DT_BBoxTree& a, const DT_Pack<Shape1, Shape2>& pack, MT_Vector3& v)
 { 
-    if (!a.m_cbox.overlaps(pack.m_b_cbox)) 
+    DT_Stack<DT_BBoxTree> stack;
+    stack.push() = a;
+    do
     {
-        return false;
+        DT_BBoxTree& tree = stack.top();
+        if (!tree.m_cbox.overlaps(pack.m_b_cbox)) 
+        {
+            stack.pop();
+        }
+        else if (tree.m_type == DT_BBoxTree::LEAF) 
+        {
+            if (intersect(pack, tree.m_index, v))
+            {
+                return true;
+            }
+            stack.pop();
+        }
+        else if (stack.full())
+        {
+            DT_BBoxTree ltree;
+            split(tree, ltree, pack.m_a);
+            if (intersect(ltree, pack, v))
+            {
+                return true;
+            }
+        }
+        else 
+        {
+            split(tree, stack.push(), pack.m_a);
+        }
     }
+    while (!stack.empty());
 
-    if (a.m_type == DT_BBoxTree::LEAF) 
-    {
-        return intersect(pack, a.m_index, v);
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        return intersect(a_ltree, pack, v) || intersect(a_rtree, pack, v);
-    }
+    return false;
 }
 
 template <typename Shape1, typename Shape2>
 bool intersect(const DT_BBoxTree& a, const DT_BBoxTree& b, const DT_DuoPack<Shape1, Shape2>& pack, MT_Vector3& v)
 { 
-    if (!intersect(a.m_cbox, b.m_cbox, pack)) 
-    {
-        return false;
-    }
-
-    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
+    DT_Stack<DT_TreePair> stack;
+    stack.push() = DT_TreePair(a, b);
+    do
     {
-        return intersect(pack, a.m_index, b.m_index, v);
+        DT_TreePair& pair = stack.top();
+        if (!intersect(pair.m_a.m_cbox, pair.m_b.m_cbox, pack)) 
+        {
+            stack.pop();
+        }
+        else if (pair.m_a.m_type == DT_BBoxTree::LEAF && pair.m_b.m_type == DT_BBoxTree::LEAF) 
+        {
+            if (intersect(pack, pair.m_a.m_index, pair.m_b.m_index, v))
+            {
+                return true;
+            }
+            stack.pop();
+        }
+        else if (stack.full())
+        {
+            DT_TreePair first;
+            split(pair, first, pack);
+            if (intersect(first.m_a, first.m_b, pack, v))
+            {
+                return true;
+            }
+        }
+        else 
+        {
+            split(pair, stack.push(), pack);
+        }
     }
-    else if (a.m_type == DT_BBoxTree::LEAF || 
-             (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
-    {
-        DT_BBoxTree b_ltree, b_rtree;
-        pack.m_b.m_nodes[b.m_index].makeChildren(pack.m_b.m_added, b_ltree, b_rtree);
+    while (!stack.empty());
 
-        return intersect(a, b_ltree, pack, v) || intersect(a, b_rtree, pack, v);
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        return intersect(a_ltree, b, pack, v) || intersect(a_rtree, b, pack, v);
-    }
+    return false;
 }
 
 template <typename Shape1, typename Shape2>
 bool common_point(const DT_BBoxTree& a, const DT_Pack<Shape1, Shape2>& pack,  
                   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 { 
-    if (!a.m_cbox.overlaps(pack.m_b_cbox))
+    DT_Stack<DT_BBoxTree> stack;
+    stack.push() = a;
+    do
     {
-        return false;
+        DT_BBoxTree& tree = stack.top();
+        if (!tree.m_cbox.overlaps(pack.m_b_cbox)) 
+        {
+            stack.pop();
+        }
+        else if (tree.m_type == DT_BBoxTree::LEAF) 
+        {
+            if (common_point(pack, tree.m_index, v, pa, pb))
+            {
+                return true;
+            }
+            stack.pop();
+        }
+        else if (stack.full())
+        {
+            DT_BBoxTree ltree;
+            split(tree, ltree, pack.m_a);
+            if (common_point(ltree, pack, v, pa, pb))
+            {
+                return true;
+            }
+        }
+        else 
+        {
+            split(tree, stack.push(), pack.m_a);
+        }
     }
+    while (!stack.empty());
 
-    if (a.m_type == DT_BBoxTree::LEAF) 
-    {
-        return common_point(pack, a.m_index, v, pa, pb);
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        return common_point(a_ltree, pack, v, pa, pb) ||
-               common_point(a_rtree, pack, v, pa ,pb);
-    }
+    return false;
 }
 
 template <typename Shape1, typename Shape2>
 bool common_point(const DT_BBoxTree& a, const DT_BBoxTree& b, const DT_DuoPack<Shape1, Shape2>& pack,  
                   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 { 
-    if (!intersect(a.m_cbox, b.m_cbox, pack))
+    DT_Stack<DT_TreePair> stack;
+    stack.push() = DT_TreePair(a, b);
+    do
     {
-        return false;
+        DT_TreePair& pair = stack.top();
+        if (!intersect(pair.m_a.m_cbox, pair.m_b.m_cbox, pack)) 
+        {
+            stack.pop();
+        }
+        else if (pair.m_a.m_type == DT_BBoxTree::LEAF && pair.m_b.m_type == DT_BBoxTree::LEAF) 
+        {
+            if (common_point(pack, pair.m_a.m_index, pair.m_b.m_index, v, pa, pb))
+            {
+                return true;
+            }
+            stack.pop();
+        }
+        else if (stack.full())
+        {
+            DT_TreePair first;
+            split(pair, first, pack);
+            if (common_point(first.m_a, first.m_b, pack, v, pa, pb))
+            {
+                return true;
+            }
+        }
+        else 
+        {
+            split(pair, stack.push(), pack);
+        }
     }
+    while (!stack.empty());
 
-    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
-    {
-        return common_point(pack, a.m_index, b.m_index, v, pa, pb);
-    }
-    else if (a.m_type == DT_BBoxTree::LEAF || 
-             (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
-    {
-        DT_BBoxTree b_ltree, b_rtree;
-        pack.m_b.m_nodes[b.m_index].makeChildren(pack.m_b.m_added, b_ltree, b_rtree);
-        return common_point(a, b_ltree, pack, v, pa, pb) ||
-               common_point(a, b_rtree, pack, v, pa, pb);
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        return common_point(a_ltree, b, pack, v, pa, pb) ||
-               common_point(a_rtree, b, pack, v, pa ,pb);
-    }
+    return false;
 }
 
 
+// The deepest penetration over all leaves whose boxes overlap. Of equally deep
+// penetrations, the one that is found first is kept. Each leaf test starts 
+// from the 'v' of the previous one.
 template <typename Shape1, typename Shape2>
 bool penetration_depth(const DT_BBoxTree& a, const DT_HybridPack<Shape1, Shape2>& pack, 
                        MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, MT_Scalar& max_pen_len) 
 { 
-    if (!a.m_cbox.overlaps(pack.m_b_cbox))
-    {
-        return false;
-    }
-    
-    if (a.m_type == DT_BBoxTree::LEAF) 
+    DT_Stack<DT_BBoxTree> stack;
+    stack.push() = a;
+    bool result = false;
+    do
     {
-        if (penetration_depth(pack, a.m_index, v, pa, pb))
+        DT_BBoxTree& tree = stack.top();
+        if (!tree.m_cbox.overlaps(pack.m_b_cbox)) 
         {
-            max_pen_len = pa.distance2(pb);
-            return true;
+            stack.pop();
         }
-        else 
+        else if (tree.m_type == DT_BBoxTree::LEAF || stack.full()) 
         {
-            return false;
-        }
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        if (penetration_depth(a_ltree, pack, v, pa, pb, max_pen_len)) 
-        {
-            MT_Vector3 rv;
             MT_Point3 rpa, rpb;
             MT_Scalar rmax_pen_len;
-            if (penetration_depth(a_rtree, pack, rv, rpa, rpb, rmax_pen_len) &&
-                (max_pen_len < rmax_pen_len))
+            bool hit = false;
+            if (tree.m_type == DT_BBoxTree::LEAF) 
+            {
+                if (penetration_depth(pack, tree.m_index, v, rpa, rpb))
+                {
+                    rmax_pen_len = rpa.distance2(rpb);
+                    hit = true;
+                }
+                stack.pop();
+            }
+            else 
+            {
+                DT_BBoxTree ltree;
+                split(tree, ltree, pack.m_a);
+                hit = penetration_depth(ltree, pack, v, rpa, rpb, rmax_pen_len);
+            }
+
+            if (hit && (!result || max_pen_len < rmax_pen_len))
             {
                 max_pen_len = rmax_pen_len;
-                v = rv;
                 pa = rpa;
                 pb = rpb;
+                result = true;
             }
-            return true;
         }
         else 
         {
-            return penetration_depth(a_rtree, pack, v, pa, pb, max_pen_len);
+            split(tree, stack.push(), pack.m_a);
         }
     }
+    while (!stack.empty());
+
+    return result;
 }
 
 template <typename Shape1, typename Shape2>
 bool penetration_depth(const DT_BBoxTree& a, const DT_BBoxTree& b, const DT_DuoPack<Shape1, Shape2>& pack, 
                        MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, MT_Scalar& max_pen_len) 
 { 
-    if (!intersect(a.m_cbox, b.m_cbox, pack))
+    DT_Stack<DT_TreePair> stack;
+    stack.push() = DT_TreePair(a, b);
+    bool result = false;
+    do
     {
-        return false;
-    }
-  
-    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
-    {
-        if (penetration_depth(pack, a.m_index, b.m_index, v, pa, pb))
-        {
-            max_pen_len = pa.distance2(pb);
-            return true;
-        }
-        else 
+        DT_TreePair& pair = stack.top();
+        if (!intersect(pair.m_a.m_cbox, pair.m_b.m_cbox, pack)) 
         {
-            return false;
+            stack.pop();
         }
-    }
-    else if (a.m_type == DT_BBoxTree::LEAF || 
-             (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
-    {
-        DT_BBoxTree b_ltree, b_rtree;
-        pack.m_b.m_nodes[b.m_index].makeChildren(pack.m_b.m_added, b_ltree, b_rtree);
-        if (penetration_depth(a, b_ltree, pack, v, pa, pb, max_pen_len)) 
+        else if ((pair.m_a.m_type == DT_BBoxTree::LEAF && pair.m_b.m_type == DT_BBoxTree::LEAF) || 
+                 stack.full()) 
         {
             MT_Point3 rpa, rpb;
             MT_Scalar rmax_pen_len;
-            if (penetration_depth(a, b_rtree, pack, v, rpa, rpb, rmax_pen_len) &&
-                (max_pen_len < rmax_pen_len))
+            bool hit = false;
+            if (pair.m_a.m_type == DT_BBoxTree::LEAF && pair.m_b.m_type == DT_BBoxTree::LEAF) 
             {
-                max_pen_len = rmax_pen_len;
-                pa = rpa;
-                pb = rpb;
+                if (penetration_depth(pack, pair.m_a.m_index, pair.m_b.m_index, v, rpa, rpb))
+                {
+                    rmax_pen_len = rpa.distance2(rpb);
+                    hit = true;
+                }
+                stack.pop();
             }
-            return true;
-        }
-        else
-        {
-            return penetration_depth(a, b_rtree, pack, v, pa, pb, max_pen_len);
-        }
-    }
-    else 
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        if (penetration_depth(a_ltree, b, pack, v, pa, pb, max_pen_len)) 
-        {
-            MT_Point3 rpa, rpb;
-            MT_Scalar rmax_pen_len;
-            if (penetration_depth(a_rtree, b, pack, v, rpa, rpb, rmax_pen_len) &&
-                (max_pen_len < rmax_pen_len))
+            else 
+            {
+                DT_TreePair first;
+                split(pair, first, pack);
+                hit = penetration_depth(first.m_a, first.m_b, pack, v, rpa, rpb, rmax_pen_len);
+            }
+
+            if (hit && (!result || max_pen_len < rmax_pen_len))
             {
                 max_pen_len = rmax_pen_len;
                 pa = rpa;
                 pb = rpb;
+                result = true;
             }
-            return true;
         }
         else 
         {
-            return penetration_depth(a_rtree, b, pack, v, pa, pb, max_pen_len);
+            split(pair, stack.push(), pack);
         }
     }
+    while (!stack.empty());
+
+    return result;
 }
 
 
@@ -470,33 +768,52 @@ inline MT_Scalar distance2(const DT_CBox& a, const MT_Transform& a2w,
 }
 
 
+// The nearer child is visited first. A subtree is skipped if its lower bound 
+// is not below the distance found so far by the time it is visited. The root
+// is always visited.
 template <typename Shape1, typename Shape2>
 MT_Scalar closest_points(const DT_BBoxTree& a, const DT_Pack<Shape1, Shape2>& pack, 
                          MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb) 
 { 
-    if (a.m_type == DT_BBoxTree::LEAF) 
-    {
-        return closest_points(pack, a.m_index, max_dist2, pa, pb);
-    }
-    else 
+    DT_Stack<DT_TreeEntry> stack;
+    stack.push() = DT_TreeEntry(a, -MT_INFINITY);
+    MT_Scalar dist2 = MT_INFINITY;
+    do
     {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        MT_Scalar ldist2 = distance2(a_ltree.m_cbox, pack.m_a.m_xform, pack.m_b_cbox, pack.m_a.m_xform);
-        MT_Scalar rdist2 = distance2(a_rtree.m_cbox, pack.m_a.m_xform, pack.m_b_cbox, pack.m_a.m_xform);
-        if (ldist2 < rdist2) 
+        DT_TreeEntry& entry = stack.top();
+        if (!(entry.m_dist2 < max_dist2))
         {
-            MT_Scalar dist2 = ldist2 < max_dist2 ? closest_points(a_ltree, pack, max_dist2, pa, pb) : MT_INFINITY;
+            stack.pop();
+        }
+        else if (entry.m_tree.m_type == DT_BBoxTree::LEAF) 
+        {
+            GEN_set_min(dist2, closest_points(pack, entry.m_tree.m_index, max_dist2, pa, pb));
             GEN_set_min(max_dist2, dist2);
-            return rdist2 < max_dist2 ? GEN_min(dist2, closest_points(a_rtree, pack, max_dist2, pa, pb)) : dist2;
+            stack.pop();
         }
-        else
+        else 
         {
-            MT_Scalar dist2 = rdist2 < max_dist2 ? closest_points(a_rtree, pack, max_dist2, pa, pb) : MT_INFINITY;
-            GEN_set_min(max_dist2, dist2);  
-            return ldist2 < max_dist2 ? GEN_min(dist2, closest_points(a_ltree, pack, max_dist2, pa, pb)) : dist2;       
+            DT_TreeEntry overflow;
+            bool full = stack.full();
+            DT_TreeEntry& nearer = full ? overflow : stack.push();
+            split(entry.m_tree, nearer.m_tree, pack.m_a);
+            nearer.m_dist2 = distance2(nearer.m_tree.m_cbox, pack.m_a.m_xform, pack.m_b_cbox, pack.m_a.m_xform);
+            entry.m_dist2 = distance2(entry.m_tree.m_cbox, pack.m_a.m_xform, pack.m_b_cbox, pack.m_a.m_xform);
+            if (entry.m_dist2 <= nearer.m_dist2)
+            {
+                std::swap(nearer, entry);
+            }
+
+            if (full && nearer.m_dist2 < max_dist2)
+            {
+                GEN_set_min(dist2, closest_points(nearer.m_tree, pack, max_dist2, pa, pb));
+                GEN_set_min(max_dist2, dist2);
+            }
         }
     }
+    while (!stack.empty());
+
+    return dist2;
 }
 
     
@@ -504,50 +821,45 @@ template <typename Shape1, typename Shape2>
 MT_Scalar closest_points(const DT_BBoxTree& a, const DT_BBoxTree& b, const DT_DuoPack<Shape1, Shape2>& pack, 
                          MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb) 
 {   
-    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
-    {
-        return closest_points(pack, a.m_index, b.m_index, max_dist2, pa, pb);
-    }
-    else if (a.m_type == DT_BBoxTree::LEAF || 
-             (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
+    DT_Stack<DT_TreePair> stack;
+    stack.push() = DT_TreePair(a, b, -MT_INFINITY);
+    MT_Scalar dist2 = MT_INFINITY;
+    do
     {
-        DT_BBoxTree b_ltree, b_rtree;
-        pack.m_b.m_nodes[b.m_index].makeChildren(pack.m_b.m_added, b_ltree, b_rtree);
-        MT_Scalar ldist2 = distance2(a.m_cbox, pack.m_a.m_xform, b_ltree.m_cbox, pack.m_b.m_xform);
-        MT_Scalar rdist2 = distance2(a.m_cbox, pack.m_a.m_xform, b_rtree.m_cbox, pack.m_b.m_xform);
-        if (ldist2 < rdist2)
+        DT_TreePair& pair = stack.top();
+        if (!(pair.m_dist2 < max_dist2))
         {
-            MT_Scalar dist2 = ldist2 < max_dist2 ? closest_points(a, b_ltree, pack, max_dist2, pa, pb): MT_INFINITY;;
-            GEN_set_min(max_dist2, dist2);
-            return rdist2 < max_dist2 ? GEN_min(dist2, closest_points(a, b_rtree, pack, max_dist2, pa, pb)) : dist2;        
+            stack.pop();
         }
-        else
+        else if (pair.m_a.m_type == DT_BBoxTree::LEAF && pair.m_b.m_type == DT_BBoxTree::LEAF) 
         {
-            MT_Scalar dist2 =  rdist2 < max_dist2 ? closest_points(a, b_rtree, pack, max_dist2, pa, pb) : MT_INFINITY;;
+            GEN_set_min(dist2, closest_points(pack, pair.m_a.m_index, pair.m_b.m_index, max_dist2, pa, pb));
             GEN_set_min(max_dist2, dist2);
-            return ldist2 < max_dist2 ? GEN_min(dist2, closest_points(a, b_ltree, pack, max_dist2, pa, pb)) : dist2;
+            stack.pop();
         }
-    }
-    else
-    {
-        DT_BBoxTree a_ltree, a_rtree;
-        pack.m_a.m_nodes[a.m_index].makeChildren(pack.m_a.m_added, a_ltree, a_rtree);
-        MT_Scalar ldist2 = distance2(a_ltree.m_cbox, pack.m_a.m_xform, b.m_cbox, pack.m_b.m_xform);
-        MT_Scalar rdist2 = distance2(a_rtree.m_cbox, pack.m_a.m_xform, b.m_cbox, pack.m_b.m_xform);
-        if (ldist2 < rdist2) 
-        {
-            MT_Scalar dist2 = ldist2 < max_dist2 ? closest_points(a_ltree, b, pack, max_dist2, pa, pb) : MT_INFINITY;;
-            GEN_set_min(max_dist2, dist2);
-            return rdist2 < max_dist2 ? GEN_min(dist2,closest_points(a_rtree, b, pack, max_dist2, pa, pb)) : dist2;
-        }
-        else
+        else 
         {
-            MT_Scalar dist2 = rdist2 < max_dist2 ? closest_points(a_rtree, b, pack, max_dist2, pa, pb) : MT_INFINITY;
-            GEN_set_min(max_dist2, dist2);
-            return ldist2 < max_dist2 ? GEN_min(dist2, closest_points(a_ltree, b, pack, max_dist2, pa, pb)) : dist2;
+            DT_TreePair overflow;
+            bool full = stack.full();
+            DT_TreePair& nearer = full ? overflow : stack.push();
+            split(pair, nearer, pack);
+            nearer.m_dist2 = distance2(nearer.m_a.m_cbox, pack.m_a.m_xform, nearer.m_b.m_cbox, pack.m_b.m_xform);
+            pair.m_dist2 = distance2(pair.m_a.m_cbox, pack.m_a.m_xform, pair.m_b.m_cbox, pack.m_b.m_xform);
+            if (pair.m_dist2 <= nearer.m_dist2)
+            {
+                std::swap(nearer, pair);
+            }
+
+            if (full && nearer.m_dist2 < max_dist2)
+            {
+                GEN_set_min(dist2, closest_points(nearer.m_a, nearer.m_b, pack, max_dist2, pa, pb));
+                GEN_set_min(max_dist2, dist2);
+            }
         }
     }
+    while (!stack.empty());
+
+    return dist2;
 }
 
 #endif
-
@@ -105,7 +105,24 @@ struct DT_CBox {
             
         return true;
     }
-    
+
+    // The parameter at which the ray from 'p' enters the box, or zero if 'p'
+    // is inside. 'inv_r' holds the reciprocals of the direction of the ray,
+    // and zero for axes along which the ray does not move, so the parameter
+    // is a lower bound that serves for ordering only.
+    MT_Scalar entryParam(const MT_Point3& p, const MT_Vector3& inv_r) const
+    {
+        MT_Scalar param = MT_Scalar(0.0);
+        int i;
+        for (i = 0; i != 3; ++i)
+        {
+            MT_Scalar lower = (m_center[i] - m_extent[i] - p[i]) * inv_r[i];
+            MT_Scalar upper = (m_center[i] + m_extent[i] - p[i]) * inv_r[i];
+            GEN_set_max(param, GEN_min(lower, upper));
+        }
+        return param;
+    }
+
     MT_Point3 support(const MT_Vector3& v) const 
     {
         return m_center + MT_Vector3(v[0] < MT_Scalar(0.0) ? -m_extent[0] : m_extent[0],
@@ -25,16 +25,40 @@
 #include <fstream>
 
 #include "DT_Complex.h"
-#include "DT_Minkowski.h"
 #include "DT_Sphere.h"
-#include "DT_Transform.h"
+#include "DT_Triangle.h"
+#include "DT_Polytope.h"
+#include "DT_Placed.h"
+#include "DT_ConvexQueries.h"
+#include "DT_Witness.h"
 #include "DT_Object.h"
 
+static const size_t CACHE_LINE_SIZE = 64;
+static const int    PARALLEL_SIZE = 4096;
+
+// The first cache line in 'memory'
+inline char *cacheAligned(char *memory)
+{
+    return memory + (CACHE_LINE_SIZE - size_t(memory) % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+}
+
+// The box of a leaf or a node in an array of the boxes of the leaves, followed
+// by those of the nodes
+inline const DT_CBox& childBox(const std::vector<DT_CBox>& boxes, DT_Count num_leaves, bool leaf, DT_Index index)
+{
+    return boxes[leaf ? index : num_leaves + index];
+}
+
 DT_Complex::DT_Complex(const DT_VertexBase *base) 
   : m_base(base),
     m_count(0),
     m_leaves(0),
-	m_nodes(0)
+	m_nodes(0),
+	m_memory(0),
+	m_quadNodes(0),
+	m_quadCount(0),
+	m_quadMemory(0),
+	m_refitData(0)
 { 
 	assert(base);
 	base->addComplex(this);
@@ -49,7 +73,9 @@ DT_Complex::~DT_Complex()
         delete m_leaves[i];
     }
     delete [] m_leaves;
-    delete [] m_nodes;
+    delete [] m_memory;
+    delete [] m_quadMemory;
+    delete m_refitData;
     
     m_base->removeComplex(this);
     if (m_base->isOwner()) 
@@ -58,7 +84,7 @@ DT_Complex::~DT_Complex()
     }
 }
 
-void DT_Complex::finish(DT_Count n, const DT_Convex *p[]) 
+void DT_Complex::finish(DT_Count n, const DT_Convex *p[], DT_BuildQuality quality, DT_TreeFormat format) 
 {
 	m_count = n;
 
@@ -72,19 +98,26 @@ void DT_Complex::finish(DT_Count n, const DT_Convex *p[])
     DT_Index *indices = new DT_Index[n];
     assert(boxes);
        
-    DT_Index i;
-    for (i = 0; i != n; ++i) 
+    // The boxes of the leaves are computed on all threads for large shapes
+    int num_leaves = int(n);
+    int j;
+#ifdef _OPENMP
+#pragma omp parallel for if (num_leaves >= PARALLEL_SIZE) schedule(static)
+#endif
+    for (j = 0; j < num_leaves; ++j) 
     {
-        m_leaves[i] = p[i];
-        boxes[i].set(p[i]->bbox());
-        indices[i] = i;
+        m_leaves[j] = p[j];
+        boxes[j].set(p[j]->bbox());
+        indices[j] = j;
     }
 
+    DT_Index i;
     m_cbox = boxes[0];
     for (i = 1; i != n; ++i) 
     {
         m_cbox = m_cbox.hull(boxes[i]);
     }
+    m_bounds = m_cbox;
 
     if (n == 1)
     {
@@ -93,15 +126,19 @@ void DT_Complex::finish(DT_Count n, const DT_Convex *p[])
     }
     else 
     {
-        m_nodes = new DT_BBoxNode[n - 1];
-        assert(m_nodes);
+        // The nodes start on a cache line, so that no node straddles two.
+        m_memory = new char[(n - 1) * sizeof(DT_BBoxNode) + CACHE_LINE_SIZE];
+        assert(m_memory);
+        m_nodes = reinterpret_cast<DT_BBoxNode *>(cacheAligned(m_memory));
     
-        int num_nodes = 0;
-        new(&m_nodes[num_nodes++]) DT_BBoxNode(0, n, num_nodes, m_nodes, boxes, indices, m_cbox);
-
-        assert(num_nodes == int(n - 1));
+        buildTree(n, m_nodes, boxes, indices, m_cbox, quality);
         
         m_type = DT_BBoxTree::INTERNAL;
+
+        if (format == DT_QUAD_TREE)
+        {
+            makeQuadTree();
+        }
     }
 
     delete [] boxes;
@@ -109,6 +146,16 @@ void DT_Complex::finish(DT_Count n, const DT_Convex *p[])
 }
 
 
+void DT_Complex::makeQuadTree()
+{
+    m_quadCount = collapseTree(m_nodes, m_bounds, 0);
+    m_quadMemory = new char[m_quadCount * sizeof(DT_QuadNode) + CACHE_LINE_SIZE];
+    assert(m_quadMemory);
+    m_quadNodes = reinterpret_cast<DT_QuadNode *>(cacheAligned(m_quadMemory));
+
+    collapseTree(m_nodes, m_bounds, m_quadNodes);
+}
+
 MT_BBox DT_Complex::bbox(const MT_Transform& t, MT_Scalar margin) const 
 {
     MT_Matrix3x3 abs_b = t.getBasis().absolute();  
@@ -124,17 +171,341 @@ MT_BBox DT_Complex::bbox(const MT_Transform& t, MT_Scalar margin) const
 
 void DT_Complex::refit()
 {
-    DT_RootData<const DT_Convex *> rd(m_nodes, m_leaves);
-    DT_Index i = m_count - 1;
-    while (i--)
+    if (m_type == DT_BBoxTree::LEAF)
+    {
+        m_cbox = computeCBox(m_leaves[0]);
+    }
+    else if (m_refitData)
+    {
+        std::vector<DT_CBox>& boxes = m_refitData->m_boxes;
+        DT_Index i;
+        for (i = 0; i != m_count; ++i)
+        {
+            boxes[i] = computeCBox(m_leaves[i]);
+        }
+        
+        i = m_count - 1;
+        while (i--)
+        {
+            const DT_BBoxNode& node = m_nodes[i];
+            boxes[m_count + i] = childBox(boxes, m_count, node.isLLeaf(), node.lchild()).hull(childBox(boxes, m_count, node.isRLeaf(), node.rchild()));
+        }
+        m_cbox = boxes[m_count];
+        quantize(0, m_cbox, 0, true);
+    }
+    else
+    {
+        // The boxes of the leaves, followed by the boxes of the nodes, which
+        // are computed bottom-up. A child node comes after its parent.
+        DT_Count num_nodes = m_count - 1;
+        DT_CBox *boxes = new DT_CBox[m_count + num_nodes];
+        DT_CBox *node_boxes = boxes + m_count;
+        DT_Index i;
+        for (i = 0; i != m_count; ++i)
+        {
+            boxes[i] = computeCBox(m_leaves[i]);
+        }
+        
+        i = num_nodes;
+        while (i--)
+        {
+            const DT_BBoxNode& node = m_nodes[i];
+            const DT_CBox& lbox = node.isLLeaf() ? boxes[node.lchild()] : node_boxes[node.lchild()];
+            const DT_CBox& rbox = node.isRLeaf() ? boxes[node.rchild()] : node_boxes[node.rchild()];
+            node_boxes[i] = lbox.hull(rbox);
+        }
+        m_cbox = node_boxes[0];
+
+        // Then the nodes are quantized top-down. The box of a child node is 
+        // no longer needed once its parent is done, and is replaced by the 
+        // box that a traversal dequantizes.
+        for (i = 0; i != num_nodes; ++i)
+        {
+            DT_BBoxNode& node = m_nodes[i];
+            DT_CBox& lbox = node.isLLeaf() ? boxes[node.lchild()] : node_boxes[node.lchild()];
+            DT_CBox& rbox = node.isRLeaf() ? boxes[node.rchild()] : node_boxes[node.rchild()];
+            node.setBoxes(node_boxes[i], lbox, rbox, lbox, rbox);
+        }
+
+        delete [] boxes;
+    }
+    m_bounds = m_cbox;
+
+    if (m_quadNodes)
+    {
+        collapseTree(m_nodes, m_bounds, m_quadNodes);
+    }
+
+    invalidateObjects();
+}
+
+// The vertices of a leaf, which is either a triangle or a polytope
+inline DT_Count numVerts(const DT_Convex *leaf)
+{
+    return leaf->getType() == TRIANGLE ? 3 : static_cast<const DT_Polytope *>(leaf)->numVerts();
+}
+
+inline DT_Index vertexIndex(const DT_Convex *leaf, int i)
+{
+    return leaf->getType() == TRIANGLE ? 
+           static_cast<const DT_Triangle *>(leaf)->getIndex(i) : 
+           static_cast<const DT_Polytope *>(leaf)->getIndex(i);
+}
+
+static const DT_Index NO_PARENT = ~DT_Index(0);
+
+void DT_Complex::makeRefitData()
+{
+    assert(!m_refitData);
+    m_refitData = new DT_RefitData;
+    DT_RefitData& data = *m_refitData;
+
+    // The leaves of each vertex are sorted into a single list
+    DT_Index num_verts = 0;
+    DT_Index i;
+    int j;
+    for (i = 0; i != m_count; ++i)
+    {
+        for (j = 0; j != int(numVerts(m_leaves[i])); ++j)
+        {
+            GEN_set_max(num_verts, vertexIndex(m_leaves[i], j) + 1);
+        }
+    }
+
+    data.m_vertexStart.assign(num_verts + 1, 0);
+    for (i = 0; i != m_count; ++i)
+    {
+        for (j = 0; j != int(numVerts(m_leaves[i])); ++j)
+        {
+            ++data.m_vertexStart[vertexIndex(m_leaves[i], j) + 1];
+        }
+    }
+
+    for (i = 0; i != num_verts; ++i)
+    {
+        data.m_vertexStart[i + 1] += data.m_vertexStart[i];
+    }
+
+    std::vector<DT_Index> next(data.m_vertexStart.begin(), data.m_vertexStart.end() - 1);
+    data.m_vertexLeaves.resize(data.m_vertexStart.back());
+    for (i = 0; i != m_count; ++i)
+    {
+        for (j = 0; j != int(numVerts(m_leaves[i])); ++j)
+        {
+            data.m_vertexLeaves[next[vertexIndex(m_leaves[i], j)]++] = i;
+        }
+    }
+
+    DT_Count num_nodes = m_count - 1;
+    data.m_parents.assign(m_count + num_nodes, NO_PARENT);
+    for (i = 0; i != num_nodes; ++i)
+    {
+        const DT_BBoxNode& node = m_nodes[i];
+        data.m_parents[node.isLLeaf() ? node.lchild() : m_count + node.lchild()] = i;
+        data.m_parents[node.isRLeaf() ? node.rchild() : m_count + node.rchild()] = i;
+    }
+
+    data.m_boxes.resize(m_count + num_nodes);
+    data.m_visit.assign(num_nodes, 0);
+}
+
+inline bool covers(const DT_CBox& a, const DT_CBox& b)
+{
+    return a.getCenter()[0] - a.getExtent()[0] <= b.getCenter()[0] - b.getExtent()[0] &&
+           a.getCenter()[1] - a.getExtent()[1] <= b.getCenter()[1] - b.getExtent()[1] &&
+           a.getCenter()[2] - a.getExtent()[2] <= b.getCenter()[2] - b.getExtent()[2] &&
+           a.getCenter()[0] + a.getExtent()[0] >= b.getCenter()[0] + b.getExtent()[0] &&
+           a.getCenter()[1] + a.getExtent()[1] >= b.getCenter()[1] + b.getExtent()[1] &&
+           a.getCenter()[2] + a.getExtent()[2] >= b.getCenter()[2] + b.getExtent()[2];
+}
+
+inline bool equal(const DT_CBox& a, const DT_CBox& b)
+{
+    return a.getCenter() == b.getCenter() && a.getExtent() == b.getExtent();
+}
+
+// A node whose contents outgrew its box gets some room to grow, since all of
+// its subtree is quantized anew each time its box changes.
+static const MT_Scalar REFIT_SLACK = MT_Scalar(0.125);
+
+inline DT_CBox loosen(const DT_CBox& cbox)
+{
+    MT_Scalar slack = cbox.size() * REFIT_SLACK;
+    return DT_CBox(cbox.getCenter(), cbox.getExtent() + MT_Vector3(slack, slack, slack));
+}
+
+// Quantizes the children of node 'i' on 'bounds'. Without 'old_bounds', as in
+// a full refit, the boxes are fitted tightly. Otherwise, the children keep the 
+// boxes they had on 'old_bounds' as long as these cover their contents. With 
+// 'all' set, the bounds of the node have changed, and the whole subtree is 
+// quantized anew. Otherwise, only the marked nodes are visited.
+void DT_Complex::quantize(DT_Index i, const DT_CBox& bounds, const DT_CBox *old_bounds, bool all)
+{
+    DT_RefitData& data = *m_refitData;
+    DT_BBoxNode& node = m_nodes[i];
+    data.m_visit[i] = 0;
+
+    DT_CBox lbounds, rbounds;
+    if (old_bounds)
+    {
+        node.getBoxes(*old_bounds, lbounds, rbounds);
+    }
+
+    const DT_CBox& lbox = childBox(data.m_boxes, m_count, node.isLLeaf(), node.lchild());
+    DT_CBox old_lbounds = lbounds;
+    bool lkeep = old_bounds && covers(lbounds, lbox);
+    if (all || !lkeep)
+    {
+        node.setLBox(bounds, node.isLLeaf() || !old_bounds ? lbox : lkeep ? old_lbounds : loosen(lbox), lbounds);
+    }
+    if (!node.isLLeaf() && (all || !lkeep || data.m_visit[node.lchild()]))
+    {
+        quantize(node.lchild(), lbounds, old_bounds ? &old_lbounds : 0, all || !lkeep);
+    }
+
+    const DT_CBox& rbox = childBox(data.m_boxes, m_count, node.isRLeaf(), node.rchild());
+    DT_CBox old_rbounds = rbounds;
+    bool rkeep = old_bounds && covers(rbounds, rbox);
+    if (all || !rkeep)
+    {
+        node.setRBox(bounds, node.isRLeaf() || !old_bounds ? rbox : rkeep ? old_rbounds : loosen(rbox), rbounds);
+    }
+    if (!node.isRLeaf() && (all || !rkeep || data.m_visit[node.rchild()]))
+    {
+        quantize(node.rchild(), rbounds, old_bounds ? &old_rbounds : 0, all || !rkeep);
+    }
+}
+
+void DT_Complex::refitLeaves(std::vector<DT_Index>& leaves)
+{
+    if (m_type == DT_BBoxTree::LEAF)
+    {
+        if (!leaves.empty())
+        {
+            DT_CBox cbox = computeCBox(m_leaves[0]);
+            if (!equal(cbox, m_cbox))
+            {
+                m_cbox = m_bounds = cbox;
+                invalidateObjects();
+            }
+        }
+        return;
+    }
+
+    DT_RefitData& data = *m_refitData;
+    std::sort(leaves.begin(), leaves.end());
+    leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+    // The leaves whose boxes changed mark the path up to the root, up to 
+    // where it joins a path that is already marked.
+    std::vector<DT_Index> path;
+    std::vector<DT_Index>::const_iterator it;
+    for (it = leaves.begin(); it != leaves.end(); ++it)
     {
-        ::refit(m_nodes[i], rd);
+        DT_CBox cbox = computeCBox(m_leaves[*it]);
+        if (!equal(cbox, data.m_boxes[*it]))
+        {
+            data.m_boxes[*it] = cbox;
+            DT_Index i = data.m_parents[*it];
+            while (i != NO_PARENT && !data.m_visit[i])
+            {
+                data.m_visit[i] = 1;
+                path.push_back(i);
+                i = data.m_parents[m_count + i];
+            }
+        }
     }
-    m_cbox = m_type == DT_BBoxTree::LEAF ? computeCBox(m_leaves[0]) : m_nodes[0].hull();
 
+    if (path.empty())
+    {
+        return;
+    }
+
+    // A child node comes after its parent, so in reverse order the children 
+    // are done first.
+    std::sort(path.begin(), path.end());
+    std::vector<DT_Index>::reverse_iterator rit;
+    for (rit = path.rbegin(); rit != path.rend(); ++rit)
+    {
+        const DT_BBoxNode& node = m_nodes[*rit];
+        data.m_boxes[m_count + *rit] = childBox(data.m_boxes, m_count, node.isLLeaf(), node.lchild()).hull(
+                                       childBox(data.m_boxes, m_count, node.isRLeaf(), node.rchild()));
+    }
+
+    DT_CBox cbox = data.m_boxes[m_count];
+    bool moved = !equal(cbox, m_cbox);
+    m_cbox = cbox;
+
+    DT_CBox old_bounds = m_bounds;
+    bool all = !covers(m_bounds, m_cbox);
+    if (all)
+    {
+        m_bounds = loosen(m_cbox);
+    }
+    quantize(0, m_bounds, &old_bounds, all);
+
+    if (m_quadNodes)
+    {
+        collapseTree(m_nodes, m_bounds, m_quadNodes);
+    }
+
+    if (moved)
+    {
+        invalidateObjects();
+    }
+}
+
+void DT_Complex::refitVertices(DT_Count count, const DT_Index *indices)
+{
+    if (!m_refitData)
+    {
+        makeRefitData();
+        refit();
+        return;
+    }
+
+    const DT_RefitData& data = *m_refitData;
+    DT_Index num_verts = DT_Index(data.m_vertexStart.size() - 1);
+    std::vector<DT_Index> leaves;
+    DT_Count i;
+    for (i = 0; i != count; ++i)
+    {
+        if (indices[i] < num_verts)
+        {
+            leaves.insert(leaves.end(), 
+                          data.m_vertexLeaves.begin() + data.m_vertexStart[indices[i]],
+                          data.m_vertexLeaves.begin() + data.m_vertexStart[indices[i] + 1]);
+        }
+    }
+    refitLeaves(leaves);
+}
+
+void DT_Complex::refitVertexRange(DT_Index first, DT_Count count)
+{
+    if (!m_refitData)
+    {
+        makeRefitData();
+        refit();
+        return;
+    }
+
+    const DT_RefitData& data = *m_refitData;
+    DT_Index num_verts = DT_Index(data.m_vertexStart.size() - 1);
+    DT_Index last = GEN_min(first + count, num_verts);
+    std::vector<DT_Index> leaves;
+    if (first < last)
+    {
+        leaves.assign(data.m_vertexLeaves.begin() + data.m_vertexStart[first],
+                      data.m_vertexLeaves.begin() + data.m_vertexStart[last]);
+    }
+    refitLeaves(leaves);
+}
+
+void DT_Complex::invalidateObjects()
+{
 	for (ObjectList::iterator it = m_objectList.begin(); it != m_objectList.end(); ++it)
 	{
-		(*it)->setBBox();
+		(*it)->invalidateBBox();
 	}
 }
 
@@ -147,143 +518,290 @@ inline bool ray_cast(const DT_RootData<const DT_Convex *>& rd, DT_Index index, c
 bool DT_Complex::ray_cast(const MT_Point3& source, const MT_Point3& target,
                           MT_Scalar& lambda, MT_Vector3& normal) const 
 {
-    DT_RootData<const DT_Convex *> rd(m_nodes, m_leaves);
+    return castRay(DT_Ray(source, target), lambda, normal);
+}
 
-    return rayCast(DT_BBoxTree(m_cbox, 0, m_type), rd, source, target, lambda, normal);
+bool DT_Complex::ray_test(const MT_Point3& source, const MT_Point3& target, MT_Scalar lambda) const 
+{
+    MT_Vector3 normal;
+    return castRay(DT_Ray(source, target, true), lambda, normal);
 }
 
+bool DT_Complex::castRay(const DT_Ray& ray, MT_Scalar& lambda, MT_Vector3& normal) const 
+{
+    DT_RootData<const DT_Convex *> rd(m_nodes, m_leaves, m_quadNodes);
+
+    if (m_quadNodes)
+    {
+        return m_bounds.overlapsLineSegment(ray.m_source, ray.m_source.lerp(ray.m_target, lambda)) &&
+               rayCast(DT_QuadTree(m_bounds, 0, m_type), rd, ray, lambda, normal);
+    }
+
+    return rayCast(DT_BBoxTree(m_bounds, 0, m_type), rd, ray, lambda, normal);
+}
+
+// A triangle has closed-form tests against a sphere, which is then placed 
+// about the origin.
+inline bool witness(const DT_ObjectData<const DT_Convex *, MT_Scalar>& data, DT_Index index, 
+                    const DT_Convex& b, MT_Scalar b_margin, DT_Witness& w)
+{
+    const DT_Convex& leaf = *data.m_leaves[index];
+    if (leaf.getType() != TRIANGLE || b.getType() != SPHERE)
+    {
+        return false;
+    }
+
+    const DT_Triangle& triangle = static_cast<const DT_Triangle&>(leaf);
+    triangle_point(data.m_xform(triangle[0]), data.m_xform(triangle[1]), data.m_xform(triangle[2]), 
+                   MT_Point3(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0)), w);
+    w.m_a_radius = data.m_plus;
+    w.m_b_radius = static_cast<const DT_Sphere&>(b).getRadius() + b_margin;
+    return true;
+}
+
+// The GJK-based tests of a leaf, placed by 'place', against a convex shape
+
+class LeafIntersectQuery {
+public:
+    typedef bool Result;
+
+    LeafIntersectQuery(const DT_Convex& b, MT_Vector3& v) : m_b(b), m_v(v) {}
+
+    template <typename A>
+    bool operator()(const A& a) const { return ::intersect(a, m_b, m_v); }
+
+private:
+    const DT_Convex& m_b;
+    MT_Vector3&      m_v;
+};
+
+class LeafCommon_pointQuery {
+public:
+    typedef bool Result;
+
+    LeafCommon_pointQuery(const DT_Convex& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) : 
+        m_b(b), m_v(v), m_pa(pa), m_pb(pb) 
+    {}
+
+    template <typename A>
+    bool operator()(const A& a) const { return ::common_point(a, m_b, m_v, m_pa, m_pb); }
+
+private:
+    const DT_Convex& m_b;
+    MT_Vector3&      m_v;
+    MT_Point3&       m_pa;
+    MT_Point3&       m_pb;
+};
+
+class LeafPenetration_depthQuery {
+public:
+    typedef bool Result;
+
+    LeafPenetration_depthQuery(MT_Scalar a_margin, const DT_Convex& b, MT_Scalar b_margin, 
+                               MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) : 
+        m_a_margin(a_margin), m_b(b), m_b_margin(b_margin), m_v(v), m_pa(pa), m_pb(pb) 
+    {}
+
+    template <typename A>
+    bool operator()(const A& a) const 
+    { 
+        return ::hybrid_penetration_depth(a, m_a_margin, m_b, m_b_margin, m_v, m_pa, m_pb); 
+    }
+
+private:
+    MT_Scalar        m_a_margin;
+    const DT_Convex& m_b;
+    MT_Scalar        m_b_margin;
+    MT_Vector3&      m_v;
+    MT_Point3&       m_pa;
+    MT_Point3&       m_pb;
+};
+
+class LeafClosest_pointsQuery {
+public:
+    typedef MT_Scalar Result;
+
+    LeafClosest_pointsQuery(const DT_Convex& b, MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb) : 
+        m_b(b), m_max_dist2(max_dist2), m_pa(pa), m_pb(pb) 
+    {}
+
+    template <typename A>
+    MT_Scalar operator()(const A& a) const { return ::closest_points(a, m_b, m_max_dist2, m_pa, m_pb); }
+
+private:
+    const DT_Convex& m_b;
+    MT_Scalar        m_max_dist2;
+    MT_Point3&       m_pa;
+    MT_Point3&       m_pb;
+};
+
 inline bool intersect(const DT_Pack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, MT_Vector3& v) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    return ::intersect((a_margin > MT_Scalar(0.0) ? 
-                        static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) :  
-                        static_cast<const DT_Convex&>(ta)), 
-                       pack.m_b, v); 
+    DT_Witness w;
+    if (witness(pack.m_a, a_index, pack.m_b, MT_Scalar(0.0), w))
+    {
+        return intersect(w, v);
+    }
+
+    return place(LeafIntersectQuery(pack.m_b, v), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
 
 bool intersect(const DT_Complex& a,  const MT_Transform& a2w,  MT_Scalar a_margin, 
                const DT_Convex& b, MT_Vector3& v) 
 {
-    DT_Pack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin), b);
+    DT_Pack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes), b);
 
-    return intersect(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type), pack, v);
+    if (a.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        return a_root.m_cbox.overlaps(pack.m_b_cbox) && intersect(a_root, pack, v);
+    }
+
+    return intersect(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type), pack, v);
 }
 
 inline bool intersect(const DT_DuoPack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, DT_Index b_index, MT_Vector3& v) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    DT_Transform tb = DT_Transform(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index]);
-    MT_Scalar b_margin = pack.m_b.m_plus;
-    return ::intersect((a_margin > MT_Scalar(0.0) ?
-                        static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : 
-                        static_cast<const DT_Convex&>(ta)), 
-                       (b_margin > MT_Scalar(0.0) ? 
-                        static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : 
-                        static_cast<const DT_Convex&>(tb)), 
-                       v);   
+    DT_Placed<DT_Convex> tb(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index], pack.m_b.m_plus);
+    return place(LeafIntersectQuery(tb, v), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
 
 bool intersect(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin,
                const DT_Complex& b, const MT_Transform& b2w, MT_Scalar b_margin, MT_Vector3& v) 
 {
-    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin),
-                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin));
+    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes),
+                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin, b.m_quadNodes));
 
+    // Both trees are traversed in the same format
+    if (a.m_quadNodes && b.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        DT_QuadTree b_root(b.m_bounds + pack.m_b.m_added, 0, b.m_type);
+        return intersect(a_root.m_cbox, b_root.m_cbox, pack) && intersect(a_root, b_root, pack, v);
+    }
 
-    return intersect(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type),
-                     DT_BBoxTree(b.m_cbox + pack.m_b.m_added, 0, b.m_type), pack, v);
+    return intersect(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type),
+                     DT_BBoxTree(b.m_bounds, pack.m_b.m_added, 0, b.m_type), pack, v);
 }
 
 inline bool common_point(const DT_Pack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    return ::common_point((a_margin > MT_Scalar(0.0) ? 
-                           static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) :
-                           static_cast<const DT_Convex&>(ta)), 
-                          pack.m_b, v, pa, pb); 
+    DT_Witness w;
+    if (witness(pack.m_a, a_index, pack.m_b, MT_Scalar(0.0), w))
+    {
+        return common_point(w, v, pa, pb);
+    }
+
+    return place(LeafCommon_pointQuery(pack.m_b, v, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
     
 bool common_point(const DT_Complex& a,  const MT_Transform& a2w,  MT_Scalar a_margin, 
                   const DT_Convex& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-     DT_Pack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin), b);
+    DT_Pack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes), b);
+
+    if (a.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        return a_root.m_cbox.overlaps(pack.m_b_cbox) && common_point(a_root, pack, v, pb, pa);
+    }
 
-    return common_point(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type), pack, v, pb, pa);
+    return common_point(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type), pack, v, pb, pa);
 }
 
 inline bool common_point(const DT_DuoPack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, DT_Index b_index, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    DT_Transform tb = DT_Transform(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index]);
-    MT_Scalar b_margin = pack.m_b.m_plus;
-    return ::common_point((a_margin > MT_Scalar(0.0) ? 
-                           static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : 
-                           static_cast<const DT_Convex&>(ta)), 
-                          (b_margin > MT_Scalar(0.0) ? 
-                           static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : 
-                           static_cast<const DT_Convex&>(tb)), 
-                          v, pa, pb);    
+    DT_Placed<DT_Convex> tb(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index], pack.m_b.m_plus);
+    return place(LeafCommon_pointQuery(tb, v, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
     
 bool common_point(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin,
                   const DT_Complex& b, const MT_Transform& b2w, MT_Scalar b_margin, 
                   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin),
-                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin));
+    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes),
+                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin, b.m_quadNodes));
 
-    return common_point(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type),
-                        DT_BBoxTree(b.m_cbox + pack.m_b.m_added, 0, b.m_type),  pack, v, pa, pb);
+    if (a.m_quadNodes && b.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        DT_QuadTree b_root(b.m_bounds + pack.m_b.m_added, 0, b.m_type);
+        return intersect(a_root.m_cbox, b_root.m_cbox, pack) && common_point(a_root, b_root, pack, v, pa, pb);
+    }
+
+    return common_point(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type),
+                        DT_BBoxTree(b.m_bounds, pack.m_b.m_added, 0, b.m_type),  pack, v, pa, pb);
 }
 
 inline bool penetration_depth(const DT_HybridPack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    return ::hybrid_penetration_depth(ta, pack.m_a.m_plus, pack.m_b, pack.m_margin, v, pa, pb); 
+    DT_Witness w;
+    if (witness(pack.m_a, a_index, pack.m_b, pack.m_margin, w))
+    {
+        return penetration_depth(w, v, pa, pb);
+    }
+
+    return place(LeafPenetration_depthQuery(pack.m_a.m_plus, pack.m_b, pack.m_margin, v, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, MT_Scalar(0.0));
 }
 
 bool penetration_depth(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin, 
                        const DT_Convex& b, MT_Scalar b_margin, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_HybridPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin), b, b_margin);
+    DT_HybridPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes), b, b_margin);
      
     MT_Scalar  max_pen_len = MT_Scalar(0.0);
-    return penetration_depth(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type), pack, v, pa, pb, max_pen_len);
+    if (a.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        return a_root.m_cbox.overlaps(pack.m_b_cbox) && penetration_depth(a_root, pack, v, pa, pb, max_pen_len);
+    }
+
+    return penetration_depth(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type), pack, v, pa, pb, max_pen_len);
 }
 
 inline bool penetration_depth(const DT_DuoPack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, DT_Index b_index, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    DT_Transform tb = DT_Transform(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index]);
-    return ::hybrid_penetration_depth(ta, pack.m_a.m_plus, tb, pack.m_b.m_plus, v, pa, pb);  
+    DT_Placed<DT_Convex> tb(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index], MT_Scalar(0.0));
+    return place(LeafPenetration_depthQuery(pack.m_a.m_plus, tb, pack.m_b.m_plus, v, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, MT_Scalar(0.0));
 }
 
 bool penetration_depth(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin,
                        const DT_Complex& b, const MT_Transform& b2w, MT_Scalar b_margin, 
                        MT_Vector3& v, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin),
-                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin));
+    DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin, a.m_quadNodes),
+                                                  DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin, b.m_quadNodes));
 
     MT_Scalar  max_pen_len = MT_Scalar(0.0);
-    return penetration_depth(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type),
-                             DT_BBoxTree(b.m_cbox + pack.m_b.m_added, 0, b.m_type), pack, v, pa, pb, max_pen_len);
+    if (a.m_quadNodes && b.m_quadNodes)
+    {
+        DT_QuadTree a_root(a.m_bounds + pack.m_a.m_added, 0, a.m_type);
+        DT_QuadTree b_root(b.m_bounds + pack.m_b.m_added, 0, b.m_type);
+        return intersect(a_root.m_cbox, b_root.m_cbox, pack) && penetration_depth(a_root, b_root, pack, v, pa, pb, max_pen_len);
+    }
+
+    return penetration_depth(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type),
+                             DT_BBoxTree(b.m_bounds, pack.m_b.m_added, 0, b.m_type), pack, v, pa, pb, max_pen_len);
 }
 
 
 
 inline MT_Scalar closest_points(const DT_Pack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    return ::closest_points((a_margin > MT_Scalar(0.0) ? 
-                             static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) :  
-                             static_cast<const DT_Convex&>(ta)), 
-                            pack.m_b, max_dist2, pa, pb); 
+    DT_Witness w;
+    if (witness(pack.m_a, a_index, pack.m_b, MT_Scalar(0.0), w))
+    {
+        return closest_points(w, max_dist2, pa, pb);
+    }
+
+    return place(LeafClosest_pointsQuery(pack.m_b, max_dist2, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
 
 MT_Scalar closest_points(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -291,21 +809,14 @@ MT_Scalar closest_points(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar
 {
     DT_Pack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin), b);
 
-    return closest_points(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type), pack, MT_INFINITY, pa, pb); 
+    return closest_points(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type), pack, MT_INFINITY, pa, pb); 
 }
 
 inline MT_Scalar closest_points(const DT_DuoPack<const DT_Convex *, MT_Scalar>& pack, DT_Index a_index, DT_Index b_index, MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb) 
 {
-    DT_Transform ta = DT_Transform(pack.m_a.m_xform, *pack.m_a.m_leaves[a_index]);
-    MT_Scalar a_margin = pack.m_a.m_plus;
-    DT_Transform tb = DT_Transform(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index]);
-    MT_Scalar b_margin = pack.m_b.m_plus;
-    return ::closest_points((a_margin > MT_Scalar(0.0) ? 
-                             static_cast<const DT_Convex&>(DT_Minkowski(ta, DT_Sphere(a_margin))) : 
-                             static_cast<const DT_Convex&>(ta)), 
-                            (b_margin > MT_Scalar(0.0) ? 
-                             static_cast<const DT_Convex&>(DT_Minkowski(tb, DT_Sphere(b_margin))) : 
-                             static_cast<const DT_Convex&>(tb)), max_dist2, pa, pb);     
+    DT_Placed<DT_Convex> tb(pack.m_b.m_xform, *pack.m_b.m_leaves[b_index], pack.m_b.m_plus);
+    return place(LeafClosest_pointsQuery(tb, max_dist2, pa, pb), 
+                 *pack.m_a.m_leaves[a_index], pack.m_a.m_xform, pack.m_a.m_plus);
 }
 
 MT_Scalar closest_points(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin,
@@ -315,8 +826,8 @@ MT_Scalar closest_points(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar
     DT_DuoPack<const DT_Convex *, MT_Scalar> pack(DT_ObjectData<const DT_Convex *, MT_Scalar>(a.m_nodes, a.m_leaves, a2w, a_margin),
                                DT_ObjectData<const DT_Convex *, MT_Scalar>(b.m_nodes, b.m_leaves, b2w, b_margin));
 
-    return closest_points(DT_BBoxTree(a.m_cbox + pack.m_a.m_added, 0, a.m_type),
-                          DT_BBoxTree(b.m_cbox + pack.m_b.m_added, 0, b.m_type), pack, MT_INFINITY, pa, pb);
+    return closest_points(DT_BBoxTree(a.m_bounds, pack.m_a.m_added, 0, a.m_type),
+                          DT_BBoxTree(b.m_bounds, pack.m_b.m_added, 0, b.m_type), pack, MT_INFINITY, pa, pb);
 }
 
 
@@ -32,16 +32,28 @@
 #include "DT_Shape.h"
 #include "DT_CBox.h"
 #include "DT_BBoxTree.h"
+#include "DT_QuadTree.h"
 
 class DT_Convex;
 class DT_Object;
 
+// What a partial refit needs besides the tree. It is made on the first 
+// partial refit of a shape.
+struct DT_RefitData {
+	std::vector<DT_Index> m_vertexStart;   // where the leaves of each vertex start in 'm_vertexLeaves'
+	std::vector<DT_Index> m_vertexLeaves;
+	std::vector<DT_Index> m_parents;       // the parent nodes of the leaves, followed by those of the nodes
+	std::vector<DT_CBox>  m_boxes;         // the exact boxes of the leaves, followed by those of the nodes
+	std::vector<char>     m_visit;         // marks the nodes above changed leaves
+};
+
 class DT_Complex : public DT_Shape  {
 public:
 	DT_Complex(const DT_VertexBase *base);
 	virtual ~DT_Complex();
 	
-	void finish(DT_Count n, const DT_Convex *p[]);
+	void finish(DT_Count n, const DT_Convex *p[], DT_BuildQuality quality = DT_FAST_BUILD, 
+				DT_TreeFormat format = DT_BINARY_TREE);
     
 	virtual DT_ShapeType getType() const { return COMPLEX; }
 
@@ -49,8 +61,18 @@ public:
 
 	virtual bool ray_cast(const MT_Point3& source, const MT_Point3& target, 
 						  MT_Scalar& lambda, MT_Vector3& normal) const; 
+	virtual bool ray_test(const MT_Point3& source, const MT_Point3& target, MT_Scalar lambda) const; 
 
 	void refit();
+
+	// Refits only the leaves that use the given vertices, and their ancestors
+	void refitVertices(DT_Count count, const DT_Index *indices);
+	void refitVertexRange(DT_Index first, DT_Count count);
+
+	DT_Size treeSize() const 
+	{ 
+		return m_count > 1 ? DT_Size((m_count - 1) * sizeof(DT_BBoxNode) + m_quadCount * sizeof(DT_QuadNode)) : 0; 
+	}
 	
 
     friend bool intersect(const DT_Complex& a, const MT_Transform& a2w, MT_Scalar a_margin, 
@@ -100,8 +122,22 @@ public:
 	DT_Count               m_count;
 	const DT_Convex      **m_leaves;
 	DT_BBoxNode           *m_nodes;
+	char                  *m_memory;
+	DT_QuadNode           *m_quadNodes;  // the collapsed tree, if the format is DT_QUAD_TREE
+	DT_Count               m_quadCount;
+	char                  *m_quadMemory;
 	DT_CBox                m_cbox;
+	DT_CBox                m_bounds;    // the box on which the root is quantized, which covers 'm_cbox'
+	DT_RefitData          *m_refitData;
 	DT_BBoxTree::NodeType  m_type;
+
+private:
+	bool castRay(const DT_Ray& ray, MT_Scalar& lambda, MT_Vector3& normal) const;
+	void makeQuadTree();
+	void makeRefitData();
+	void refitLeaves(std::vector<DT_Index>& leaves);
+	void quantize(DT_Index i, const DT_CBox& bounds, const DT_CBox *old_bounds, bool all);
+	void invalidateObjects();
 };
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include "DT_QuadTree.h"
+
+// Collapses the binary node 'node', whose children are quantized on 'bounds',
+// into the quad node 'quad'. The children of the quad node are the children 
+// of the binary node, with the internal ones replaced by their own children.
+// Returns the index that follows the quad nodes of the subtree.
+static DT_Index collapseNode(const DT_BBoxNode *nodes, DT_Index node, const DT_CBox& bounds, 
+                             DT_QuadNode *quads, DT_Index quad)
+{
+    DT_BBoxTree children[2];
+    nodes[node].makeChildren(bounds, children[0], children[1]);
+
+    DT_BBoxTree grandchildren[DT_QuadNode::WIDTH];
+    DT_Count count = 0;
+    int i;
+    for (i = 0; i != 2; ++i)
+    {
+        if (children[i].m_type == DT_BBoxTree::LEAF)
+        {
+            grandchildren[count++] = children[i];
+        }
+        else
+        {
+            nodes[children[i].m_index].makeChildren(children[i].m_bounds, grandchildren[count], grandchildren[count + 1]);
+            count += 2;
+        }
+    }
+
+    DT_Index next = quad + 1;
+    DT_Count k;
+    for (k = 0; k != count; ++k)
+    {
+        const DT_BBoxTree& child = grandchildren[k];
+        if (child.m_type == DT_BBoxTree::LEAF)
+        {
+            if (quads)
+            {
+                quads[quad].setChild(k, child.m_cbox, child.m_index, DT_BBoxTree::LEAF);
+            }
+        }
+        else
+        {
+            if (quads)
+            {
+                quads[quad].setChild(k, child.m_cbox, next, DT_BBoxTree::INTERNAL);
+            }
+            next = collapseNode(nodes, child.m_index, child.m_bounds, quads, next);
+        }
+    }
+
+    if (quads)
+    {
+        quads[quad].setCount(count);
+    }
+    return next;
+}
+
+DT_Count collapseTree(const DT_BBoxNode *nodes, const DT_CBox& bounds, DT_QuadNode *quads)
+{
+    return collapseNode(nodes, 0, bounds, quads, 0);
+}
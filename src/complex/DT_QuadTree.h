@@ -0,0 +1,511 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_QUADTREE_H
+#define DT_QUADTREE_H
+
+#include "DT_BBoxTree.h"
+#include "DT_Scalar4.h"
+
+// A child of a quad node, as it is seen in a traversal. Its box is tested 
+// by its parent, together with those of its siblings.
+
+class DT_QuadTree {
+public:
+    DT_QuadTree(const DT_CBox& cbox, DT_Index index, DT_BBoxTree::NodeType type)
+      : m_cbox(cbox),
+        m_index(index),
+        m_type(type)
+    {}
+
+    DT_CBox               m_cbox;    // including the margin
+    DT_Index              m_index;
+    DT_BBoxTree::NodeType m_type;
+};
+
+// A quad node holds the boxes of up to four children. The boxes are stored 
+// per coordinate rather than per child, so that a box or a line segment is 
+// tested against the boxes of all children at once. The quad nodes are made
+// by collapsing every other level of the binary tree, and the boxes are the
+// dequantized boxes of the binary nodes. A quad node takes 128 bytes with 
+// single-precision scalars.
+
+class DT_QuadNode {
+public:
+    enum { WIDTH = 4 };
+
+    DT_Count count() const { return m_count; }
+
+    DT_CBox box(int k) const
+    {
+        return DT_CBox(MT_Point3(m_center[0][k], m_center[1][k], m_center[2][k]),
+                       MT_Vector3(m_extent[0][k], m_extent[1][k], m_extent[2][k]));
+    }
+
+    DT_QuadTree makeChild(int k) const
+    {
+        return DT_QuadTree(box(k), m_child[k] & ~LEAF, 
+                           (m_child[k] & LEAF) != 0 ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    }
+
+    DT_QuadTree makeChild(int k, const DT_CBox& added) const
+    {
+        return DT_QuadTree(box(k) + added, m_child[k] & ~LEAF, 
+                           (m_child[k] & LEAF) != 0 ? DT_BBoxTree::LEAF : DT_BBoxTree::INTERNAL);
+    }
+
+    void setChild(int k, const DT_CBox& box, DT_Index index, DT_BBoxTree::NodeType type);
+    void setCount(DT_Count count);
+
+    // The masks of the children whose boxes overlap. The boxes are grown by
+    // 'added' first. The third test is the one of DT_DuoPack, for a box 'b' 
+    // in another frame.
+    int overlaps(const DT_CBox& added, const DT_CBox& b) const;
+    int overlapsLineSegment(const MT_Point3& p, const MT_Point3& q) const;
+    // The parameters at which the ray from 'p' enters the boxes of the 
+    // children, as in DT_CBox::entryParam
+    void entryParams(const MT_Point3& p, const MT_Vector3& inv_r, MT_Scalar param[WIDTH]) const;
+    int overlaps(const DT_CBox& added, const DT_CBox& b, 
+                 const MT_Transform& b2a, const MT_Matrix3x3& abs_b2a,
+                 const MT_Transform& a2b, const MT_Matrix3x3& abs_a2b) const;
+
+private:
+    enum { LEAF = 0x80000000 };
+
+    int mask() const { return (1 << m_count) - 1; }
+
+#ifdef USE_SSE
+    MT_ALIGN16 MT_Scalar m_center[3][WIDTH];
+#else
+    MT_Scalar            m_center[3][WIDTH];
+#endif
+    MT_Scalar            m_extent[3][WIDTH];
+    DT_Index             m_child[WIDTH];
+    DT_Count             m_count;
+};
+
+// Collapses the binary tree in 'nodes', whose root is quantized on 'bounds',
+// into 'quads', and returns the number of quad nodes. Only the number is 
+// returned if 'quads' is null. The quad nodes are in the same order as the 
+// binary nodes, so a refit of the binary tree is followed by a collapse into
+// the same quad nodes.
+DT_Count collapseTree(const DT_BBoxNode *nodes, const DT_CBox& bounds, DT_QuadNode *quads);
+
+inline void DT_QuadNode::setChild(int k, const DT_CBox& box, DT_Index index, DT_BBoxTree::NodeType type)
+{
+    int i;
+    for (i = 0; i != 3; ++i)
+    {
+        m_center[i][k] = box.getCenter()[i];
+        m_extent[i][k] = box.getExtent()[i];
+    }
+    m_child[k] = type == DT_BBoxTree::LEAF ? index | LEAF : index;
+}
+
+inline void DT_QuadNode::setCount(DT_Count count)
+{
+    assert(2 <= count && count <= WIDTH);
+    m_count = count;
+
+    // The unused lanes are filled with empty boxes, which are masked out
+    DT_Count k;
+    for (k = count; k != WIDTH; ++k)
+    {
+        setChild(k, DT_CBox(MT_Point3(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0)), 
+                            MT_Vector3(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0))), 
+                 0, DT_BBoxTree::LEAF);
+    }
+}
+
+inline int DT_QuadNode::overlaps(const DT_CBox& added, const DT_CBox& b) const
+{
+    int result = mask();
+    int i;
+    for (i = 0; i != 3; ++i)
+    {
+        DT_Scalar4 d = DT_Scalar4(m_center[i]) - DT_Scalar4(b.getCenter()[i] - added.getCenter()[i]);
+        DT_Scalar4 e = DT_Scalar4(m_extent[i]) + DT_Scalar4(added.getExtent()[i] + b.getExtent()[i]);
+        result &= lessEqual(absolute(d), e);
+    }
+    return result;
+}
+
+inline int DT_QuadNode::overlapsLineSegment(const MT_Point3& p, const MT_Point3& q) const
+{
+    MT_Vector3 r = q - p;   
+    MT_Vector3 r_abs = r.absolute();
+    MT_Point3 center = p + r * MT_Scalar(0.5);
+    MT_Vector3 extent = r_abs * MT_Scalar(0.5);
+
+    // The box of the segment
+    DT_Scalar4 s[3], e[3];
+    int result = mask();
+    int i;
+    for (i = 0; i != 3; ++i)
+    {
+        DT_Scalar4 c(m_center[i]);
+        e[i] = DT_Scalar4(m_extent[i]);
+        result &= lessEqual(absolute(c - DT_Scalar4(center[i])), e[i] + DT_Scalar4(extent[i]));
+        s[i] = DT_Scalar4(p[i]) - c;
+    }
+    
+    // The cross products of the segment and the axes
+    for (i = 0; i != 3; ++i)
+    {
+        int j = (i + 1) % 3;
+        int k = (i + 2) % 3;
+        result &= lessEqual(absolute(DT_Scalar4(r[k]) * s[j] - DT_Scalar4(r[j]) * s[k]), 
+                            DT_Scalar4(r_abs[k]) * e[j] + DT_Scalar4(r_abs[j]) * e[k]);
+    }
+    return result;
+}
+
+inline void DT_QuadNode::entryParams(const MT_Point3& p, const MT_Vector3& inv_r, MT_Scalar param[WIDTH]) const
+{
+    DT_Scalar4 result(MT_Scalar(0.0));
+    int i;
+    for (i = 0; i != 3; ++i)
+    {
+        DT_Scalar4 s = DT_Scalar4(m_center[i]) - DT_Scalar4(p[i]);
+        DT_Scalar4 e(m_extent[i]);
+        DT_Scalar4 inv(inv_r[i]);
+        result = maximum(result, minimum((s - e) * inv, (s + e) * inv));
+    }
+    store(result, param);
+}
+
+inline int DT_QuadNode::overlaps(const DT_CBox& added, const DT_CBox& b, 
+                                 const MT_Transform& b2a, const MT_Matrix3x3& abs_b2a,
+                                 const MT_Transform& a2b, const MT_Matrix3x3& abs_a2b) const
+{
+#ifdef STATISTICS
+    num_box_tests += m_count;
+#endif
+
+    // The axes of the boxes of the children
+    MT_Point3 b_center = b2a(b.getCenter());
+    DT_Scalar4 c[3], e[3];
+    int result = mask();
+    int i;
+    for (i = 0; i != 3; ++i)
+    {
+        c[i] = DT_Scalar4(m_center[i]) + DT_Scalar4(added.getCenter()[i]);
+        e[i] = DT_Scalar4(m_extent[i]) + DT_Scalar4(added.getExtent()[i]);
+        result &= lessEqual(absolute(DT_Scalar4(b_center[i]) - c[i]), 
+                            e[i] + DT_Scalar4(abs_b2a[i].dot(b.getExtent())));
+    }
+
+    // The axes of 'b'
+    const MT_Matrix3x3& basis = a2b.getBasis();
+    const MT_Point3& origin = a2b.getOrigin();
+    for (i = 0; i != 3; ++i)
+    {
+        DT_Scalar4 d = DT_Scalar4(basis[i][0]) * c[0] + DT_Scalar4(basis[i][1]) * c[1] + 
+                       DT_Scalar4(basis[i][2]) * c[2] + DT_Scalar4(origin[i] - b.getCenter()[i]);
+        DT_Scalar4 r = DT_Scalar4(abs_a2b[i][0]) * e[0] + DT_Scalar4(abs_a2b[i][1]) * e[1] + 
+                       DT_Scalar4(abs_a2b[i][2]) * e[2] + DT_Scalar4(b.getExtent()[i]);
+        result &= lessEqual(absolute(d), r);
+    }
+    return result;
+}
+
+inline bool hasChild(int mask, int k)
+{
+    return ((mask >> k) & 0x1) != 0;
+}
+
+
+template <typename Shape>
+bool rayCast(const DT_QuadTree& a, const DT_RootData<Shape>& rd, const DT_Ray& ray,
+             MT_Scalar& lambda, MT_Vector3& normal) 
+{
+    const MT_Point3& source = ray.m_source;
+    const MT_Point3& target = ray.m_target;
+
+    if (a.m_type == DT_BBoxTree::LEAF) 
+    { 
+        return ray_cast(rd, a.m_index, source, target, lambda, normal); 
+    }
+
+    const DT_QuadNode& node = rd.m_quadNodes[a.m_index];
+    int mask = node.overlapsLineSegment(source, source.lerp(target, lambda));
+
+    // The children are visited in the order in which the ray enters them
+    MT_Scalar param[DT_QuadNode::WIDTH];
+    node.entryParams(source, ray.m_inv_dir, param);
+    int order[DT_QuadNode::WIDTH];
+    int count = 0;
+    int k;
+    for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+    {
+        if (hasChild(mask, k))
+        {
+            int j;
+            for (j = count++; j != 0 && param[k] < param[order[j - 1]]; --j)
+            {
+                order[j] = order[j - 1];
+            }
+            order[j] = k;
+        }
+    }
+
+    bool result = false;
+    int j;
+    for (j = 0; j != count; ++j)
+    {
+        k = order[j];
+        if (hasChild(mask, k) && rayCast(node.makeChild(k), rd, ray, lambda, normal))
+        {
+            if (ray.m_any)
+            {
+                return true;
+            }
+            
+            // The segment got shorter
+            result = true;
+            mask &= node.overlapsLineSegment(source, source.lerp(target, lambda));
+        }
+    }
+    return result;
+}
+
+template <typename Shape1, typename Shape2>
+bool intersect(const DT_QuadTree& a, const DT_Pack<Shape1, Shape2>& pack, MT_Vector3& v)
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF) 
+    {
+        return intersect(pack, a.m_index, v);
+    }
+
+    const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+    int mask = node.overlaps(pack.m_a.m_added, pack.m_b_cbox);
+    int k;
+    for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+    {
+        if (hasChild(mask, k) && intersect(node.makeChild(k, pack.m_a.m_added), pack, v))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Shape1, typename Shape2>
+bool intersect(const DT_QuadTree& a, const DT_QuadTree& b, const DT_DuoPack<Shape1, Shape2>& pack, MT_Vector3& v)
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
+    {
+        return intersect(pack, a.m_index, b.m_index, v);
+    }
+    
+    int k;
+    if (a.m_type == DT_BBoxTree::LEAF || 
+        (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
+    {
+        const DT_QuadNode& node = pack.m_b.m_quadNodes[b.m_index];
+        int mask = node.overlaps(pack.m_b.m_added, a.m_cbox, pack.m_a2b, pack.m_abs_a2b, pack.m_b2a, pack.m_abs_b2a);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            if (hasChild(mask, k) && intersect(a, node.makeChild(k, pack.m_b.m_added), pack, v))
+            {
+                return true;
+            }
+        }
+    }
+    else 
+    {
+        const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+        int mask = node.overlaps(pack.m_a.m_added, b.m_cbox, pack.m_b2a, pack.m_abs_b2a, pack.m_a2b, pack.m_abs_a2b);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            if (hasChild(mask, k) && intersect(node.makeChild(k, pack.m_a.m_added), b, pack, v))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Shape1, typename Shape2>
+bool common_point(const DT_QuadTree& a, const DT_Pack<Shape1, Shape2>& pack,  
+                  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF) 
+    {
+        return common_point(pack, a.m_index, v, pa, pb);
+    }
+
+    const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+    int mask = node.overlaps(pack.m_a.m_added, pack.m_b_cbox);
+    int k;
+    for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+    {
+        if (hasChild(mask, k) && common_point(node.makeChild(k, pack.m_a.m_added), pack, v, pa, pb))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Shape1, typename Shape2>
+bool common_point(const DT_QuadTree& a, const DT_QuadTree& b, const DT_DuoPack<Shape1, Shape2>& pack,  
+                  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
+    {
+        return common_point(pack, a.m_index, b.m_index, v, pa, pb);
+    }
+    
+    int k;
+    if (a.m_type == DT_BBoxTree::LEAF || 
+        (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
+    {
+        const DT_QuadNode& node = pack.m_b.m_quadNodes[b.m_index];
+        int mask = node.overlaps(pack.m_b.m_added, a.m_cbox, pack.m_a2b, pack.m_abs_a2b, pack.m_b2a, pack.m_abs_b2a);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            if (hasChild(mask, k) && common_point(a, node.makeChild(k, pack.m_b.m_added), pack, v, pa, pb))
+            {
+                return true;
+            }
+        }
+    }
+    else 
+    {
+        const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+        int mask = node.overlaps(pack.m_a.m_added, b.m_cbox, pack.m_b2a, pack.m_abs_b2a, pack.m_a2b, pack.m_abs_a2b);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            if (hasChild(mask, k) && common_point(node.makeChild(k, pack.m_a.m_added), b, pack, v, pa, pb))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The deepest penetration over the children. The penetration depth of a leaf
+// is returned as 'max_pen_len'.
+template <typename Shape1, typename Shape2>
+bool penetration_depth(const DT_QuadTree& a, const DT_HybridPack<Shape1, Shape2>& pack, 
+                       MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, MT_Scalar& max_pen_len) 
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF) 
+    {
+        if (penetration_depth(pack, a.m_index, v, pa, pb))
+        {
+            max_pen_len = pa.distance2(pb);
+            return true;
+        }
+        return false;
+    }
+
+    const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+    int mask = node.overlaps(pack.m_a.m_added, pack.m_b_cbox);
+    bool result = false;
+    int k;
+    for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+    {
+        MT_Vector3 cv = v;
+        MT_Point3 cpa, cpb;
+        MT_Scalar cmax_pen_len;
+        if (hasChild(mask, k) && 
+            penetration_depth(node.makeChild(k, pack.m_a.m_added), pack, cv, cpa, cpb, cmax_pen_len) &&
+            (!result || max_pen_len < cmax_pen_len))
+        {
+            result = true;
+            max_pen_len = cmax_pen_len;
+            v = cv;
+            pa = cpa;
+            pb = cpb;
+        }
+    }
+    return result;
+}
+
+template <typename Shape1, typename Shape2>
+bool penetration_depth(const DT_QuadTree& a, const DT_QuadTree& b, const DT_DuoPack<Shape1, Shape2>& pack, 
+                       MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, MT_Scalar& max_pen_len) 
+{ 
+    if (a.m_type == DT_BBoxTree::LEAF && b.m_type == DT_BBoxTree::LEAF) 
+    {
+        if (penetration_depth(pack, a.m_index, b.m_index, v, pa, pb))
+        {
+            max_pen_len = pa.distance2(pb);
+            return true;
+        }
+        return false;
+    }
+
+    bool result = false;
+    int k;
+    if (a.m_type == DT_BBoxTree::LEAF || 
+        (b.m_type != DT_BBoxTree::LEAF && a.m_cbox.size() < b.m_cbox.size())) 
+    {
+        const DT_QuadNode& node = pack.m_b.m_quadNodes[b.m_index];
+        int mask = node.overlaps(pack.m_b.m_added, a.m_cbox, pack.m_a2b, pack.m_abs_a2b, pack.m_b2a, pack.m_abs_b2a);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            MT_Vector3 cv = v;
+            MT_Point3 cpa, cpb;
+            MT_Scalar cmax_pen_len;
+            if (hasChild(mask, k) && 
+                penetration_depth(a, node.makeChild(k, pack.m_b.m_added), pack, cv, cpa, cpb, cmax_pen_len) &&
+                (!result || max_pen_len < cmax_pen_len))
+            {
+                result = true;
+                max_pen_len = cmax_pen_len;
+                v = cv;
+                pa = cpa;
+                pb = cpb;
+            }
+        }
+    }
+    else 
+    {
+        const DT_QuadNode& node = pack.m_a.m_quadNodes[a.m_index];
+        int mask = node.overlaps(pack.m_a.m_added, b.m_cbox, pack.m_b2a, pack.m_abs_b2a, pack.m_a2b, pack.m_abs_a2b);
+        for (k = 0; k != DT_QuadNode::WIDTH; ++k)
+        {
+            MT_Vector3 cv = v;
+            MT_Point3 cpa, cpb;
+            MT_Scalar cmax_pen_len;
+            if (hasChild(mask, k) && 
+                penetration_depth(node.makeChild(k, pack.m_a.m_added), b, pack, cv, cpa, cpb, cmax_pen_len) &&
+                (!result || max_pen_len < cmax_pen_len))
+            {
+                result = true;
+                max_pen_len = cmax_pen_len;
+                v = cv;
+                pa = cpa;
+                pb = cpb;
+            }
+        }
+    }
+    return result;
+}
+
+#endif
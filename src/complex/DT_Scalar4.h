@@ -0,0 +1,173 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_SCALAR4_H
+#define DT_SCALAR4_H
+
+#include "MT_Scalar.h"
+
+#ifdef USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// Four scalars on which the arithmetic is done lane by lane. With USE_SSE, 
+// they are held in an SSE register. The comparisons return a mask with a bit 
+// for each lane in which they hold.
+
+#ifdef USE_SSE
+
+class DT_Scalar4 {
+public:
+    DT_Scalar4() {}
+    DT_Scalar4(__m128 v) : m_v(v) {}
+    explicit DT_Scalar4(MT_Scalar x) : m_v(_mm_set1_ps(x)) {}
+
+    // 'p' is aligned on 16 bytes
+    explicit DT_Scalar4(const MT_Scalar *p) : m_v(_mm_load_ps(p)) {}
+
+    __m128 m_v;
+};
+
+inline DT_Scalar4 operator+(const DT_Scalar4& a, const DT_Scalar4& b) { return _mm_add_ps(a.m_v, b.m_v); }
+inline DT_Scalar4 operator-(const DT_Scalar4& a, const DT_Scalar4& b) { return _mm_sub_ps(a.m_v, b.m_v); }
+inline DT_Scalar4 operator*(const DT_Scalar4& a, const DT_Scalar4& b) { return _mm_mul_ps(a.m_v, b.m_v); }
+
+inline DT_Scalar4 absolute(const DT_Scalar4& a) 
+{ 
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.m_v); 
+}
+
+inline int lessEqual(const DT_Scalar4& a, const DT_Scalar4& b) 
+{ 
+    return _mm_movemask_ps(_mm_cmple_ps(a.m_v, b.m_v)); 
+}
+
+inline DT_Scalar4 minimum(const DT_Scalar4& a, const DT_Scalar4& b) { return _mm_min_ps(a.m_v, b.m_v); }
+inline DT_Scalar4 maximum(const DT_Scalar4& a, const DT_Scalar4& b) { return _mm_max_ps(a.m_v, b.m_v); }
+
+inline void store(const DT_Scalar4& a, MT_Scalar *p) 
+{ 
+    _mm_storeu_ps(p, a.m_v); 
+}
+
+#else
+
+class DT_Scalar4 {
+public:
+    DT_Scalar4() {}
+    
+    explicit DT_Scalar4(MT_Scalar x) 
+    {
+        m_co[0] = m_co[1] = m_co[2] = m_co[3] = x;
+    }
+
+    explicit DT_Scalar4(const MT_Scalar *p) 
+    {
+        m_co[0] = p[0]; 
+        m_co[1] = p[1]; 
+        m_co[2] = p[2]; 
+        m_co[3] = p[3];
+    }
+
+    MT_Scalar m_co[4];
+};
+
+inline DT_Scalar4 operator+(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = a.m_co[0] + b.m_co[0];
+    r.m_co[1] = a.m_co[1] + b.m_co[1];
+    r.m_co[2] = a.m_co[2] + b.m_co[2];
+    r.m_co[3] = a.m_co[3] + b.m_co[3];
+    return r;
+}
+
+inline DT_Scalar4 operator-(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = a.m_co[0] - b.m_co[0];
+    r.m_co[1] = a.m_co[1] - b.m_co[1];
+    r.m_co[2] = a.m_co[2] - b.m_co[2];
+    r.m_co[3] = a.m_co[3] - b.m_co[3];
+    return r;
+}
+
+inline DT_Scalar4 operator*(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = a.m_co[0] * b.m_co[0];
+    r.m_co[1] = a.m_co[1] * b.m_co[1];
+    r.m_co[2] = a.m_co[2] * b.m_co[2];
+    r.m_co[3] = a.m_co[3] * b.m_co[3];
+    return r;
+}
+
+inline DT_Scalar4 absolute(const DT_Scalar4& a) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = MT_abs(a.m_co[0]);
+    r.m_co[1] = MT_abs(a.m_co[1]);
+    r.m_co[2] = MT_abs(a.m_co[2]);
+    r.m_co[3] = MT_abs(a.m_co[3]);
+    return r;
+}
+
+inline int lessEqual(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    return (a.m_co[0] <= b.m_co[0] ? 0x1 : 0x0) | 
+           (a.m_co[1] <= b.m_co[1] ? 0x2 : 0x0) | 
+           (a.m_co[2] <= b.m_co[2] ? 0x4 : 0x0) | 
+           (a.m_co[3] <= b.m_co[3] ? 0x8 : 0x0);
+}
+
+inline DT_Scalar4 minimum(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = GEN_min(a.m_co[0], b.m_co[0]);
+    r.m_co[1] = GEN_min(a.m_co[1], b.m_co[1]);
+    r.m_co[2] = GEN_min(a.m_co[2], b.m_co[2]);
+    r.m_co[3] = GEN_min(a.m_co[3], b.m_co[3]);
+    return r;
+}
+
+inline DT_Scalar4 maximum(const DT_Scalar4& a, const DT_Scalar4& b) 
+{
+    DT_Scalar4 r;
+    r.m_co[0] = GEN_max(a.m_co[0], b.m_co[0]);
+    r.m_co[1] = GEN_max(a.m_co[1], b.m_co[1]);
+    r.m_co[2] = GEN_max(a.m_co[2], b.m_co[2]);
+    r.m_co[3] = GEN_max(a.m_co[3], b.m_co[3]);
+    return r;
+}
+
+inline void store(const DT_Scalar4& a, MT_Scalar *p) 
+{
+    p[0] = a.m_co[0];
+    p[1] = a.m_co[1];
+    p[2] = a.m_co[2];
+    p[3] = a.m_co[3];
+}
+
+#endif
+
+#endif
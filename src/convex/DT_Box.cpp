@@ -28,14 +28,6 @@ MT_Scalar DT_Box::supportH(const MT_Vector3& v) const
     return v.absolute().dot(m_extent);
 }
 
-MT_Point3 DT_Box::support(const MT_Vector3& v) const 
-{
-    return MT_Point3(v[0] < MT_Scalar(0.0) ? -m_extent[0] : m_extent[0],
-                     v[1] < MT_Scalar(0.0) ? -m_extent[1] : m_extent[1],
-                     v[2] < MT_Scalar(0.0) ? -m_extent[2] : m_extent[2]); 
-    
-}
-
 
 bool DT_Box::ray_cast(const MT_Point3& source, const MT_Point3& target,
 					  MT_Scalar& param, MT_Vector3& normal) const 
@@ -36,8 +36,16 @@ public:
 		m_extent(e) 
 	{}
 
+	virtual DT_ShapeType getType() const { return BOX; }
+
     virtual MT_Scalar supportH(const MT_Vector3& v) const;
-    virtual MT_Point3 support(const MT_Vector3& v) const;
+    virtual MT_Point3 support(const MT_Vector3& v) const
+	{
+		return MT_Point3(v[0] < MT_Scalar(0.0) ? -m_extent[0] : m_extent[0],
+						 v[1] < MT_Scalar(0.0) ? -m_extent[1] : m_extent[1],
+						 v[2] < MT_Scalar(0.0) ? -m_extent[2] : m_extent[2]); 
+	}
+
 	virtual bool ray_cast(const MT_Point3& source, const MT_Point3& target,
 						  MT_Scalar& param, MT_Vector3& normal) const;
     
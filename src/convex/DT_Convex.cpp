@@ -22,22 +22,9 @@
  */
 
 #include "DT_Convex.h"
-#include "GEN_MinMax.h"
-
-//#define DEBUG
-#define SAFE_EXIT
-
-#include "DT_GJK.h"
-#include "DT_PenDepth.h"
-
-#include <algorithm>
-#include <new>
+#include "DT_ConvexQueries.h"
 
 #include "MT_BBox.h"
-#include "DT_Sphere.h"
-#include "DT_Minkowski.h"
-
-#include "DT_Accuracy.h"
 
 #ifdef STATISTICS
 int num_iterations = 0;
@@ -88,386 +75,57 @@ bool DT_Convex::ray_cast(const MT_Point3& source, const MT_Point3& target, MT_Sc
 bool intersect(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v)
 {
 	DT_GJK gjk;
-
-#ifdef STATISTICS
-    num_iterations = 0;
-#endif
-	MT_Scalar dist2 = MT_INFINITY;
-
-	do
-	{
-		MT_Point3  p = a.support(-v);	
-		MT_Point3  q = b.support(v);
-		MT_Vector3 w = p - q; 
-		
-        if (v.dot(w) > MT_Scalar(0.0)) 
-		{
-			return false;
-		}
- 
-		gjk.addVertex(w); 
-        if (gjk.isAffinelyDependent())
-        {
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            return false;
-        }
-
-
-#ifdef STATISTICS
-        ++num_iterations;
-#endif
-        if (!gjk.closest(v)) 
-		{
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            return false;
-        }
-
-#ifdef SAFE_EXIT
-		MT_Scalar prev_dist2 = dist2;
-#endif
-
-		dist2 = v.length2();
-
-#ifdef SAFE_EXIT
-		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
-		{
- 			return false;
-		}
-#endif
-    } 
-    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
-
-    v.setValue(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
-
-    return true;
+	return intersect(a, b, v, gjk);
 }
 
-
-
+bool intersect(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v, DT_GJK& gjk)
+{
+	return intersect<DT_Convex, DT_Convex>(a, b, v, gjk);
+}
 
 bool common_point(const DT_Convex& a, const DT_Convex& b,
                   MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 {
 	DT_GJK gjk;
-
-#ifdef STATISTICS
-    num_iterations = 0;
-#endif
-
-	MT_Scalar dist2 = MT_INFINITY;
-
-    do
-	{
-		MT_Point3  p = a.support(-v);	
-		MT_Point3  q = b.support(v);
-		MT_Vector3 w = p - q; 
-		
-        if (v.dot(w) > MT_Scalar(0.0)) 
-		{
-			return false;
-		}
- 
-		gjk.addVertex(w, p, q); 
-        if (gjk.isAffinelyDependent())
-        {
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif 
-            return false;
-        }
-
-
-#ifdef STATISTICS
-        ++num_iterations;
-#endif
-        if (!gjk.closest(v)) 
-		{
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            return false;
-        }		
-		
-#ifdef SAFE_EXIT
-		MT_Scalar prev_dist2 = dist2;
-#endif
-
-		dist2 = v.length2();
-
-#ifdef SAFE_EXIT
-		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
-		{
-            return false;
-		}
-#endif
-    }
-    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
-    
-	gjk.compute_points(pa, pb);
-
-    v.setValue(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
-
-    return true;
+	return common_point(a, b, v, pa, pb, gjk);
 }
 
+bool common_point(const DT_Convex& a, const DT_Convex& b,
+                  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+	return common_point<DT_Convex, DT_Convex>(a, b, v, pa, pb, gjk);
+}
 
-
-
-
-
-	
 bool penetration_depth(const DT_Convex& a, const DT_Convex& b,
                        MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 {
 	DT_GJK gjk;
+	return penetration_depth(a, b, v, pa, pb, gjk);
+}
 
-#ifdef STATISTICS
-    num_iterations = 0;
-#endif
-
-	MT_Scalar dist2 = MT_INFINITY;
-
-    do
-	{
-		MT_Point3  p = a.support(-v);	
-		MT_Point3  q = b.support(v);
-		MT_Vector3 w = p - q; 
-		
-        if (v.dot(w) > MT_Scalar(0.0)) 
-		{
-			return false;
-		}
- 
-		gjk.addVertex(w, p, q); 
-        
-        if (gjk.isAffinelyDependent())
-        {
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
- 
-            return false;
-        }
-
-
-#ifdef STATISTICS
-        ++num_iterations;
-#endif
-        if (!gjk.closest(v)) 
-		{
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            return false;
-        }		
-		
-#ifdef SAFE_EXIT
-		MT_Scalar prev_dist2 = dist2;
-#endif
-
-		dist2 = v.length2();
-
-#ifdef SAFE_EXIT
-		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
-		{
- 			return false;
-		}
-#endif
-    }
-    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
-    
-
-	return penDepth(gjk, a, b, v, pa, pb);
-
+bool penetration_depth(const DT_Convex& a, const DT_Convex& b,
+                       MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+	return penetration_depth<DT_Convex, DT_Convex>(a, b, v, pa, pb, gjk);
 }
 
 bool hybrid_penetration_depth(const DT_Convex& a, MT_Scalar a_margin, 
 							  const DT_Convex& b, MT_Scalar b_margin,
                               MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 {
-	MT_Scalar margin = a_margin + b_margin;
-	if (margin > MT_Scalar(0.0))
-	{
-		MT_Scalar margin2 = margin * margin;
-
-		DT_GJK gjk;
-
-#ifdef STATISTICS
-		num_iterations = 0;
-#endif
-		MT_Scalar dist2 = MT_INFINITY;
-
-		do
-		{
-			MT_Point3  p = a.support(-v);	
-			MT_Point3  q = b.support(v);
-			
-			MT_Vector3 w = p - q; 
-			
-			MT_Scalar delta = v.dot(w);
-			
-			if (delta > MT_Scalar(0.0) && delta * delta > dist2 * margin2) 
-			{
-				return false;
-			}
-			
-			if (gjk.inSimplex(w) || dist2 - delta <= dist2 * DT_Accuracy::rel_error2)
-			{
-				gjk.compute_points(pa, pb);
-				MT_Scalar s = MT_sqrt(dist2);
-				assert(s > MT_Scalar(0.0));
-				pa -= v * (a_margin / s);
-				pb += v * (b_margin / s);
-				return true;
-			}
-			
-			gjk.addVertex(w, p, q); 
-
-            if (gjk.isAffinelyDependent())
-            {
-#ifdef STATISTICS
-                ++num_irregularities;
-#endif
-                gjk.compute_points(pa, pb);
-				MT_Scalar s = MT_sqrt(dist2);
-				assert(s > MT_Scalar(0.0));
-				pa -= v * (a_margin / s);
-				pb += v * (b_margin / s);
-				return true;
-            }
-
-			
-#ifdef STATISTICS
-			++num_iterations;
-#endif
-			if (!gjk.closest(v)) 
-			{
-#ifdef STATISTICS
-				++num_irregularities;
-#endif
-				gjk.compute_points(pa, pb);
-				MT_Scalar s = MT_sqrt(dist2);
-				assert(s > MT_Scalar(0.0));
-				pa -= v * (a_margin / s);
-				pb += v * (b_margin / s);
-				return true;
-			}
-			
-#ifdef SAFE_EXIT
-			MT_Scalar prev_dist2 = dist2;
-#endif
-			
-			dist2 = v.length2();
-			
-#ifdef SAFE_EXIT
-			if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
-			{
-  				gjk.backup_closest(v);
-				dist2 = v.length2();
-				gjk.compute_points(pa, pb);
-				MT_Scalar s = MT_sqrt(dist2);
-				assert(s > MT_Scalar(0.0));
-				pa -= v * (a_margin / s);
-				pb += v * (b_margin / s);
-				return true;
-			}
-#endif
-		}
-		while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
-		
-	}
-	// Second GJK phase. compute points on the boundary of the offset object
-	
-	return penetration_depth((a_margin > MT_Scalar(0.0) ? 
-							  static_cast<const DT_Convex&>(DT_Minkowski(a, DT_Sphere(a_margin))) : 
-							  static_cast<const DT_Convex&>(a)), 
-							 (b_margin > MT_Scalar(0.0) ? 
-							  static_cast<const DT_Convex&>(DT_Minkowski(b, DT_Sphere(b_margin))) : 
-							  static_cast<const DT_Convex&>(b)), v, pa, pb);
+	DT_GJK gjk;
+	return hybrid_penetration_depth(a, a_margin, b, b_margin, v, pa, pb, gjk);
 }
 
+bool hybrid_penetration_depth(const DT_Convex& a, MT_Scalar a_margin, 
+							  const DT_Convex& b, MT_Scalar b_margin,
+                              MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+	return hybrid_penetration_depth<DT_Convex, DT_Convex>(a, a_margin, b, b_margin, v, pa, pb, gjk);
+}
 
 MT_Scalar closest_points(const DT_Convex& a, const DT_Convex& b, MT_Scalar max_dist2,
                          MT_Point3& pa, MT_Point3& pb) 
 {
-	MT_Vector3 v(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
-	
-    DT_GJK gjk;
-
-#ifdef STATISTICS
-    num_iterations = 0;
-#endif
-
-	MT_Scalar dist2 = MT_INFINITY;
-
-    do
-	{
-		MT_Point3  p = a.support(-v);	
-		MT_Point3  q = b.support(v);
-		MT_Vector3 w = p - q; 
-
-		MT_Scalar delta = v.dot(w);
-		if (delta > MT_Scalar(0.0) && delta * delta > dist2 * max_dist2) 
-		{
-			return MT_INFINITY;
-		}
-
-		if (gjk.inSimplex(w) || dist2 - delta <= dist2 * DT_Accuracy::rel_error2) 
-		{
-            break;
-		}
-
-		gjk.addVertex(w, p, q);
-        if (gjk.isAffinelyDependent())
-        {
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            break;
-        }
-
-#ifdef STATISTICS
-        ++num_iterations;
-        if (num_iterations > 1000) 
-		{
-			std::cout << "v: " << v << " w: " << w << std::endl;
-		}
-#endif
-        if (!gjk.closest(v)) 
-		{
-#ifdef STATISTICS
-            ++num_irregularities;
-#endif
-            break;
-        }
-
-#ifdef SAFE_EXIT
-		MT_Scalar prev_dist2 = dist2;
-#endif
-
-		dist2 = v.length2();
-
-#ifdef SAFE_EXIT
-		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
-		{
-            gjk.backup_closest(v);
-            dist2 = v.length2();
-			break;
-		}
-#endif
-    }
-    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
-
-	assert(!gjk.emptySimplex());
-	
-	if (dist2 <= max_dist2)
-	{
-		gjk.compute_points(pa, pb);
-	}
-	
-	return dist2;
+	return closest_points<DT_Convex, DT_Convex>(a, b, max_dist2, pa, pb);
 }
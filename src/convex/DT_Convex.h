@@ -32,6 +32,8 @@
 #include "MT_Matrix3x3.h"
 #include "MT_Transform.h"
 
+class DT_GJK;
+
 class DT_Convex : public DT_Shape {
 public:
     virtual ~DT_Convex() {}
@@ -48,6 +50,21 @@ protected:
 	DT_Convex() {}
 };
 
+// The support point of a shape whose type is known at compile time. The call
+// is bound statically, so it can be inlined. Shapes known only as 'DT_Convex'
+// take the virtual call.
+
+template <typename Shape>
+inline MT_Point3 supportPoint(const Shape& shape, const MT_Vector3& v)
+{
+	return shape.Shape::support(v);
+}
+
+inline MT_Point3 supportPoint(const DT_Convex& shape, const MT_Vector3& v)
+{
+	return shape.support(v);
+}
+
 
 bool intersect(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v);
 
@@ -61,4 +78,20 @@ bool hybrid_penetration_depth(const DT_Convex& a, MT_Scalar a_margin,
 							  const DT_Convex& b, MT_Scalar b_margin,
                               MT_Vector3& v, MT_Point3& pa, MT_Point3& pb);
 
+// The same tests, continuing from the simplex in 'gjk'. The simplex is either
+// empty, or it consists of points of the CSO of 'a' and 'b' with closest 
+// point 'v', as set by DT_GJK::seed. The final simplex is left in 'gjk'.
+
+bool intersect(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v, DT_GJK& gjk);
+
+bool common_point(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, 
+				  DT_GJK& gjk);
+
+bool penetration_depth(const DT_Convex& a, const DT_Convex& b, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb,
+					   DT_GJK& gjk);
+
+bool hybrid_penetration_depth(const DT_Convex& a, MT_Scalar a_margin, 
+							  const DT_Convex& b, MT_Scalar b_margin,
+                              MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk);
+
 #endif
@@ -0,0 +1,481 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_CONVEXQUERIES_H
+#define DT_CONVEXQUERIES_H
+
+// The GJK-based tests of 'DT_Convex.h' as templates over the types of the 
+// shapes. Shapes of concrete types, such as the wrappers of 'DT_Placed.h',
+// have their support mappings inlined into the loops. The tests on 
+// 'DT_Convex' are instances of these templates.
+
+#include "DT_Convex.h"
+#include "DT_Minkowski.h"
+#include "DT_Sphere.h"
+#include "DT_GJK.h"
+#include "DT_PenDepth.h"
+#include "DT_Accuracy.h"
+
+#define SAFE_EXIT
+
+#ifdef STATISTICS
+#include <iostream>
+
+extern int num_iterations;
+extern int num_irregularities;
+#endif
+
+template <typename A, typename B>
+inline bool intersect(const A& a, const B& b, MT_Vector3& v)
+{
+	DT_GJK gjk;
+	return intersect(a, b, v, gjk);
+}
+
+template <typename A, typename B>
+inline bool intersect(const A& a, const B& b, MT_Vector3& v, DT_GJK& gjk)
+{
+#ifdef STATISTICS
+    num_iterations = 0;
+#endif
+	MT_Scalar dist2 = gjk.emptySimplex() ? MT_INFINITY : v.length2();
+
+	while (gjk.emptySimplex() || 
+		   (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()))
+	{
+		MT_Point3  p = supportPoint(a, -v);	
+		MT_Point3  q = supportPoint(b, v);
+		MT_Vector3 w = p - q; 
+		
+        if (v.dot(w) > MT_Scalar(0.0)) 
+		{
+			return false;
+		}
+ 
+		gjk.addVertex(w, p, q); 
+        if (gjk.isAffinelyDependent())
+        {
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            return false;
+        }
+
+
+#ifdef STATISTICS
+        ++num_iterations;
+#endif
+        if (!gjk.closest(v)) 
+		{
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            return false;
+        }
+
+#ifdef SAFE_EXIT
+		MT_Scalar prev_dist2 = dist2;
+#endif
+
+		dist2 = v.length2();
+
+#ifdef SAFE_EXIT
+		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
+		{
+ 			return false;
+		}
+#endif
+    } 
+
+    v.setValue(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
+
+    return true;
+}
+
+
+
+
+template <typename A, typename B>
+inline bool common_point(const A& a, const B& b,
+                  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	DT_GJK gjk;
+	return common_point(a, b, v, pa, pb, gjk);
+}
+
+template <typename A, typename B>
+inline bool common_point(const A& a, const B& b,
+                  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+#ifdef STATISTICS
+    num_iterations = 0;
+#endif
+
+	MT_Scalar dist2 = gjk.emptySimplex() ? MT_INFINITY : v.length2();
+
+	while (gjk.emptySimplex() || 
+		   (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()))
+	{
+		MT_Point3  p = supportPoint(a, -v);	
+		MT_Point3  q = supportPoint(b, v);
+		MT_Vector3 w = p - q; 
+		
+        if (v.dot(w) > MT_Scalar(0.0)) 
+		{
+			return false;
+		}
+ 
+		gjk.addVertex(w, p, q); 
+        if (gjk.isAffinelyDependent())
+        {
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif 
+            return false;
+        }
+
+
+#ifdef STATISTICS
+        ++num_iterations;
+#endif
+        if (!gjk.closest(v)) 
+		{
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            return false;
+        }		
+		
+#ifdef SAFE_EXIT
+		MT_Scalar prev_dist2 = dist2;
+#endif
+
+		dist2 = v.length2();
+
+#ifdef SAFE_EXIT
+		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
+		{
+            return false;
+		}
+#endif
+    }
+    
+	gjk.compute_points(pa, pb);
+
+    v.setValue(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
+
+    return true;
+}
+
+
+
+
+
+
+	
+template <typename A, typename B>
+inline bool penetration_depth(const A& a, const B& b,
+                       MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	DT_GJK gjk;
+	return penetration_depth(a, b, v, pa, pb, gjk);
+}
+
+template <typename A, typename B>
+inline bool penetration_depth(const A& a, const B& b,
+                       MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+	// A seeded simplex quickly tells whether the objects are apart. If they 
+	// are not, the search starts over, since the penetration depth method 
+	// needs a simplex of support points on the boundary of the CSO.
+	if (!gjk.emptySimplex())
+	{
+		if (!intersect(a, b, v, gjk))
+		{
+			return false;
+		}
+		gjk.reset();
+	}
+
+#ifdef STATISTICS
+    num_iterations = 0;
+#endif
+
+	MT_Scalar dist2 = MT_INFINITY;
+
+    do
+	{
+		MT_Point3  p = supportPoint(a, -v);	
+		MT_Point3  q = supportPoint(b, v);
+		MT_Vector3 w = p - q; 
+		
+        if (v.dot(w) > MT_Scalar(0.0)) 
+		{
+			return false;
+		}
+ 
+		gjk.addVertex(w, p, q); 
+        
+        if (gjk.isAffinelyDependent())
+        {
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+ 
+            return false;
+        }
+
+
+#ifdef STATISTICS
+        ++num_iterations;
+#endif
+        if (!gjk.closest(v)) 
+		{
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            return false;
+        }		
+		
+#ifdef SAFE_EXIT
+		MT_Scalar prev_dist2 = dist2;
+#endif
+
+		dist2 = v.length2();
+
+#ifdef SAFE_EXIT
+		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
+		{
+ 			return false;
+		}
+#endif
+    }
+    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
+    
+
+	return penDepth(gjk, a, b, v, pa, pb);
+
+}
+
+template <typename A, typename B>
+inline bool hybrid_penetration_depth(const A& a, MT_Scalar a_margin, 
+									 const B& b, MT_Scalar b_margin,
+									 MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	DT_GJK gjk;
+	return hybrid_penetration_depth(a, a_margin, b, b_margin, v, pa, pb, gjk);
+}
+
+template <typename A, typename B>
+inline bool hybrid_penetration_depth(const A& a, MT_Scalar a_margin, 
+									 const B& b, MT_Scalar b_margin,
+									 MT_Vector3& v, MT_Point3& pa, MT_Point3& pb, DT_GJK& gjk)
+{
+	MT_Scalar margin = a_margin + b_margin;
+	if (margin > MT_Scalar(0.0))
+	{
+		MT_Scalar margin2 = margin * margin;
+
+#ifdef STATISTICS
+		num_iterations = 0;
+#endif
+		MT_Scalar dist2 = gjk.emptySimplex() ? MT_INFINITY : v.length2();
+
+		while (gjk.emptySimplex() || 
+			   (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()))
+		{
+			MT_Point3  p = supportPoint(a, -v);	
+			MT_Point3  q = supportPoint(b, v);
+			
+			MT_Vector3 w = p - q; 
+			
+			MT_Scalar delta = v.dot(w);
+			
+			if (delta > MT_Scalar(0.0) && delta * delta > dist2 * margin2) 
+			{
+				return false;
+			}
+			
+			if (gjk.inSimplex(w) || dist2 - delta <= dist2 * DT_Accuracy::rel_error2)
+			{
+				gjk.compute_points(pa, pb);
+				MT_Scalar s = MT_sqrt(dist2);
+				assert(s > MT_Scalar(0.0));
+				pa -= v * (a_margin / s);
+				pb += v * (b_margin / s);
+				return true;
+			}
+			
+			gjk.addVertex(w, p, q); 
+
+            if (gjk.isAffinelyDependent())
+            {
+#ifdef STATISTICS
+                ++num_irregularities;
+#endif
+                gjk.compute_points(pa, pb);
+				MT_Scalar s = MT_sqrt(dist2);
+				assert(s > MT_Scalar(0.0));
+				pa -= v * (a_margin / s);
+				pb += v * (b_margin / s);
+				return true;
+            }
+
+			
+#ifdef STATISTICS
+			++num_iterations;
+#endif
+			if (!gjk.closest(v)) 
+			{
+#ifdef STATISTICS
+				++num_irregularities;
+#endif
+				gjk.compute_points(pa, pb);
+				MT_Scalar s = MT_sqrt(dist2);
+				assert(s > MT_Scalar(0.0));
+				pa -= v * (a_margin / s);
+				pb += v * (b_margin / s);
+				return true;
+			}
+			
+#ifdef SAFE_EXIT
+			MT_Scalar prev_dist2 = dist2;
+#endif
+			
+			dist2 = v.length2();
+			
+#ifdef SAFE_EXIT
+			if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
+			{
+  				gjk.backup_closest(v);
+				dist2 = v.length2();
+				gjk.compute_points(pa, pb);
+				MT_Scalar s = MT_sqrt(dist2);
+				assert(s > MT_Scalar(0.0));
+				pa -= v * (a_margin / s);
+				pb += v * (b_margin / s);
+				return true;
+			}
+#endif
+		}
+		
+	}
+	else
+	{
+		return penetration_depth(a, b, v, pa, pb, gjk);
+	}
+
+	// Second GJK phase. compute points on the boundary of the offset object
+	
+	return penetration_depth((a_margin > MT_Scalar(0.0) ? 
+							  static_cast<const DT_Convex&>(DT_Minkowski(a, DT_Sphere(a_margin))) : 
+							  static_cast<const DT_Convex&>(a)), 
+							 (b_margin > MT_Scalar(0.0) ? 
+							  static_cast<const DT_Convex&>(DT_Minkowski(b, DT_Sphere(b_margin))) : 
+							  static_cast<const DT_Convex&>(b)), v, pa, pb);
+}
+
+
+template <typename A, typename B>
+inline MT_Scalar closest_points(const A& a, const B& b, MT_Scalar max_dist2,
+                         MT_Point3& pa, MT_Point3& pb) 
+{
+	MT_Vector3 v(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
+	
+    DT_GJK gjk;
+
+#ifdef STATISTICS
+    num_iterations = 0;
+#endif
+
+	MT_Scalar dist2 = MT_INFINITY;
+
+    do
+	{
+		MT_Point3  p = supportPoint(a, -v);	
+		MT_Point3  q = supportPoint(b, v);
+		MT_Vector3 w = p - q; 
+
+		MT_Scalar delta = v.dot(w);
+		if (delta > MT_Scalar(0.0) && delta * delta > dist2 * max_dist2) 
+		{
+			return MT_INFINITY;
+		}
+
+		if (gjk.inSimplex(w) || dist2 - delta <= dist2 * DT_Accuracy::rel_error2) 
+		{
+            break;
+		}
+
+		gjk.addVertex(w, p, q);
+        if (gjk.isAffinelyDependent())
+        {
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            break;
+        }
+
+#ifdef STATISTICS
+        ++num_iterations;
+        if (num_iterations > 1000) 
+		{
+			std::cout << "v: " << v << " w: " << w << std::endl;
+		}
+#endif
+        if (!gjk.closest(v)) 
+		{
+#ifdef STATISTICS
+            ++num_irregularities;
+#endif
+            break;
+        }
+
+#ifdef SAFE_EXIT
+		MT_Scalar prev_dist2 = dist2;
+#endif
+
+		dist2 = v.length2();
+
+#ifdef SAFE_EXIT
+		if (prev_dist2 - dist2 <= MT_EPSILON * prev_dist2) 
+		{
+            gjk.backup_closest(v);
+            dist2 = v.length2();
+			break;
+		}
+#endif
+    }
+    while (!gjk.fullSimplex() && dist2 > DT_Accuracy::tol_error * gjk.maxVertex()); 
+
+	assert(!gjk.emptySimplex());
+	
+	if (dist2 <= max_dist2)
+	{
+		gjk.compute_points(pa, pb);
+	}
+	
+	return dist2;
+}
+
+#endif
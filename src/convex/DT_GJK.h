@@ -134,6 +134,48 @@ public:
 		return num_verts;
     }
 
+	// Starts from the simplex spanned by the given support points, e.g., the
+	// simplex of an earlier run on the same pair, and sets 'v' to its closest
+	// point. Points that are affinely dependent on the previous ones are
+	// skipped. If no closest point is found the simplex is left empty.
+	bool seed(int num_verts, const MT_Point3 *pBuf, const MT_Point3 *qBuf, MT_Vector3& v)
+	{
+		reset();
+
+		int i;
+		for (i = 0; i < num_verts; ++i)
+		{
+			MT_Vector3 w = pBuf[i] - qBuf[i];
+			if (!inSimplex(w))
+			{
+				addVertex(w, pBuf[i], qBuf[i]);
+				if (isAffinelyDependent())
+				{
+					m_all_bits = m_bits;
+				}
+				else
+				{
+					m_bits = m_all_bits;
+				}
+			}
+		}
+
+		T_Bits s;
+		for (s = m_all_bits; s != 0x0; --s)
+		{
+			if (subseteq(s, m_all_bits) && valid(s))
+			{
+				m_bits = s;
+				m_all_bits = s;
+				v = compute_vector(m_bits);
+				return true;
+			}
+		}
+
+		reset();
+		return false;
+	}
+
 	void compute_points(MT_Point3& p1, MT_Point3& p2) 
 	{
 		MT_Scalar sum = MT_Scalar(0.0);
@@ -28,9 +28,5 @@ MT_Scalar DT_LineSegment::supportH(const MT_Vector3& v) const
     return GEN_max(v.dot(m_source), v.dot(m_target));
 }
 
-MT_Point3 DT_LineSegment::support(const MT_Vector3& v) const
-{
-    return v.dot(m_source) > v.dot(m_target) ?	m_source : m_target;
-}
 
 
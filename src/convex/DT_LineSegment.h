@@ -32,8 +32,13 @@ public:
 	   m_source(source), 
 	   m_target(target) {}
 
+	virtual DT_ShapeType getType() const { return SEGMENT; }
+
     virtual MT_Scalar supportH(const MT_Vector3& v) const;
-    virtual MT_Point3 support(const MT_Vector3& v) const;
+    virtual MT_Point3 support(const MT_Vector3& v) const
+	{
+		return v.dot(m_source) > v.dot(m_target) ? m_source : m_target;
+	}
 
 	const MT_Point3& getSource() const { return m_source; }
 	const MT_Point3& getTarget() const { return m_target; }
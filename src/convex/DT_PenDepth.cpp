@@ -30,33 +30,53 @@
 //#define DEBUG
 
 
-const int       MaxSupportPoints = 100;
-const int       MaxFacets         = 200;
+// The support points are referred to by an Index_t
+const int       MaxSupportPoints  = 1 << (8 * sizeof(Index_t));
+const int       MinSupportPoints  = 128;
 
-static MT_Point3  pBuf[MaxSupportPoints];
-static MT_Point3  qBuf[MaxSupportPoints];
-static MT_Vector3 yBuf[MaxSupportPoints];
+static const MT_Scalar sin_60 = sqrt(MT_Scalar(3.0)) * MT_Scalar(0.5);
 
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define HAVE_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define DT_THREAD_LOCAL __declspec(thread)
+#else
+#define DT_THREAD_LOCAL __thread
+#endif
 
-static Triangle *triangleHeap[MaxFacets];
-static int  num_triangles;
+DT_PenDepthWorkspace& DT_PenDepthWorkspace::local()
+{
+#ifdef HAVE_THREAD_LOCAL
+	static thread_local DT_PenDepthWorkspace workspace;
+	return workspace;
+#else
+	// Without C++11 the workspace of a thread is not released when the 
+	// thread exits.
+	static DT_THREAD_LOCAL DT_PenDepthWorkspace *workspace = 0;
+	if (!workspace)
+	{
+		workspace = new DT_PenDepthWorkspace;
+	}
+	return *workspace;
+#endif
+}
 
 class TriangleComp
 {
 public:
     
-    bool operator()(const Triangle *face1, const Triangle *face2) 
+    bool operator()(const Triangle *face1, const Triangle *face2) const
     { 
         return face1->getDist2() > face2->getDist2();
     }
-} triangleComp;
+};
 
-inline void addCandidate(Triangle *triangle, MT_Scalar upper2) 
+inline void DT_PenDepthWorkspace::addCandidate(Triangle *triangle, MT_Scalar upper2) 
 {
     if (triangle->isClosestInternal() && triangle->getDist2() <= upper2)
     {
-        triangleHeap[num_triangles++] = triangle;
-        std::push_heap(&triangleHeap[0], &triangleHeap[num_triangles], triangleComp);
+        m_triangleHeap.push_back(triangle);
+        std::push_heap(m_triangleHeap.begin(), m_triangleHeap.end(), TriangleComp());
 #ifdef DEBUG
         std::cout << " accepted" << std::endl;
 #endif
@@ -78,6 +98,19 @@ inline void addCandidate(Triangle *triangle, MT_Scalar upper2)
     }
 }		
 
+inline bool isVertex(const MT_Vector3 *verts, int num_verts, const MT_Vector3& y)
+{
+    int i;
+    for (i = 0; i != num_verts; ++i)
+    {
+        if (verts[i] == y)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 inline int originInTetrahedron(const MT_Vector3& p1, const MT_Vector3& p2, 
                                const MT_Vector3& p3, const MT_Vector3& p4)
 {
@@ -108,16 +141,26 @@ inline int originInTetrahedron(const MT_Vector3& p1, const MT_Vector3& p2,
     return 0;
 }
 
-bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
-              MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+bool DT_PenDepthWorkspace::penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
+									MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
 {
+	if (m_yBuf.size() < MinSupportPoints)
+	{
+		m_pBuf.resize(MinSupportPoints);
+		m_qBuf.resize(MinSupportPoints);
+		m_yBuf.resize(MinSupportPoints);
+	}
+
+	MT_Point3  *pBuf = &m_pBuf[0];
+	MT_Point3  *qBuf = &m_qBuf[0];
+	MT_Vector3 *yBuf = &m_yBuf[0];
 	
 	int num_verts = gjk.getSimplex(pBuf, qBuf, yBuf);
     MT_Scalar tolerance = DT_Accuracy::tol_error * gjk.maxVertex();
     
-    num_triangles = 0;
+    m_triangleHeap.clear();
     
-    g_triangleStore.clear();
+    m_triangleStore.clear();
 	
     switch (num_verts) 
     {
@@ -135,8 +178,6 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
         dir /= length(dir);
         int        axis = dir.furthestAxis();
 	    
-        static const MT_Scalar sin_60 = sqrt(MT_Scalar(3.0)) * MT_Scalar(0.5);
-	    
         MT_Quaternion rot(dir[0] * sin_60, dir[1] * sin_60, dir[2] * sin_60, MT_Scalar(0.5));
         MT_Matrix3x3 rot_mat(rot);
 	    
@@ -183,10 +224,10 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
         
         if (bad_vertex == 0)
         {
-            Triangle *f0 = g_triangleStore.newTriangle(yBuf, 0, 1, 2);
-            Triangle *f1 = g_triangleStore.newTriangle(yBuf, 0, 3, 1);
-            Triangle *f2 = g_triangleStore.newTriangle(yBuf, 0, 2, 3);
-            Triangle *f3 = g_triangleStore.newTriangle(yBuf, 1, 3, 2);
+            Triangle *f0 = m_triangleStore.newTriangle(yBuf, 0, 1, 2);
+            Triangle *f1 = m_triangleStore.newTriangle(yBuf, 0, 3, 1);
+            Triangle *f2 = m_triangleStore.newTriangle(yBuf, 0, 2, 3);
+            Triangle *f3 = m_triangleStore.newTriangle(yBuf, 1, 3, 2);
             
             if (!(f0 && f0->getDist2() > MT_Scalar(0.0) &&
                   f1 && f1->getDist2() > MT_Scalar(0.0) &&
@@ -238,12 +279,12 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
         qBuf[4] = b.support(vv);
         yBuf[4] = pBuf[4] - qBuf[4];
 	    
-        Triangle* f0 = g_triangleStore.newTriangle(yBuf, 0, 1, 3);
-        Triangle* f1 = g_triangleStore.newTriangle(yBuf, 1, 2, 3);
-        Triangle* f2 = g_triangleStore.newTriangle(yBuf, 2, 0, 3); 
-        Triangle* f3 = g_triangleStore.newTriangle(yBuf, 0, 2, 4);
-        Triangle* f4 = g_triangleStore.newTriangle(yBuf, 2, 1, 4);
-        Triangle* f5 = g_triangleStore.newTriangle(yBuf, 1, 0, 4);
+        Triangle* f0 = m_triangleStore.newTriangle(yBuf, 0, 1, 3);
+        Triangle* f1 = m_triangleStore.newTriangle(yBuf, 1, 2, 3);
+        Triangle* f2 = m_triangleStore.newTriangle(yBuf, 2, 0, 3); 
+        Triangle* f3 = m_triangleStore.newTriangle(yBuf, 0, 2, 4);
+        Triangle* f4 = m_triangleStore.newTriangle(yBuf, 2, 1, 4);
+        Triangle* f5 = m_triangleStore.newTriangle(yBuf, 1, 0, 4);
         
         if (!(f0 && f0->getDist2() > MT_Scalar(0.0) &&
               f1 && f1->getDist2() > MT_Scalar(0.0) &&
@@ -282,7 +323,7 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
     // We have a polytope inside the Minkowski sum containing
     // the origin.
     
-    if (num_triangles == 0)
+    if (m_triangleHeap.empty())
     {
         return false;
     }
@@ -295,9 +336,9 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
     
     do 
     {
-        triangle = triangleHeap[0];
-        std::pop_heap(&triangleHeap[0], &triangleHeap[num_triangles], triangleComp);
-        --num_triangles;
+        triangle = m_triangleHeap.front();
+        std::pop_heap(m_triangleHeap.begin(), m_triangleHeap.end(), TriangleComp());
+        m_triangleHeap.pop_back();
 		
         if (!triangle->isObsolete()) 
         {
@@ -309,6 +350,17 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
                 assert(false);	
                 break;
             }
+
+            if (num_verts == int(m_yBuf.size()))
+            {
+                int size = GEN_min(2 * num_verts, MaxSupportPoints);
+                m_pBuf.resize(size);
+                m_qBuf.resize(size);
+                m_yBuf.resize(size);
+                pBuf = &m_pBuf[0];
+                qBuf = &m_qBuf[0];
+                yBuf = &m_yBuf[0];
+            }
 			
             pBuf[num_verts] = a.support( triangle->getClosest());
             qBuf[num_verts] = b.support(-triangle->getClosest());
@@ -322,14 +374,12 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
             MT_Scalar far_dist2 = far_dist * far_dist / triangle->getDist2();
             GEN_set_min(upper_bound2, far_dist2);
 			
+            // A support point that is already a vertex of the polytope 
+            // cannot enlarge it. Due to rounding errors the expansion would 
+            // otherwise go round in circles.
             MT_Scalar error = far_dist - triangle->getDist2();
-            if (error <= GEN_max(DT_Accuracy::rel_error2 * far_dist, tolerance)
-#if 1
-                || yBuf[index] == yBuf[(*triangle)[0]] 
-                || yBuf[index] == yBuf[(*triangle)[1]]
-                || yBuf[index] == yBuf[(*triangle)[2]]
-#endif
-                ) 
+            if (error <= GEN_max(DT_Accuracy::rel_error2 * far_dist, tolerance) ||
+                isVertex(yBuf, index, yBuf[index])) 
             {
                 break;
             }
@@ -341,16 +391,16 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
             // not be in the convex hull. Start local search
             // from this triangle.
 			
-            int i = g_triangleStore.getFree();
+            int i = m_triangleStore.getFree();
             
-            if (!triangle->silhouette(yBuf, index, g_triangleStore))
+            if (!triangle->silhouette(yBuf, index, m_triangleStore))
             {
                 break;
             }
 			
-            while (i != g_triangleStore.getFree())
+            while (i != m_triangleStore.getFree())
             {
-                Triangle *newTriangle = &g_triangleStore[i];
+                Triangle *newTriangle = &m_triangleStore[i];
                 //assert(triangle->getDist2() <= newTriangle->getDist2());
                 
                 addCandidate(newTriangle, upper_bound2);
@@ -359,10 +409,10 @@ bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b,
             }
         }
     }
-    while (num_triangles > 0 && triangleHeap[0]->getDist2() <= upper_bound2);
+    while (!m_triangleHeap.empty() && m_triangleHeap.front()->getDist2() <= upper_bound2);
 	
 #ifdef DEBUG    
-    std::cout << "#triangles left = " << num_triangles << std::endl;
+    std::cout << "#triangles left = " << m_triangleHeap.size() << std::endl;
 #endif
     
     v = triangle->getClosest();
@@ -24,13 +24,44 @@
 #ifndef DT_PENDEPTH_H
 #define DT_PENDEPTH_H
 
+#include <vector>
+
 #include "MT_Vector3.h"
 #include "MT_Point3.h"
+#include "DT_TriEdge.h"
 
 class DT_GJK;
 class DT_Convex;
 
-bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b, 
-			  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb);
+// Scratch storage of the expanding polytope algorithm. The buffers grow as 
+// needed and keep their capacity, so a workspace that is reused does not 
+// allocate. 'local' returns a workspace owned by the calling thread.
+class DT_PenDepthWorkspace {
+public:
+	DT_PenDepthWorkspace() {}
+
+	bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b, 
+				  MT_Vector3& v, MT_Point3& pa, MT_Point3& pb);
+
+	static DT_PenDepthWorkspace& local();
+
+private:
+	DT_PenDepthWorkspace(const DT_PenDepthWorkspace&);
+	DT_PenDepthWorkspace& operator=(const DT_PenDepthWorkspace&);
+
+	void addCandidate(Triangle *triangle, MT_Scalar upper2);
+
+	std::vector<MT_Point3>  m_pBuf;
+	std::vector<MT_Point3>  m_qBuf;
+	std::vector<MT_Vector3> m_yBuf;
+	std::vector<Triangle *> m_triangleHeap;
+	TriangleStore           m_triangleStore;
+};
+
+inline bool penDepth(const DT_GJK& gjk, const DT_Convex& a, const DT_Convex& b, 
+					 MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	return DT_PenDepthWorkspace::local().penDepth(gjk, a, b, v, pa, pb);
+}
 
 #endif
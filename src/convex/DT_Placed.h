@@ -0,0 +1,148 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_PLACED_H
+#define DT_PLACED_H
+
+#include "DT_Convex.h"
+#include "DT_Sphere.h"
+#include "DT_Box.h"
+#include "DT_LineSegment.h"
+#include "DT_Triangle.h"
+
+// A shape placed by a transform and enlarged by a margin. This is the 
+// Minkowski sum of a DT_Transform and a DT_Sphere in a single call, and for
+// a shape of a concrete type the support mapping of the shape is inlined.
+// Passed on as a DT_Convex, the wrapper costs one virtual call per support
+// point.
+
+template <typename Shape>
+class DT_Placed : public DT_Convex {
+public:
+	DT_Placed(const MT_Transform& xform, const Shape& shape, MT_Scalar margin) :
+		m_xform(xform),
+		m_shape(shape),
+		m_margin(margin)
+	{}
+
+	virtual MT_Point3 support(const MT_Vector3& v) const
+	{
+		MT_Point3 p = m_xform(supportPoint(m_shape, v * m_xform.getBasis()));
+		if (m_margin > MT_Scalar(0.0))
+		{
+			MT_Scalar s = v.length();
+			if (s > MT_Scalar(0.0))
+			{
+				s = m_margin / s;
+				p += MT_Vector3(v[0] * s, v[1] * s, v[2] * s);
+			}
+			else
+			{
+				p[0] += m_margin;
+			}
+		}
+		return p;
+	}
+
+private:
+	const MT_Transform& m_xform;
+	const Shape&        m_shape;
+	MT_Scalar           m_margin;
+};
+
+// 'place' calls 'query' on a shape placed as above, with the wrapper of the
+// concrete type of the shape if it is one of the primitives. A query is a 
+// function object with a result type 'Result' and a template call operator.
+
+template <typename Query>
+inline typename Query::Result place(const Query& query, 
+									const DT_Shape& shape, const MT_Transform& xform, MT_Scalar margin)
+{
+	switch (shape.getType())
+	{
+	case SPHERE:
+		return query(DT_Placed<DT_Sphere>(xform, static_cast<const DT_Sphere&>(shape), margin));
+	case BOX:
+		return query(DT_Placed<DT_Box>(xform, static_cast<const DT_Box&>(shape), margin));
+	case SEGMENT:
+		return query(DT_Placed<DT_LineSegment>(xform, static_cast<const DT_LineSegment&>(shape), margin));
+	case TRIANGLE:
+		return query(DT_Placed<DT_Triangle>(xform, static_cast<const DT_Triangle&>(shape), margin));
+	default:
+		return query(DT_Placed<DT_Convex>(xform, static_cast<const DT_Convex&>(shape), margin));
+	}
+}
+
+// Binds the first shape of a binary query, once it is placed
+template <typename Query, typename A>
+class DT_PlacedFirst {
+public:
+	typedef typename Query::Result Result;
+
+	DT_PlacedFirst(const Query& query, const A& a) :
+		m_query(query),
+		m_a(a)
+	{}
+
+	template <typename B>
+	Result operator()(const B& b) const { return m_query(m_a, b); }
+
+private:
+	const Query& m_query;
+	const A&     m_a;
+};
+
+template <typename Query>
+class DT_PlaceSecond {
+public:
+	typedef typename Query::Result Result;
+
+	DT_PlaceSecond(const Query& query, const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin) :
+		m_query(query),
+		m_b(b),
+		m_b2w(b2w),
+		m_b_margin(b_margin)
+	{}
+
+	template <typename A>
+	Result operator()(const A& a) const 
+	{ 
+		return place(DT_PlacedFirst<Query, A>(m_query, a), m_b, m_b2w, m_b_margin); 
+	}
+
+private:
+	const Query&        m_query;
+	const DT_Shape&     m_b;
+	const MT_Transform& m_b2w;
+	MT_Scalar           m_b_margin;
+};
+
+template <typename Query>
+inline typename Query::Result place(const Query& query, 
+									const DT_Shape& a, const MT_Transform& a2w, MT_Scalar a_margin,
+									const DT_Shape& b, const MT_Transform& b2w, MT_Scalar b_margin)
+{
+	return place(DT_PlaceSecond<Query>(query, b, b2w, b_margin), a, a2w, a_margin);
+}
+
+#endif
@@ -297,8 +297,6 @@ DT_Polyhedron::DT_Polyhedron(const DT_VertexBase *base, DT_Count count, const DT
 		++m_start_vertex;
 		assert(m_start_vertex < m_count);
 	}
-
-	m_curr_vertex = m_start_vertex;
 } 
 
 
@@ -312,20 +310,20 @@ DT_Polyhedron::~DT_Polyhedron()
 
 MT_Scalar DT_Polyhedron::supportH(const MT_Vector3& v) const 
 {
-    m_curr_vertex = m_start_vertex;
-    MT_Scalar d = (*this)[m_curr_vertex].dot(v);
+    DT_Index curr_vertex = m_start_vertex;
+    MT_Scalar d = (*this)[curr_vertex].dot(v);
     MT_Scalar h = d;
 	int curr_layer;
 	for (curr_layer = m_cobound[m_start_vertex].size(); curr_layer != 0; --curr_layer)
 	{
-		const DT_IndexArray& curr_cobound = m_cobound[m_curr_vertex][curr_layer-1];
+		const DT_IndexArray& curr_cobound = m_cobound[curr_vertex][curr_layer-1];
         DT_Index i;
 		for (i = 0; i != curr_cobound.size(); ++i) 
 		{
 			d = (*this)[curr_cobound[i]].dot(v);
 			if (d > h)
 			{
-				m_curr_vertex = curr_cobound[i];
+				curr_vertex = curr_cobound[i];
 				h = d;
 			}
 		}
@@ -336,26 +334,26 @@ MT_Scalar DT_Polyhedron::supportH(const MT_Vector3& v) const
 
 MT_Point3 DT_Polyhedron::support(const MT_Vector3& v) const 
 {
-	m_curr_vertex = m_start_vertex;
-    MT_Scalar d = (*this)[m_curr_vertex].dot(v);
+	DT_Index curr_vertex = m_start_vertex;
+    MT_Scalar d = (*this)[curr_vertex].dot(v);
     MT_Scalar h = d;
 	int curr_layer;
 	for (curr_layer = m_cobound[m_start_vertex].size(); curr_layer != 0; --curr_layer)
 	{
-		const DT_IndexArray& curr_cobound = m_cobound[m_curr_vertex][curr_layer-1];
+		const DT_IndexArray& curr_cobound = m_cobound[curr_vertex][curr_layer-1];
         DT_Index i;
 		for (i = 0; i != curr_cobound.size(); ++i) 
 		{
 			d = (*this)[curr_cobound[i]].dot(v);
 			if (d > h)
 			{
-				m_curr_vertex = curr_cobound[i];
+				curr_vertex = curr_cobound[i];
 				h = d;
 			}
 		}
 	}
 	
-    return (*this)[m_curr_vertex];
+    return (*this)[curr_vertex];
 }
 
 #else
@@ -363,12 +361,13 @@ MT_Point3 DT_Polyhedron::support(const MT_Vector3& v) const
 MT_Scalar DT_Polyhedron::supportH(const MT_Vector3& v) const 
 {
     int last_vertex = -1;
-    MT_Scalar d = (*this)[m_curr_vertex].dot(v);
+    DT_Index curr_vertex = m_start_vertex;
+    MT_Scalar d = (*this)[curr_vertex].dot(v);
     MT_Scalar h = d;
 	
 	for (;;) 
 	{
-        DT_IndexArray& curr_cobound = m_cobound[m_curr_vertex][0];
+        DT_IndexArray& curr_cobound = m_cobound[curr_vertex][0];
         int i = 0, n = curr_cobound.size(); 
         while (i != n && 
                (curr_cobound[i] == last_vertex || 
@@ -382,8 +381,8 @@ MT_Scalar DT_Polyhedron::supportH(const MT_Vector3& v) const
 			break;
 		}
 		
-        last_vertex = m_curr_vertex;
-        m_curr_vertex = curr_cobound[i];
+        last_vertex = curr_vertex;
+        curr_vertex = curr_cobound[i];
         h = d;
     }
     return h;
@@ -392,12 +391,13 @@ MT_Scalar DT_Polyhedron::supportH(const MT_Vector3& v) const
 MT_Point3 DT_Polyhedron::support(const MT_Vector3& v) const 
 {
 	int last_vertex = -1;
-    MT_Scalar d = (*this)[m_curr_vertex].dot(v);
+    DT_Index curr_vertex = m_start_vertex;
+    MT_Scalar d = (*this)[curr_vertex].dot(v);
     MT_Scalar h = d;
 	
     for (;;)
 	{
-        DT_IndexArray& curr_cobound = m_cobound[m_curr_vertex][0];
+        DT_IndexArray& curr_cobound = m_cobound[curr_vertex][0];
         int i = 0, n = curr_cobound.size();
         while (i != n && 
                (curr_cobound[i] == last_vertex || 
@@ -411,11 +411,11 @@ MT_Point3 DT_Polyhedron::support(const MT_Vector3& v) const
 			break;
 		}
 		
-		last_vertex = m_curr_vertex;
-        m_curr_vertex = curr_cobound[i];
+		last_vertex = curr_vertex;
+        curr_vertex = curr_cobound[i];
         h = d;
     }
-    return (*this)[m_curr_vertex];
+    return (*this)[curr_vertex];
 }
 
 #endif
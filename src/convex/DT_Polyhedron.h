@@ -62,7 +62,6 @@ private:
 	MT_Point3			 *m_verts;
 	T_MultiIndexArray    *m_cobound;
     DT_Index              m_start_vertex;
-	mutable DT_Index      m_curr_vertex;
 };
 
 #else 
@@ -41,6 +41,7 @@ public:
     virtual MT_Point3 support(const MT_Vector3& v) const;
 
 	MT_Point3 operator[](int i) const { return (*m_base)[m_index[i]]; }
+	DT_Index  getIndex(int i) const { return m_index[i]; }
     DT_Count numVerts() const { return m_index.size(); }
 
 protected:
@@ -32,9 +32,15 @@
 
 class DT_Object;
 
+// The primitives that have closed-form tests of their own are told apart 
+// from the other convex shapes. Their types have the CONVEX bit set.
 enum DT_ShapeType {
-    COMPLEX,
-    CONVEX
+    COMPLEX  = 0x0,
+    CONVEX   = 0x1,
+    SPHERE   = 0x3,
+    BOX      = 0x5,
+    SEGMENT  = 0x7,
+    TRIANGLE = 0x9
 };
 
 class DT_Shape {
@@ -44,6 +50,14 @@ public:
 	virtual MT_BBox bbox(const MT_Transform& t, MT_Scalar margin) const = 0;
 	virtual bool ray_cast(const MT_Point3& source, const MT_Point3& target, MT_Scalar& param, MT_Vector3& normal) const = 0;
 
+	// Whether the ray hits the shape before 'param'. Shapes made of parts can
+	// stop at the first part that is hit, rather than look for the nearest.
+	virtual bool ray_test(const MT_Point3& source, const MT_Point3& target, MT_Scalar param) const
+	{
+		MT_Vector3 normal;
+		return ray_cast(source, target, param, normal);
+	}
+
 protected:
 	DT_Shape()  {}
 };
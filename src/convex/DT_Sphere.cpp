@@ -29,21 +29,6 @@ MT_Scalar DT_Sphere::supportH(const MT_Vector3& v) const
 	return m_radius * v.length();
 }
 
-MT_Point3 DT_Sphere::support(const MT_Vector3& v) const 
-{
-   MT_Scalar s = v.length();
-	
-	if (s > MT_Scalar(0.0))
-	{
-		s = m_radius / s;
-		return MT_Point3(v[0] * s, v[1] * s, v[2] * s);
-	}
-	else
-	{
-		return MT_Point3(m_radius, MT_Scalar(0.0), MT_Scalar(0.0));
-	}
-}
-
 bool DT_Sphere::ray_cast(const MT_Point3& source, const MT_Point3& target,
 						 MT_Scalar& param, MT_Vector3& normal) const 
 {
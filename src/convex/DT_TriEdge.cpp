@@ -23,7 +23,14 @@
 
 #include "DT_TriEdge.h"
 
-TriangleStore g_triangleStore;
+TriangleStore::~TriangleStore()
+{
+	std::vector<Triangle *>::iterator it;
+	for (it = m_blocks.begin(); it != m_blocks.end(); ++it)
+	{
+		delete [] *it;
+	}
+}
 
 bool link(const Edge& edge0, const Edge& edge1) 
 {
@@ -140,50 +140,55 @@ public:
 };
   
 	
-static const int MaxTriangles = 200;
-
+// The triangles are allocated in blocks that are kept when the store is 
+// cleared, so that the triangles do not move while the store grows and a 
+// reused store does not allocate.
 class TriangleStore
 {
 private:
+	enum { BLOCK_SHIFT = 8, BLOCK_SIZE = 1 << BLOCK_SHIFT };
 
+	TriangleStore(const TriangleStore&);
+	TriangleStore& operator=(const TriangleStore&);
 
-	Triangle m_triangles[MaxTriangles];
-	int      m_free;
+	std::vector<Triangle *> m_blocks;
+	int                     m_free;
 public:
 	TriangleStore()
 	  : m_free(0)
 	{}
 
+	~TriangleStore();
+
 	void clear() { m_free = 0; }
 
 	int getFree() const { return m_free; }
 
-	Triangle& operator[](int i) { return m_triangles[i]; }
-	Triangle& last() { return m_triangles[m_free - 1]; }
+	Triangle& operator[](int i) { return m_blocks[i >> BLOCK_SHIFT][i & (BLOCK_SIZE - 1)]; }
+	Triangle& last() { return (*this)[m_free - 1]; }
 
 	void setFree(int backup) { m_free = backup; }
 
 
 	Triangle *newTriangle(const MT_Vector3 *verts, Index_t i0, Index_t i1, Index_t i2) 
 	{ 
-		Triangle *newTriangle = 0;
-		if (m_free != MaxTriangles)
+		if (m_free == int(m_blocks.size()) << BLOCK_SHIFT)
+		{
+			m_blocks.push_back(new Triangle[BLOCK_SIZE]);
+		}
+
+		Triangle *newTriangle = &(*this)[m_free++];
+		new (newTriangle) Triangle(i0, i1, i2);
+		if (!newTriangle->computeClosest(verts))
 		{
-			newTriangle = &m_triangles[m_free++];
-			new (newTriangle) Triangle(i0, i1, i2);
-			if (!newTriangle->computeClosest(verts))
-			{
-				--m_free;
-				newTriangle = 0;
-			}
+			--m_free;
+			newTriangle = 0;
 		}
 
 		return newTriangle;
 	}
 };
 
-extern TriangleStore g_triangleStore;
-
 
 inline int circ_next(int i) { return (i + 1) % 3; } 
 inline int circ_prev(int i) { return (i + 2) % 3; } 
@@ -35,13 +35,6 @@ MT_Scalar DT_Triangle::supportH(const MT_Vector3& v) const
     return GEN_max(GEN_max(v.dot((*this)[0]), v.dot((*this)[1])), v.dot((*this)[2]));
 }
 
-MT_Point3 DT_Triangle::support(const MT_Vector3& v) const
-{
-    MT_Vector3 dots(v.dot((*this)[0]), v.dot((*this)[1]), v.dot((*this)[2]));
-
-	return (*this)[dots.maxAxis()];
-}
-
 bool DT_Triangle::ray_cast(const MT_Point3& source, const MT_Point3& target, 
 						   MT_Scalar& param, MT_Vector3& normal) const 
 {
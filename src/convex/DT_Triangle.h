@@ -48,12 +48,20 @@ public:
 		m_index[2] = index[2];
 	}
 
+	virtual DT_ShapeType getType() const { return TRIANGLE; }
+
 	virtual MT_BBox bbox() const;
     virtual MT_Scalar supportH(const MT_Vector3& v) const;
-    virtual MT_Point3 support(const MT_Vector3& v) const;
+    virtual MT_Point3 support(const MT_Vector3& v) const
+	{
+		MT_Vector3 dots(v.dot((*this)[0]), v.dot((*this)[1]), v.dot((*this)[2]));
+		
+		return (*this)[dots.maxAxis()];
+	}
 	virtual bool ray_cast(const MT_Point3& source, const MT_Point3& target, MT_Scalar& lambda, MT_Vector3& normal) const;
 
     MT_Point3 operator[](int i) const { return (*m_base)[m_index[i]]; }
+    DT_Index  getIndex(int i) const { return m_index[i]; }
 
 private:
     const DT_VertexBase *m_base;
@@ -0,0 +1,596 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#include "DT_Witness.h"
+#include "GEN_MinMax.h"
+
+#include <assert.h>
+
+// A unit vector orthogonal to 'v', or any unit vector if 'v' is zero
+static MT_Vector3 perpendicular(const MT_Vector3& v)
+{
+	MT_Vector3 axis(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
+	axis[v.furthestAxis()] = MT_Scalar(1.0);
+	MT_Vector3 u = v.cross(axis);
+	MT_Scalar len = u.length();
+	return len > MT_Scalar(0.0) ? u / len : axis;
+}
+
+// Sets the normal and distance from the closest points. If the cores touch, 
+// the normal is taken along 'v', or orthogonal to it if it is zero.
+static void set_normal(DT_Witness& w, const MT_Vector3& v)
+{
+	MT_Vector3 diff = w.m_a_point - w.m_b_point;
+	MT_Scalar dist = diff.length();
+	if (dist > MT_Scalar(0.0))
+	{
+		w.m_normal = diff / dist;
+		w.m_dist = dist;
+	}
+	else
+	{
+		MT_Scalar len = v.length();
+		w.m_normal = len > MT_Scalar(0.0) ? v / len : perpendicular(v);
+		w.m_dist = MT_Scalar(0.0);
+	}
+}
+
+static MT_Point3 closest_on_segment(const MT_Point3& p, const MT_Point3& source, const MT_Point3& target)
+{
+	MT_Vector3 d = target - source;
+	MT_Scalar len2 = d.length2();
+	return len2 > MT_Scalar(0.0) ? 
+		source + d * GEN_clamped((p - source).dot(d) / len2, MT_Scalar(0.0), MT_Scalar(1.0)) :
+		source;
+}
+
+void segment_segment(const MT_Point3& a_source, const MT_Point3& a_target, 
+					 const MT_Point3& b_source, const MT_Point3& b_target, 
+					 DT_Witness& w)
+{
+	MT_Vector3 da = a_target - a_source;
+	MT_Vector3 db = b_target - b_source;
+	MT_Vector3 r = a_source - b_source;
+	MT_Scalar a = da.length2();
+	MT_Scalar e = db.length2();
+	MT_Scalar f = db.dot(r);
+
+	// The points are at parameters 's' and 't' on the segments
+	MT_Scalar s = MT_Scalar(0.0);
+	MT_Scalar t = MT_Scalar(0.0);
+	if (a == MT_Scalar(0.0))
+	{
+		if (e > MT_Scalar(0.0))
+		{
+			t = GEN_clamped(f / e, MT_Scalar(0.0), MT_Scalar(1.0));
+		}
+	}
+	else
+	{
+		MT_Scalar c = da.dot(r);
+		if (e == MT_Scalar(0.0))
+		{
+			s = GEN_clamped(-c / a, MT_Scalar(0.0), MT_Scalar(1.0));
+		}
+		else
+		{
+			// For (nearly) parallel segments any 's' will do 
+			MT_Scalar b = da.dot(db);
+			MT_Scalar denom = a * e - b * b;
+			if (denom > MT_EPSILON * a * e)
+			{
+				s = GEN_clamped((b * f - c * e) / denom, MT_Scalar(0.0), MT_Scalar(1.0));
+			}
+
+			t = (b * s + f) / e;
+			if (t < MT_Scalar(0.0))
+			{
+				t = MT_Scalar(0.0);
+				s = GEN_clamped(-c / a, MT_Scalar(0.0), MT_Scalar(1.0));
+			}
+			else if (t > MT_Scalar(1.0))
+			{
+				t = MT_Scalar(1.0);
+				s = GEN_clamped((b - c) / a, MT_Scalar(0.0), MT_Scalar(1.0));
+			}
+		}
+	}
+
+	w.m_a_point = a_source + da * s;
+	w.m_b_point = b_source + db * t;
+	MT_Vector3 normal = da.cross(db);
+	set_normal(w, normal.length2() > MT_Scalar(0.0) ? normal : perpendicular(a > MT_Scalar(0.0) ? da : db));
+}
+
+void triangle_point(const MT_Point3& a0, const MT_Point3& a1, const MT_Point3& a2, 
+					const MT_Point3& b, DT_Witness& w)
+{
+	// The Voronoi regions of the vertices and edges are tried in turn
+	MT_Vector3 e1 = a1 - a0;
+	MT_Vector3 e2 = a2 - a0;
+	MT_Vector3 normal = e1.cross(e2);
+
+	w.m_b_point = b;
+
+	MT_Vector3 p0 = b - a0;
+	MT_Scalar d1 = e1.dot(p0);
+	MT_Scalar d2 = e2.dot(p0);
+	if (d1 <= MT_Scalar(0.0) && d2 <= MT_Scalar(0.0))
+	{
+		w.m_a_point = a0;
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Vector3 p1 = b - a1;
+	MT_Scalar d3 = e1.dot(p1);
+	MT_Scalar d4 = e2.dot(p1);
+	if (d3 >= MT_Scalar(0.0) && d4 <= d3)
+	{
+		w.m_a_point = a1;
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Scalar vc = d1 * d4 - d3 * d2;
+	if (vc <= MT_Scalar(0.0) && d1 >= MT_Scalar(0.0) && d3 <= MT_Scalar(0.0))
+	{
+		w.m_a_point = a0 + e1 * (d1 / (d1 - d3));
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Vector3 p2 = b - a2;
+	MT_Scalar d5 = e1.dot(p2);
+	MT_Scalar d6 = e2.dot(p2);
+	if (d6 >= MT_Scalar(0.0) && d5 <= d6)
+	{
+		w.m_a_point = a2;
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Scalar vb = d5 * d2 - d1 * d6;
+	if (vb <= MT_Scalar(0.0) && d2 >= MT_Scalar(0.0) && d6 <= MT_Scalar(0.0))
+	{
+		w.m_a_point = a0 + e2 * (d2 / (d2 - d6));
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Scalar va = d3 * d6 - d5 * d4;
+	if (va <= MT_Scalar(0.0) && d4 >= d3 && d5 >= d6)
+	{
+		w.m_a_point = a1 + (a2 - a1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		set_normal(w, normal);
+		return;
+	}
+
+	MT_Scalar sum = va + vb + vc;
+	if (sum > MT_Scalar(0.0))
+	{
+		w.m_a_point = a0 + e1 * (vb / sum) + e2 * (vc / sum);
+	}
+	else
+	{
+		// A degenerate triangle is as close as its nearest edge 
+		MT_Point3 q0 = closest_on_segment(b, a0, a1);
+		MT_Point3 q1 = closest_on_segment(b, a1, a2);
+		w.m_a_point = q0.distance2(b) < q1.distance2(b) ? q0 : q1;
+	}
+	set_normal(w, normal);
+}
+
+void point_box(const MT_Point3& a, const MT_Point3& b_center, const MT_Vector3 b_axis[3], 
+			   DT_Witness& w)
+{
+	MT_Vector3 d = a - b_center;
+	MT_Point3 q = b_center;
+	bool inside = true;
+
+	// The face that is nearest to 'a' if the box holds it
+	int face = 0;
+	MT_Scalar face_dist = MT_INFINITY;
+	MT_Scalar face_sign = MT_Scalar(1.0);
+
+	int i;
+	for (i = 0; i != 3; ++i)
+	{
+		MT_Scalar len2 = b_axis[i].length2();
+		MT_Scalar t = d.dot(b_axis[i]) / len2;
+		if (t > MT_Scalar(1.0))
+		{
+			t = MT_Scalar(1.0);
+			inside = false;
+		}
+		else if (t < MT_Scalar(-1.0))
+		{
+			t = MT_Scalar(-1.0);
+			inside = false;
+		}
+		else if (inside)
+		{
+			MT_Scalar dist = (MT_Scalar(1.0) - MT_abs(t)) * MT_sqrt(len2);
+			if (dist < face_dist)
+			{
+				face = i;
+				face_dist = dist;
+				face_sign = t < MT_Scalar(0.0) ? MT_Scalar(-1.0) : MT_Scalar(1.0);
+			}
+		}
+		q += b_axis[i] * t;
+	}
+
+	w.m_a_point = a;
+	if (inside)
+	{
+		w.m_normal = b_axis[face] * (face_sign / b_axis[face].length());
+		w.m_dist = -face_dist;
+		w.m_b_point = a + w.m_normal * face_dist;
+	}
+	else 
+	{
+		w.m_b_point = q;
+		set_normal(w, d);
+	}
+}
+
+// The vertex of a box that is furthest along 'v'
+static MT_Point3 box_support(const MT_Point3& center, const MT_Vector3 axis[3], const MT_Vector3& v)
+{
+	MT_Point3 p = center;
+	int i;
+	for (i = 0; i != 3; ++i)
+	{
+		p += v.dot(axis[i]) < MT_Scalar(0.0) ? -axis[i] : axis[i];
+	}
+	return p;
+}
+
+// The edge of a box along 'axis[i]' through the vertex 'p'
+static void box_edge(const MT_Point3& center, const MT_Vector3 axis[3], int i, const MT_Point3& p,
+					 MT_Point3& source, MT_Point3& target)
+{
+	MT_Point3 mid = p - axis[i] * ((p - center).dot(axis[i]) / axis[i].length2());
+	source = mid - axis[i];
+	target = mid + axis[i];
+}
+
+// Points of boxes that are apart by no more than this fraction over the 
+// separation along an axis are taken to be the closest points
+static const MT_Scalar exact_tolerance = MT_Scalar(1.0e-5);
+
+// The closest points of boxes that are apart are a vertex and a point of 
+// the other box, or points of two edges. On entry 'w' holds a pair of points
+// of the boxes and 'normal' is a separating axis. A feature is skipped if it
+// lies further from the other box along this axis than the closest points 
+// found so far.
+static void box_box_closest(const MT_Point3& a_center, const MT_Vector3 a_axis[3], 
+							const MT_Point3& b_center, const MT_Vector3 b_axis[3], 
+							const MT_Vector3& normal, DT_Witness& w)
+{
+	MT_Point3 a_points[8], b_points[8];
+	MT_Scalar a_height[8], b_height[8];
+	int a_low = 0, b_high = 0;
+	int i, j, k, l;
+	for (i = 0; i != 8; ++i)
+	{
+		a_points[i] = a_center;
+		b_points[i] = b_center;
+		for (k = 0; k != 3; ++k)
+		{
+			a_points[i] += i & (1 << k) ? a_axis[k] : -a_axis[k];
+			b_points[i] += i & (1 << k) ? b_axis[k] : -b_axis[k];
+		}
+		a_height[i] = normal.dot(a_points[i]);
+		b_height[i] = normal.dot(b_points[i]);
+		if (a_height[i] < a_height[a_low])
+		{
+			a_low = i;
+		}
+		if (b_height[i] > b_height[b_high])
+		{
+			b_high = i;
+		}
+	}
+
+	DT_Witness v;
+	MT_Scalar best = w.m_a_point.distance(w.m_b_point);
+	for (i = 0; i != 8; ++i)
+	{
+		if (a_height[i] - b_height[b_high] < best)
+		{
+			point_box(a_points[i], b_center, b_axis, v);
+			MT_Scalar dist = v.m_a_point.distance(v.m_b_point);
+			if (dist < best)
+			{
+				best = dist;
+				w.m_a_point = v.m_a_point;
+				w.m_b_point = v.m_b_point;
+			}
+		}
+		if (a_height[a_low] - b_height[i] < best)
+		{
+			point_box(b_points[i], a_center, a_axis, v);
+			MT_Scalar dist = v.m_a_point.distance(v.m_b_point);
+			if (dist < best)
+			{
+				best = dist;
+				w.m_a_point = v.m_b_point;
+				w.m_b_point = v.m_a_point;
+			}
+		}
+	}
+
+	// The edges along an axis run from the vertices on its negative side. 
+	// Edges whose midpoints are too far apart are skipped as well.
+	MT_Scalar a_len[3], b_len[3];
+	for (k = 0; k != 3; ++k)
+	{
+		a_len[k] = a_axis[k].length();
+		b_len[k] = b_axis[k].length();
+	}
+	for (i = 0; i != 8; ++i)
+	{
+		for (k = 0; k != 3; ++k)
+		{
+			int a_end = i | (1 << k);
+			MT_Scalar a_min = GEN_min(a_height[i], a_height[a_end]);
+			if (i == a_end || a_min - b_height[b_high] >= best)
+			{
+				continue;
+			}
+			MT_Point3 a_mid = a_points[i] + a_axis[k];
+			for (j = 0; j != 8; ++j)
+			{
+				for (l = 0; l != 3; ++l)
+				{
+					int b_end = j | (1 << l);
+					if (j == b_end || a_min - GEN_max(b_height[j], b_height[b_end]) >= best)
+					{
+						continue;
+					}
+					MT_Scalar reach = best + a_len[k] + b_len[l];
+					if (a_mid.distance2(b_points[j] + b_axis[l]) >= reach * reach)
+					{
+						continue;
+					}
+					segment_segment(a_points[i], a_points[a_end], b_points[j], b_points[b_end], v);
+					MT_Scalar dist = v.m_a_point.distance(v.m_b_point);
+					if (dist < best)
+					{
+						best = dist;
+						w.m_a_point = v.m_a_point;
+						w.m_b_point = v.m_b_point;
+					}
+				}
+			}
+		}
+	}
+}
+
+void box_box(const MT_Point3& a_center, const MT_Vector3 a_axis[3], 
+			 const MT_Point3& b_center, const MT_Vector3 b_axis[3], 
+			 MT_Scalar max_dist, DT_Witness& w)
+{
+	MT_Vector3 d = a_center - b_center;
+	w.m_dist = -MT_INFINITY;
+
+	// The normals of the faces of both boxes come first, then the cross 
+	// products of their edges. The cross products of (nearly) parallel edges 
+	// are left out, as their directions are too inaccurate. The normals of 
+	// the faces cover them. For a cross product the indices of the edges are 
+	// kept, for the others they are -1.
+	MT_Vector3 axes[15];
+	int a_edge[15], b_edge[15];
+	int num_axes = 0;
+	int i, j;
+	for (i = 0; i != 3; ++i)
+	{
+		a_edge[num_axes] = -1;
+		b_edge[num_axes] = -1;
+		axes[num_axes++] = a_axis[(i + 1) % 3].cross(a_axis[(i + 2) % 3]);
+		a_edge[num_axes] = -1;
+		b_edge[num_axes] = -1;
+		axes[num_axes++] = b_axis[(i + 1) % 3].cross(b_axis[(i + 2) % 3]);
+	}
+	for (i = 0; i != 3; ++i)
+	{
+		MT_Scalar tol = MT_Scalar(1.0e-6) * a_axis[i].length2();
+		for (j = 0; j != 3; ++j)
+		{
+			MT_Vector3 axis = a_axis[i].cross(b_axis[j]);
+			if (axis.length2() > tol * b_axis[j].length2())
+			{
+				a_edge[num_axes] = i;
+				b_edge[num_axes] = j;
+				axes[num_axes++] = axis;
+			}
+		}
+	}
+
+	int best = -1;
+	for (i = 0; i != num_axes; ++i)
+	{
+		const MT_Vector3& axis = axes[i];
+		MT_Scalar len = axis.length();
+		if (len == MT_Scalar(0.0))
+		{
+			continue;
+		}
+		
+		MT_Scalar s = axis.dot(d);
+		MT_Scalar gap = (MT_abs(s) - 
+						 MT_abs(axis.dot(a_axis[0])) - MT_abs(axis.dot(a_axis[1])) - MT_abs(axis.dot(a_axis[2])) -
+						 MT_abs(axis.dot(b_axis[0])) - MT_abs(axis.dot(b_axis[1])) - MT_abs(axis.dot(b_axis[2]))) / len;
+		if (gap > w.m_dist)
+		{
+			best = i;
+			w.m_dist = gap;
+			w.m_normal = axis * ((s < MT_Scalar(0.0) ? MT_Scalar(-1.0) : MT_Scalar(1.0)) / len);
+			if (gap > max_dist)
+			{
+				break;
+			}
+		}
+	}
+	assert(best != -1);
+
+	if (w.m_dist > MT_Scalar(0.0))
+	{
+		if (w.m_dist <= max_dist)
+		{
+			// The supporting features along the normal are tried first. If 
+			// they are no further apart than the boxes along the normal, they
+			// hold the closest points, else the other features are searched.
+			MT_Vector3 normal = w.m_normal;
+			MT_Scalar gap = w.m_dist;
+			DT_Witness v;
+			if (a_edge[best] != -1)
+			{
+				MT_Point3 a_source, a_target, b_source, b_target;
+				box_edge(a_center, a_axis, a_edge[best], box_support(a_center, a_axis, -normal), a_source, a_target);
+				box_edge(b_center, b_axis, b_edge[best], box_support(b_center, b_axis, normal), b_source, b_target);
+				segment_segment(a_source, a_target, b_source, b_target, v);
+				w.m_a_point = v.m_a_point;
+				w.m_b_point = v.m_b_point;
+			}
+			else if (best % 2 == 0)
+			{
+				point_box(box_support(b_center, b_axis, normal), a_center, a_axis, v);
+				w.m_a_point = v.m_b_point;
+				w.m_b_point = v.m_a_point;
+			}
+			else
+			{
+				point_box(box_support(a_center, a_axis, -normal), b_center, b_axis, v);
+				w.m_a_point = v.m_a_point;
+				w.m_b_point = v.m_b_point;
+			}
+
+			if (w.m_a_point.distance(w.m_b_point) > gap * (MT_Scalar(1.0) + exact_tolerance))
+			{
+				box_box_closest(a_center, a_axis, b_center, b_axis, normal, w);
+			}
+			set_normal(w, normal);
+		}
+		return;
+	}
+
+	// The boxes overlap. The deepest points along the normal are taken from 
+	// the supporting features of the boxes: the face of one box and a vertex
+	// of the other, or a pair of edges.
+	if (a_edge[best] != -1)
+	{
+		MT_Point3 a_source, a_target, b_source, b_target;
+		box_edge(a_center, a_axis, a_edge[best], box_support(a_center, a_axis, -w.m_normal), a_source, a_target);
+		box_edge(b_center, b_axis, b_edge[best], box_support(b_center, b_axis, w.m_normal), b_source, b_target);
+		MT_Vector3 normal = w.m_normal;
+		MT_Scalar dist = w.m_dist;
+		segment_segment(a_source, a_target, b_source, b_target, w);
+		w.m_normal = normal;
+		w.m_dist = dist;
+		w.m_b_point = w.m_a_point - normal * dist;
+	}
+	else if (best % 2 == 0)
+	{
+		w.m_b_point = box_support(b_center, b_axis, w.m_normal);
+		w.m_a_point = w.m_b_point + w.m_normal * w.m_dist;
+	}
+	else
+	{
+		w.m_a_point = box_support(a_center, a_axis, -w.m_normal);
+		w.m_b_point = w.m_a_point - w.m_normal * w.m_dist;
+	}
+}
+
+// A point of both enlarged cores, if they meet
+static MT_Point3 common(const DT_Witness& w)
+{
+	if (w.m_dist < MT_Scalar(0.0))
+	{
+		return w.m_a_point;
+	}
+	MT_Scalar t = GEN_clamped((w.m_dist + w.m_b_radius - w.m_a_radius) * MT_Scalar(0.5), 
+							  MT_Scalar(0.0), w.m_dist);
+	return w.m_b_point + w.m_normal * t;
+}
+
+bool intersect(const DT_Witness& w, MT_Vector3& v)
+{
+	MT_Scalar gap = w.m_dist - w.m_a_radius - w.m_b_radius;
+	if (gap > MT_Scalar(0.0))
+	{
+		v = w.m_normal * gap;
+		return false;
+	}
+
+	v.setValue(MT_Scalar(0.0), MT_Scalar(0.0), MT_Scalar(0.0));
+	return true;
+}
+
+bool common_point(const DT_Witness& w, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	if (!intersect(w, v))
+	{
+		return false;
+	}
+
+	pa = common(w);
+	pb = pa;
+	return true;
+}
+
+bool penetration_depth(const DT_Witness& w, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb)
+{
+	// As with the penetration depth method, v == pa - pb. 
+	MT_Scalar gap = w.m_dist - w.m_a_radius - w.m_b_radius;
+	v = w.m_normal * gap;
+	if (gap > MT_Scalar(0.0))
+	{
+		return false;
+	}
+
+	pa = w.m_a_point - w.m_normal * w.m_a_radius;
+	pb = w.m_b_point + w.m_normal * w.m_b_radius;
+	return true;
+}
+
+MT_Scalar closest_points(const DT_Witness& w, MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb)
+{
+	MT_Scalar gap = w.m_dist - w.m_a_radius - w.m_b_radius;
+	if (gap > MT_Scalar(0.0))
+	{
+		MT_Scalar dist2 = gap * gap;
+		if (dist2 <= max_dist2)
+		{
+			pa = w.m_a_point - w.m_normal * w.m_a_radius;
+			pb = w.m_b_point + w.m_normal * w.m_b_radius;
+		}
+		return dist2;
+	}
+
+	pa = common(w);
+	pb = pa;
+	return MT_Scalar(0.0);
+}
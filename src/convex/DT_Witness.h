@@ -0,0 +1,80 @@
+/*
+ * SOLID - Software Library for Interference Detection
+ * 
+ * Copyright (C) 2001-2003  Dtecta.  All rights reserved.
+ *
+ * This library may be distributed under the terms of the Q Public License
+ * (QPL) as defined by Trolltech AS of Norway and appearing in the file
+ * LICENSE.QPL included in the packaging of this file.
+ *
+ * This library may be distributed and/or modified under the terms of the
+ * GNU General Public License (GPL) version 2 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This library is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Commercial use or any other use of this library not covered by either 
+ * the QPL or the GPL requires an additional license from Dtecta. 
+ * Please contact info@dtecta.com for enquiries about the terms of commercial
+ * use of this library.
+ */
+
+#ifndef DT_WITNESS_H
+#define DT_WITNESS_H
+
+#include "MT_Point3.h"
+#include "MT_Vector3.h"
+
+// Closed-form tests for pairs of primitives that are each a core (a point, 
+// a line segment, a triangle or a box) enlarged by a radius. A witness holds
+// the closest points of the cores, the unit normal pointing from the core of
+// 'b' to that of 'a', and the distance of the cores along this normal, which 
+// is negative if the core of 'b' holds the point that is the core of 'a'. 
+// Thus m_a_point == m_b_point + m_normal * m_dist.
+
+class DT_Witness {
+public:
+	MT_Point3  m_a_point;
+	MT_Point3  m_b_point;
+	MT_Vector3 m_normal;
+	MT_Scalar  m_dist;
+	MT_Scalar  m_a_radius;
+	MT_Scalar  m_b_radius;
+};
+
+// Line segments, which may be points
+void segment_segment(const MT_Point3& a_source, const MT_Point3& a_target, 
+					 const MT_Point3& b_source, const MT_Point3& b_target, 
+					 DT_Witness& w);
+
+void triangle_point(const MT_Point3& a0, const MT_Point3& a1, const MT_Point3& a2, 
+					const MT_Point3& b, DT_Witness& w);
+
+// The box is given by its center and the vectors from the center to the
+// centers of three adjacent faces, which must be orthogonal.
+void point_box(const MT_Point3& a, const MT_Point3& b_center, const MT_Vector3 b_axis[3], 
+			   DT_Witness& w);
+
+// The boxes must not be sheared, as for 'point_box'. The separating axis 
+// test yields the normal and the distance along it, which is exact if the 
+// boxes overlap and a lower bound for their distance otherwise. If the boxes 
+// are apart by no more than 'max_dist' along this normal, their closest 
+// points are searched for. Else the points are not set, which leaves a 
+// witness that is only good for telling that the boxes are further apart.
+void box_box(const MT_Point3& a_center, const MT_Vector3 a_axis[3], 
+			 const MT_Point3& b_center, const MT_Vector3 b_axis[3], 
+			 MT_Scalar max_dist, DT_Witness& w);
+
+// The queries on the enlarged cores, with the outcome of their counterparts 
+// on convex shapes.
+bool intersect(const DT_Witness& w, MT_Vector3& v);
+
+bool common_point(const DT_Witness& w, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb);
+
+bool penetration_depth(const DT_Witness& w, MT_Vector3& v, MT_Point3& pa, MT_Point3& pb);
+
+MT_Scalar closest_points(const DT_Witness& w, MT_Scalar max_dist2, MT_Point3& pa, MT_Point3& pb);
+
+#endif